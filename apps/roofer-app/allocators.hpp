@@ -1,27 +1,174 @@
 #pragma once
 #ifdef RF_ENABLE_HEAP_TRACING
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+
 // Overrides for heap allocation counting
 // Ref.: https://www.youtube.com/watch?v=sLlGEUO_EGE
 namespace {
+  // Allocation counters of a single thread. Each thread updates only its own
+  // cache line, so counting does not contend between threads. The shared
+  // overflow counter is used by threads that start after all slots are taken.
+  struct alignas(64) ThreadHeapCounter {
+    std::atomic<size_t> allocated = 0;
+    std::atomic<size_t> freed = 0;
+  };
+
   struct HeapAllocationCounter {
-    std::atomic<size_t> total_allocated = 0;
-    std::atomic<size_t> total_freed = 0;
+    static constexpr size_t max_threads = 256;
+    std::array<ThreadHeapCounter, max_threads> threads;
+    ThreadHeapCounter overflow;
+    std::atomic<size_t> thread_count = 0;
+
+    [[nodiscard]] size_t total_allocated() const {
+      return sum(&ThreadHeapCounter::allocated);
+    }
+    [[nodiscard]] size_t total_freed() const {
+      return sum(&ThreadHeapCounter::freed);
+    }
     [[nodiscard]] size_t current_usage() const {
-      return total_allocated - total_freed;
+      return total_allocated() - total_freed();
     };
+
+   private:
+    size_t sum(std::atomic<size_t> ThreadHeapCounter::* field) const {
+      const size_t n = std::min(thread_count.load(), max_threads);
+      size_t total = (overflow.*field).load(std::memory_order_relaxed);
+      for (size_t i = 0; i < n; ++i) {
+        total += (threads[i].*field).load(std::memory_order_relaxed);
+      }
+      return total;
+    }
   };
   HeapAllocationCounter heap_allocation_counter;
+
+  thread_local ThreadHeapCounter* thread_heap_counter = nullptr;
+
+  ThreadHeapCounter& this_thread_heap_counter() {
+    if (thread_heap_counter == nullptr) {
+      const size_t slot = heap_allocation_counter.thread_count++;
+      thread_heap_counter = slot < HeapAllocationCounter::max_threads
+                                ? &heap_allocation_counter.threads[slot]
+                                : &heap_allocation_counter.overflow;
+    }
+    return *thread_heap_counter;
+  }
+
+  // Aggregated statistics of all AllocationScopes with the same name.
+  struct AllocationScopeStats {
+    // number of times the scope was entered
+    size_t count = 0;
+    size_t allocated = 0;
+    size_t freed = 0;
+    // largest number of bytes that were allocated and not yet freed inside a
+    // single instance of the scope
+    size_t peak = 0;
+  };
+
+  std::mutex allocation_scope_mutex;
+  std::map<std::string, AllocationScopeStats> allocation_scope_totals;
+  // Set while the scope bookkeeping itself allocates, so that these
+  // allocations are not attributed to the enclosing scope.
+  thread_local bool in_allocation_scope_bookkeeping = false;
 }  // namespace
 
+// Attributes the heap allocations of the current thread to a named stage for
+// as long as the object lives. Scopes nest: an allocation counts towards the
+// innermost scope and all scopes that enclose it on the same thread.
+// Allocations by other threads, eg. the workers of a parallel algorithm, are
+// not attributed to the scope.
+class AllocationScope {
+ public:
+  explicit AllocationScope(const char* name)
+      : name_(name), parent_(current_) {
+    current_ = this;
+  }
+  AllocationScope(const AllocationScope&) = delete;
+  AllocationScope& operator=(const AllocationScope&) = delete;
+
+  ~AllocationScope() {
+    current_ = parent_;
+    in_allocation_scope_bookkeeping = true;
+    {
+      std::scoped_lock lock{allocation_scope_mutex};
+      auto& totals = allocation_scope_totals[name_];
+      ++totals.count;
+      totals.allocated += allocated_;
+      totals.freed += freed_;
+      totals.peak = std::max(totals.peak, peak_);
+    }
+    in_allocation_scope_bookkeeping = false;
+  }
+
+  static void on_allocate(size_t size) {
+    if (in_allocation_scope_bookkeeping) return;
+    for (auto* scope = current_; scope != nullptr; scope = scope->parent_) {
+      scope->allocated_ += size;
+      scope->live_ += static_cast<int64_t>(size);
+      if (scope->live_ > 0) {
+        scope->peak_ =
+            std::max(scope->peak_, static_cast<size_t>(scope->live_));
+      }
+    }
+  }
+  static void on_free(size_t size) {
+    if (in_allocation_scope_bookkeeping) return;
+    for (auto* scope = current_; scope != nullptr; scope = scope->parent_) {
+      scope->freed_ += size;
+      scope->live_ -= static_cast<int64_t>(size);
+    }
+  }
+
+  // Totals per scope name of all scopes that have been closed so far.
+  static std::map<std::string, AllocationScopeStats> totals() {
+    in_allocation_scope_bookkeeping = true;
+    std::map<std::string, AllocationScopeStats> result;
+    {
+      std::scoped_lock lock{allocation_scope_mutex};
+      result = allocation_scope_totals;
+    }
+    in_allocation_scope_bookkeeping = false;
+    return result;
+  }
+
+ private:
+  static thread_local AllocationScope* current_;
+
+  const char* name_;
+  AllocationScope* parent_;
+  size_t allocated_ = 0;
+  size_t freed_ = 0;
+  // may become negative when memory from before the scope is freed
+  int64_t live_ = 0;
+  size_t peak_ = 0;
+};
+thread_local AllocationScope* AllocationScope::current_ = nullptr;
+
 void* operator new(size_t size) {
-  heap_allocation_counter.total_allocated += size;
+  this_thread_heap_counter().allocated.fetch_add(size,
+                                                 std::memory_order_relaxed);
+  AllocationScope::on_allocate(size);
   return malloc(size);
 }
 void operator delete(void* memory, size_t size) noexcept {
-  heap_allocation_counter.total_freed += size;
+  this_thread_heap_counter().freed.fetch_add(size, std::memory_order_relaxed);
+  AllocationScope::on_free(size);
   free(memory);
 };
 
+#else
+// Without heap tracing an AllocationScope does nothing.
+class AllocationScope {
+ public:
+  explicit AllocationScope(const char*) {}
+};
 #endif
 
 /*
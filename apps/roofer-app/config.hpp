@@ -176,6 +176,7 @@ struct RooferConfig {
   // general parameters
   std::optional<roofer::TBox<double>> region_of_interest;
   std::string srs_override;
+  int parallel_building_points = 500000;
 #ifdef RF_USE_RERUN
   bool use_rerun = false;
 #endif
@@ -184,6 +185,7 @@ struct RooferConfig {
   bool split_cjseq = false;
   bool omit_metadata = false;
   bool output_terrain = false;
+  bool write_stage_timings = false;
   roofer::arr3d cj_scale = {0.0001, 0.0001, 0.0001};
   std::optional<roofer::arr3d> cj_translate;
   std::string building_toml_file_spec =
@@ -207,6 +209,7 @@ struct RooferConfig {
   // output attribute names
   std::string a_success = "rf_success";
   std::string a_reconstruction_time = "rf_t_run";
+  std::string a_stage_time_prefix = "rf_t_";
   std::string a_val3dity_lod12 = "rf_val3dity_lod12";
   std::string a_val3dity_lod13 = "rf_val3dity_lod13";
   std::string a_val3dity_lod22 = "rf_val3dity_lod22";
@@ -436,8 +439,13 @@ struct RooferConfigHandler {
   bool _crop_only = false;
   bool _tiling = false;
   bool _skip_pc_check = false;
+  bool _cpu_affinity = false;
   roofer::logger::LogLevel _loglevel = roofer::logger::LogLevel::info;
   int _trace_interval = 10;
+  std::string _metrics_file;
+  std::string _metrics_socket;
+  int _metrics_interval = 10;
+  std::string _timing_report;
   std::string _config_path;
   int _jobs = default_jobs();
   int _deprecated_lod11_fallback_time = 1800000;
@@ -456,6 +464,15 @@ struct RooferConfigHandler {
                 "Number of worker jobs to use. Reconstruction uses roughly "
                 "jobs - 1 threads.",
                 _jobs, {roofer::config::greater_than(0)});
+    general.add("cpu-affinity",
+                "Pin each reconstruction worker thread to its own logical CPU. "
+                "Only has an effect on Linux and Windows.",
+                _cpu_affinity);
+    general.add("parallel-building-points",
+                "Run the independent reconstruction stages of a building "
+                "concurrently if it has at least this many roof points. Set to "
+                "0 to always reconstruct a building on a single thread.",
+                cfg_.parallel_building_points, {roofer::config::at_least(0)});
     general.add("config", 'c', "Configuration file", _config_path,
                 {[](const std::string& path) -> std::optional<std::string> {
                   if (path.empty()) return std::nullopt;
@@ -464,6 +481,23 @@ struct RooferConfigHandler {
     general.add("trace-interval", "Interval for tracing in seconds",
                 _trace_interval, {roofer::config::greater_than(0)});
     general.add("loglevel", "Specify loglevel", _loglevel);
+    general.add("metrics-file",
+                "Periodically write pipeline metrics in the OpenMetrics text "
+                "format to this file.",
+                _metrics_file);
+    general.add("metrics-socket",
+                "Serve pipeline metrics in the OpenMetrics text format on this "
+                "local UNIX socket. Not supported on Windows.",
+                _metrics_socket);
+    general.add("metrics-interval",
+                "Interval for writing the metrics file in seconds",
+                _metrics_interval, {roofer::config::greater_than(0)});
+    general.add("timing-report",
+                "Write a JSON report with per-stage reconstruction time "
+                "statistics over all buildings to this file at the end of the "
+                "run. Builds with heap tracing also report the allocations of "
+                "each stage.",
+                _timing_report);
 #ifdef RF_USE_RERUN
     general.add("rerun", "Log intermediate results to rerun", cfg_.use_rerun);
 #endif
@@ -688,6 +722,11 @@ struct RooferConfigHandler {
                "geometry, attributes, file naming, and configuration may "
                "change, and the feature may be removed in a future release.",
                cfg_.output_terrain);
+    output.add("stage-timings",
+               "Write the time spent in each reconstruction stage as building "
+               "attributes, in milliseconds. See the `stage_time_prefix` "
+               "attribute.",
+               cfg_.write_stage_timings);
     output.add("cj-scale",
                "CityJSON output vertex precision, in input map units.",
                cfg_.cj_scale);
@@ -705,6 +744,12 @@ struct RooferConfigHandler {
     output_attr_.emplace("reconstruction_time",
                          DocAttrib(&cfg_.a_reconstruction_time,
                                    "Reconstruction time in milliseconds"));
+    output_attr_.emplace(
+        "stage_time_prefix",
+        DocAttrib(&cfg_.a_stage_time_prefix,
+                  "Prefix of the per-stage reconstruction times in "
+                  "milliseconds, eg. `rf_t_plane_detect`. Only written with "
+                  "`--stage-timings`"));
     output_attr_.emplace(
         "val3dity_lod12",
         DocAttrib(&cfg_.a_val3dity_lod12,
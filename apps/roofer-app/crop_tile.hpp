@@ -25,6 +25,11 @@ bool crop_tile(const roofer::TBox<double>& tile,
                BuildingTile& output_building_tile, const RooferConfig& cfg,
                const roofer::io::SpatialReferenceSystemInterface* srs) {
   auto& logger = roofer::logger::Logger::get_logger();
+  // heap allocations of the whole tile and of the current stage, only counted
+  // with RF_ENABLE_HEAP_TRACING
+  AllocationScope heap_scope("crop");
+  std::optional<AllocationScope> stage_heap_scope;
+  stage_heap_scope.emplace("crop_footprints");
 
   auto& pj = output_building_tile.proj_helper;
   auto vector_reader = roofer::io::createVectorReaderOGR(*pj);
@@ -95,6 +100,7 @@ bool crop_tile(const roofer::TBox<double>& tile,
       polygon_extent.pmax[0], polygon_extent.pmax[1], polygon_extent.pmax[2]));
 
   // Crop all pointclouds
+  stage_heap_scope.emplace("crop_pointclouds");
   for (size_t ipc_index = 0; ipc_index < input_pointclouds.size();
        ++ipc_index) {
     auto& ipc = input_pointclouds[ipc_index];
@@ -103,10 +109,19 @@ bool crop_tile(const roofer::TBox<double>& tile,
     auto intersecting_files = ipc.rtree->query(polygon_extent_untransformed);
 
     std::vector<std::string> lasfiles;
+    uint64_t lasfiles_bytes = 0;
     for (auto* file_extent_ : intersecting_files) {
       auto* file_extent = static_cast<fileExtent*>(file_extent_);
       lasfiles.push_back(file_extent->first);
+      std::error_code ec;
+      auto file_size = std::filesystem::file_size(file_extent->first, ec);
+      if (!ec) lasfiles_bytes += file_size;
     }
+    metrics::Registry::get()
+        .counter("roofer_input_bytes",
+                 "Size of the input pointcloud files that were read by the "
+                 "cropper. A file counts once for every tile it overlaps.")
+        .inc(lasfiles_bytes);
 
     PointCloudCropper->process(
         lasfiles, footprints, buffered_footprints, ipc.building_clouds,
@@ -186,6 +201,7 @@ bool crop_tile(const roofer::TBox<double>& tile,
   // compute rasters
   // thin
   // compute nodata maxcircle
+  stage_heap_scope.emplace("crop_analyse");
   for (auto& ipc : input_pointclouds) {
     logger.info("Analysing pointcloud {}...", ipc.name);
     ipc.nodata_radii.resize(N_fp);
@@ -305,6 +321,7 @@ bool crop_tile(const roofer::TBox<double>& tile,
   // select pointcloud and write out geoflow config + pointcloud / fp for each
   // building
   // logger.info("Selecting and writing pointclouds");
+  stage_heap_scope.emplace("crop_select");
   auto bid_vec = attributes.get_if<std::string>(cfg.id_attribute);
   auto h_ground_fallback_vec =
       attributes.get_if<float>(cfg.h_terrain_attribute);
@@ -0,0 +1,405 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fmt/format.h>
+
+#if defined(IS_LINUX) || defined(IS_MACOS)
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// Runtime metrics of the roofer pipeline, exported in the OpenMetrics text
+// format (https://openmetrics.io). Updating a metric is lock-free, only
+// registering a new metric or label combination takes the registry lock.
+namespace metrics {
+
+  class Counter {
+    std::atomic<uint64_t> value_ = 0;
+
+   public:
+    void inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    // For counters that mirror an existing monotonic count.
+    void set(uint64_t n) { value_.store(n, std::memory_order_relaxed); }
+    [[nodiscard]] uint64_t value() const { return value_.load(); }
+  };
+
+  class Gauge {
+    std::atomic<int64_t> value_ = 0;
+
+   public:
+    void set(int64_t n) { value_.store(n, std::memory_order_relaxed); }
+    void inc(int64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    void dec(int64_t n = 1) { value_.fetch_sub(n, std::memory_order_relaxed); }
+    [[nodiscard]] int64_t value() const { return value_.load(); }
+  };
+
+  // Latency histogram with HDR-style log-linear buckets over microseconds.
+  // Every power of two is split into 8 linear sub-buckets, so a recorded value
+  // is known with a relative error of at most 12.5% over the full uint64
+  // range, in a fixed 4 kB of counters.
+  class Histogram {
+   public:
+    static constexpr int sub_bucket_bits = 3;
+    static constexpr size_t sub_bucket_count = size_t{1} << sub_bucket_bits;
+    static constexpr size_t bucket_count =
+        (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+    static size_t bucket_index(uint64_t v) {
+      if (v < sub_bucket_count) return static_cast<size_t>(v);
+      const int e = std::bit_width(v) - 1;
+      const uint64_t m = v >> (e - sub_bucket_bits);
+      return static_cast<size_t>(e - sub_bucket_bits + 1) * sub_bucket_count +
+             static_cast<size_t>(m - sub_bucket_count);
+    }
+    // Exclusive upper bound of a bucket, as double because the last bucket
+    // ends at 2^64.
+    static double bucket_upper(size_t idx) {
+      if (idx < sub_bucket_count) return static_cast<double>(idx + 1);
+      const int e = static_cast<int>(idx / sub_bucket_count) + 2;
+      const auto m = static_cast<double>(idx % sub_bucket_count +
+                                         sub_bucket_count + 1);
+      return std::ldexp(m, e - sub_bucket_bits);
+    }
+
+    void observe_us(uint64_t us) {
+      counts_[bucket_index(us)].fetch_add(1, std::memory_order_relaxed);
+      count_.fetch_add(1, std::memory_order_relaxed);
+      sum_us_.fetch_add(us, std::memory_order_relaxed);
+      uint64_t prev = max_us_.load(std::memory_order_relaxed);
+      while (prev < us && !max_us_.compare_exchange_weak(prev, us)) {
+      }
+    }
+    void observe(std::chrono::duration<double> d) {
+      observe_us(static_cast<uint64_t>(
+          std::max(0.0, std::round(d.count() * 1e6))));
+    }
+
+    [[nodiscard]] uint64_t count() const { return count_.load(); }
+    [[nodiscard]] double sum_seconds() const { return sum_us_.load() * 1e-6; }
+    [[nodiscard]] double max_seconds() const { return max_us_.load() * 1e-6; }
+
+    // Value in seconds below which a fraction q of the observations fall. The
+    // result is the upper end of the bucket that contains the quantile, capped
+    // at the largest observed value.
+    [[nodiscard]] double quantile_seconds(double q) const {
+      const uint64_t total = count();
+      if (total == 0) return 0.;
+      const auto rank = std::max<uint64_t>(
+          1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(total))));
+      uint64_t cumulative = 0;
+      for (size_t i = 0; i < bucket_count; ++i) {
+        cumulative += counts_[i].load(std::memory_order_relaxed);
+        if (cumulative >= rank) {
+          return std::min(bucket_upper(i) - 1, double(max_us_.load())) * 1e-6;
+        }
+      }
+      return max_seconds();
+    }
+
+    // Largest exported `le` boundary is 2^export_bucket_bits us (about 19 h).
+    // Slower observations are only counted by the +Inf bucket.
+    static constexpr int export_bucket_bits = 36;
+
+    // Append the OpenMetrics samples, using the power-of-two bucket
+    // boundaries as `le` values so that the exported buckets are exact. The
+    // bucket layout is the same in every snapshot, also for the buckets that
+    // are still empty, because quantiles and rates over scrapes need a stable
+    // set of `le` labels.
+    void write_samples(std::string& out, std::string_view name,
+                       std::string_view labels) const {
+      const std::string sep = labels.empty() ? "" : ",";
+      uint64_t cumulative = 0;
+      size_t i = 0;
+      for (int bit = 0; bit <= export_bucket_bits; ++bit) {
+        const double le = std::ldexp(1., bit);
+        while (i < bucket_count && bucket_upper(i) <= le) {
+          cumulative += counts_[i++].load(std::memory_order_relaxed);
+        }
+        out += fmt::format("{}_bucket{{{}{}le=\"{}\"}} {}\n", name, labels,
+                           sep, le * 1e-6, cumulative);
+      }
+      // the total is read after the buckets, so that +Inf is never smaller
+      // than the last bucket while observations are added
+      while (i < bucket_count) {
+        cumulative += counts_[i++].load(std::memory_order_relaxed);
+      }
+      const uint64_t total = std::max(count(), cumulative);
+      out += fmt::format("{}_bucket{{{}{}le=\"+Inf\"}} {}\n", name, labels, sep,
+                         total);
+      const std::string braces =
+          labels.empty() ? "" : fmt::format("{{{}}}", labels);
+      out += fmt::format("{}_count{} {}\n", name, braces, total);
+      out += fmt::format("{}_sum{} {}\n", name, braces, sum_seconds());
+    }
+
+   private:
+    std::array<std::atomic<uint64_t>, bucket_count> counts_{};
+    std::atomic<uint64_t> count_ = 0;
+    std::atomic<uint64_t> sum_us_ = 0;
+    std::atomic<uint64_t> max_us_ = 0;
+  };
+
+  using Labels =
+      std::initializer_list<std::pair<std::string_view, std::string_view>>;
+
+  class Registry {
+   public:
+    static Registry& get() {
+      static Registry registry;
+      return registry;
+    }
+
+    Counter& counter(std::string_view name, std::string_view help,
+                     Labels labels = {}) {
+      return child<Counter>(name, "counter", help, labels);
+    }
+    Gauge& gauge(std::string_view name, std::string_view help,
+                 Labels labels = {}) {
+      return child<Gauge>(name, "gauge", help, labels);
+    }
+    // Histograms record durations, their unit is always seconds.
+    Histogram& histogram(std::string_view name, std::string_view help,
+                         Labels labels = {}) {
+      return child<Histogram>(name, "histogram", help, labels);
+    }
+
+    [[nodiscard]] std::string to_openmetrics() {
+      std::string out;
+      std::scoped_lock lock{mutex_};
+      for (const auto& [name, family] : families_) {
+        out += fmt::format("# TYPE {} {}\n", name, family.type);
+        if (family.type == "histogram") {
+          out += fmt::format("# UNIT {} seconds\n", name);
+        }
+        out += fmt::format("# HELP {} {}\n", name, family.help);
+        auto braces = [](const std::string& labels) {
+          return labels.empty() ? labels : fmt::format("{{{}}}", labels);
+        };
+        for (const auto& [labels, metric] : family.counters) {
+          out += fmt::format("{}_total{} {}\n", name, braces(labels),
+                             metric->value());
+        }
+        for (const auto& [labels, metric] : family.gauges) {
+          out += fmt::format("{}{} {}\n", name, braces(labels),
+                             metric->value());
+        }
+        for (const auto& [labels, metric] : family.histograms) {
+          metric->write_samples(out, name, labels);
+        }
+      }
+      out += "# EOF\n";
+      return out;
+    }
+
+   private:
+    struct Family {
+      std::string type;
+      std::string help;
+      std::map<std::string, std::unique_ptr<Counter>> counters;
+      std::map<std::string, std::unique_ptr<Gauge>> gauges;
+      std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+    std::mutex mutex_;
+    std::map<std::string, Family> families_;
+
+    Registry() = default;
+
+    static std::string format_labels(Labels labels) {
+      std::string s;
+      for (const auto& [key, value] : labels) {
+        if (!s.empty()) s += ",";
+        s += fmt::format("{}=\"{}\"", key, value);
+      }
+      return s;
+    }
+
+    template <typename T>
+    T& child(std::string_view name, std::string_view type,
+             std::string_view help, Labels labels) {
+      std::scoped_lock lock{mutex_};
+      auto& family = families_[std::string(name)];
+      if (family.type.empty()) {
+        family.type = type;
+        family.help = help;
+      } else if (family.type != type) {
+        throw std::logic_error(fmt::format(
+            "Metric {} is a {}, not a {}", name, family.type, type));
+      }
+      auto& children = [&family]() -> auto& {
+        if constexpr (std::is_same_v<T, Counter>)
+          return family.counters;
+        else if constexpr (std::is_same_v<T, Gauge>)
+          return family.gauges;
+        else
+          return family.histograms;
+      }();
+      auto& metric = children[format_labels(labels)];
+      if (!metric) metric = std::make_unique<T>();
+      return *metric;
+    }
+  };
+
+  // Periodically writes the registry to a file, and/or serves it on a local
+  // UNIX socket. The file is replaced atomically, so that it can be picked up
+  // by eg. the Prometheus node-exporter textfile collector. Every connection
+  // to the socket receives one snapshot, after which the socket is closed.
+  // `collect` is called before every snapshot, to update the metrics that are
+  // sampled rather than counted (eg. queue depths).
+  class Exporter {
+   public:
+    Exporter(std::string file_path, std::string socket_path,
+             std::chrono::seconds interval, std::function<void()> collect)
+        : file_path_(std::move(file_path)),
+          socket_path_(std::move(socket_path)),
+          interval_(interval),
+          collect_(std::move(collect)) {
+      if (!file_path_.empty()) {
+        file_thread_ = std::thread([this] {
+          std::unique_lock lock{stop_mutex_};
+          while (
+              !stop_cv_.wait_for(lock, interval_, [this] { return stop_; })) {
+            write_file();
+          }
+        });
+      }
+      if (!socket_path_.empty()) start_socket();
+    }
+
+    Exporter(const Exporter&) = delete;
+    Exporter& operator=(const Exporter&) = delete;
+
+    // Stops the exporter threads and writes a final snapshot to the file.
+    ~Exporter() {
+      {
+        std::scoped_lock lock{stop_mutex_};
+        stop_ = true;
+      }
+      stop_cv_.notify_all();
+      if (file_thread_.joinable()) file_thread_.join();
+      if (socket_thread_.joinable()) socket_thread_.join();
+      if (!file_path_.empty()) write_file();
+    }
+
+   private:
+    std::string file_path_;
+    std::string socket_path_;
+    std::chrono::seconds interval_;
+    std::function<void()> collect_;
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stop_ = false;
+    std::thread file_thread_;
+    std::thread socket_thread_;
+
+    std::string snapshot() {
+      if (collect_) collect_();
+      return Registry::get().to_openmetrics();
+    }
+
+    void write_file() {
+      const auto path = std::filesystem::path(file_path_);
+      auto tmp_path = path;
+      tmp_path += ".tmp";
+      {
+        std::ofstream ofs(tmp_path, std::ios::trunc);
+        ofs << snapshot();
+      }
+      std::error_code ec;
+      std::filesystem::rename(tmp_path, path, ec);
+    }
+
+    bool stopping() {
+      std::scoped_lock lock{stop_mutex_};
+      return stop_;
+    }
+
+    void start_socket() {
+#if defined(IS_LINUX) || defined(IS_MACOS)
+      sockaddr_un addr{};
+      addr.sun_family = AF_UNIX;
+      if (socket_path_.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error(
+            fmt::format("Metrics socket path is too long: {}", socket_path_));
+      }
+      std::copy(socket_path_.begin(), socket_path_.end(), addr.sun_path);
+      int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+      if (fd < 0) {
+        throw std::runtime_error("Failed to create the metrics socket");
+      }
+      ::unlink(socket_path_.c_str());
+      if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+          ::listen(fd, 4) != 0) {
+        ::close(fd);
+        throw std::runtime_error(fmt::format(
+            "Failed to listen on the metrics socket {}", socket_path_));
+      }
+      socket_thread_ = std::thread([this, fd] {
+        pollfd pfd{fd, POLLIN, 0};
+        while (!stopping()) {
+          if (::poll(&pfd, 1, 200) <= 0) continue;
+          int client = ::accept(fd, nullptr, nullptr);
+          if (client < 0) continue;
+          const auto text = snapshot();
+          size_t written = 0;
+          while (written < text.size()) {
+            auto n = ::write(client, text.data() + written,
+                             text.size() - written);
+            if (n <= 0) break;
+            written += static_cast<size_t>(n);
+          }
+          ::close(client);
+        }
+        ::close(fd);
+        ::unlink(socket_path_.c_str());
+      });
+#else
+      throw std::runtime_error(
+          "Serving metrics on a UNIX socket is not supported on this platform");
+#endif
+    }
+  };
+
+}  // namespace metrics
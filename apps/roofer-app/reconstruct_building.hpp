@@ -63,6 +63,17 @@ struct rerun::CollectionAdapter<rerun::Position3D, roofer::TriangleCollection> {
 
 enum LOD { LOD11 = 11, LOD12 = 12, LOD13 = 13, LOD22 = 22 };
 
+// The stages of reconstruct_building() that are timed, in pipeline order. The
+// names are used as keys of BuildingObject::stage_timings, in the timing report
+// and in the per-building timing attributes.
+inline constexpr std::array<std::string_view, 16> reconstruction_stages = {
+    "plane_detect",         "plane_detect_ground",  "alpha_shape",
+    "alpha_shape_ground",   "line_detect",          "plane_intersect",
+    "line_regularise",      "segment_rasterise",    "arrangement_build",
+    "arrangement_optimise", "arrangement_dissolve", "extrude_lod12",
+    "extrude_lod13",        "extrude_lod22",        "mesh_properties",
+    "extrude_lod11"};
+
 void add_ms_to_bbox(roofer::Box& box,
                     std::unordered_map<int, roofer::Mesh>& multisolid) {
   for (auto& [i, mesh] : multisolid) {
@@ -180,51 +191,104 @@ void multisolid_post_process(BuildingObject& building, RooferConfig* cfg,
 #endif
 }
 
-std::unordered_map<int, roofer::Mesh> extrude_lod22(
-    roofer::Arrangement_2 arrangement, BuildingObject& building,
-    RooferConfig* cfg,
+// Dissolve the optimised arrangement into the roof partition of `lod`. With
+// `derived` the arrangement is the result of an earlier, finer LoD dissolve,
+// so the segment edges are already dissolved and the faces already clipped to
+// the terrain.
+void dissolve_lod(
+    roofer::Arrangement_2& arrangement, RooferConfig* cfg,
     roofer::reconstruction::SegmentRasteriserInterface* SegmentRasteriser,
-    LOD lod, std::optional<float>& rmse, std::optional<float>& volume,
-    std::optional<std::string>& attr_val3dity) {
-  bool dissolve_step_edges = false;
-  bool dissolve_all_interior = false;
-  bool extrude_LoD2 = true;
-  if (lod == LOD12) {
-    dissolve_all_interior = true, extrude_LoD2 = false;
-  } else if (lod == LOD13) {
-    dissolve_step_edges = true, extrude_LoD2 = false;
-  }
-#ifdef RF_USE_RERUN
-  const auto& rec = rerun::RecordingStream::current();
-  std::string worldname = fmt::format("world/lod{}/", (int)lod);
-#endif
-
-  auto& logger = roofer::logger::Logger::get_logger();
+    const roofer::reconstruction::ElevationProvider& elevation_provider,
+    LOD lod, bool derived) {
   const auto reconstruction = cfg->reconstruction_in_input_units();
-
-  auto elevation_provider =
-      roofer::reconstruction::createElevationProvider(*building.h_ground);
-
   auto ArrangementDissolver =
       roofer::reconstruction::createArrangementDissolver();
   auto dissolver_config = reconstruction.arrangement_dissolver;
-  dissolver_config.dissolve_step_edges = dissolve_step_edges;
-  dissolver_config.dissolve_all_interior = dissolve_all_interior;
+  dissolver_config.dissolve_step_edges = lod == LOD13;
+  dissolver_config.dissolve_all_interior = lod == LOD12;
   dissolver_config.step_height_threshold = reconstruction.lod13_step_height;
+  if (derived) {
+    dissolver_config.dissolve_segment_edges = false;
+    dissolver_config.clip_to_terrain = false;
+  }
   ArrangementDissolver->compute(arrangement, SegmentRasteriser->heightfield,
-                                *elevation_provider, dissolver_config);
+                                elevation_provider, dissolver_config);
   // logger.debug("Completed ArrangementDissolver");
   // logger.debug("Roof partition has {} faces", arrangement.number_of_faces());
 #ifdef RF_USE_RERUN
   if (cfg->use_rerun) {
+    const auto& rec = rerun::RecordingStream::current();
     rec.log(
-        worldname + "ArrangementDissolver",
+        fmt::format("world/lod{}/ArrangementDissolver", (int)lod),
         rerun::LineStrips3D(roofer::reconstruction::arr2polygons(arrangement)));
   }
 #endif
+}
+
+// Times the stages of a building and counts their heap allocations (only with
+// RF_ENABLE_HEAP_TRACING). The stages of a large building may run concurrently,
+// so the timings are written under a lock and can add up to more than the
+// reconstruction time of the building. Each stage gets a scratch arena on the
+// thread that runs it, so that its temporaries are released in one go.
+class StageRecorder {
+ public:
+  using StageTimings =
+      std::unordered_map<std::string, std::chrono::duration<double>>;
+
+  explicit StageRecorder(StageTimings& timings) : timings_(timings) {}
+
+  template <typename F>
+  void operator()(const char* stage, F&& f) {
+    std::chrono::duration<double> elapsed;
+    {
+      AllocationScope heap_scope(stage);
+      roofer::ScratchArena scratch;
+      const auto t0 = std::chrono::high_resolution_clock::now();
+      f();
+      elapsed = std::chrono::high_resolution_clock::now() - t0;
+    }
+    std::scoped_lock lock{mutex_};
+    timings_[stage] = elapsed;
+  }
+
+  // Add time to a stage that is not timed by operator(), eg. a phase of a
+  // component that runs in several stages. These stages are reported after
+  // the reconstruction_stages.
+  void add(const std::string& stage, std::chrono::duration<double> elapsed) {
+    std::scoped_lock lock{mutex_};
+    timings_[stage] += elapsed;
+  }
+
+ private:
+  StageTimings& timings_;
+  std::mutex mutex_;
+};
+
+// Snap and extrude a dissolved arrangement. The arrangement is modified by the
+// snapper, so it can not be used for another LoD afterwards. The phases of the
+// snapper are added to the snap_* stages, summed over the LoDs.
+std::unordered_map<int, roofer::Mesh> extrude_lod(
+    roofer::Arrangement_2& arrangement, BuildingObject& building,
+    RooferConfig* cfg, StageRecorder& stage,
+    const roofer::reconstruction::ElevationProvider& elevation_provider,
+    LOD lod, std::optional<float>& rmse, std::optional<float>& volume,
+    std::optional<std::string>& attr_val3dity) {
+#ifdef RF_USE_RERUN
+  const auto& rec = rerun::RecordingStream::current();
+  std::string worldname = fmt::format("world/lod{}/", (int)lod);
+#endif
+
+  const auto reconstruction = cfg->reconstruction_in_input_units();
+
   auto ArrangementSnapper = roofer::reconstruction::createArrangementSnapper();
-  ArrangementSnapper->compute(arrangement, *elevation_provider,
+  ArrangementSnapper->compute(arrangement, elevation_provider,
                               reconstruction.arrangement_snapper);
+  const auto& snapper_phases =
+      roofer::reconstruction::arrangement_snapper_phases;
+  for (size_t i = 0; i < snapper_phases.size(); ++i) {
+    stage.add(fmt::format("snap_{}", snapper_phases[i]),
+              ArrangementSnapper->phase_timings[i]);
+  }
   // logger.debug("Completed ArrangementSnapper");
 #ifdef RF_USE_RERUN
 // rec.log(worldname+"ArrangementSnapper", rerun::LineStrips3D(
@@ -234,8 +298,8 @@ std::unordered_map<int, roofer::Mesh> extrude_lod22(
   auto ArrangementExtruder =
       roofer::reconstruction::createArrangementExtruder();
   auto extruder_config = reconstruction.arrangement_extruder;
-  extruder_config.lod2 = extrude_LoD2;
-  ArrangementExtruder->compute(arrangement, *elevation_provider,
+  extruder_config.lod2 = lod == LOD22;
+  ArrangementExtruder->compute(arrangement, elevation_provider,
                                extruder_config);
   // logger.debug("Completed ArrangementExtruder");
 #ifdef RF_USE_RERUN
@@ -283,7 +347,11 @@ void extrude_lod11(BuildingObject& building, float extrusion_h,
   building.roof_elevation_70p = building.h_pc_roof_70p + building.z_offset;
 }
 
-void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
+// Reconstruct the LoD 1.2, 1.3 and 2.2 models of a building. With a
+// scheduler, the independent stages of buildings with at least
+// cfg->parallel_building_points roof points run concurrently on it.
+void reconstruct_building(BuildingObject& building, RooferConfig* cfg,
+                          TaskScheduler* scheduler = nullptr) {
   auto& logger = roofer::logger::Logger::get_logger();
   const auto reconstruction = cfg->reconstruction_in_input_units();
 
@@ -315,7 +383,32 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
   }
 #endif
 
-  std::unordered_map<std::string, std::chrono::duration<double>> timings;
+  StageRecorder stage(building.stage_timings);
+  // heap allocations of the whole building, only counted with
+  // RF_ENABLE_HEAP_TRACING
+  AllocationScope heap_scope("reconstruct");
+  auto timed_lod11 = [&](float extrusion_h) {
+    stage("extrude_lod11", [&] { extrude_lod11(building, extrusion_h, cfg); });
+  };
+
+  // Large buildings would leave the other workers idle at the end of a tile,
+  // so their independent stages are run concurrently. Smaller buildings run
+  // their stages in order, the buildings themselves keep the workers busy.
+  bool split_stages =
+      scheduler != nullptr && cfg->parallel_building_points > 0 &&
+      building.pointcloud_building.size() >=
+          static_cast<size_t>(cfg->parallel_building_points);
+#ifdef RF_USE_RERUN
+  // the recording stream is only set for the thread of this task
+  split_stages = split_stages && !cfg->use_rerun;
+#endif
+  auto run_stages = [&](auto&&... stages) {
+    if (split_stages) {
+      scheduler->parallel_invoke(stages...);
+    } else {
+      (stages(), ...);
+    }
+  };
 
   // pointcloud_insufficient is set by StreamCropper when a footprint's
   // building-class point density is below the absolute min_building_density
@@ -330,25 +423,30 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
     // floor and an explicit height fallback. Without both no geometry
     // can be built, so the building is left empty.
     if (building.h_ground.has_value() && building.roof_h_fallback.has_value()) {
-      extrude_lod11(building, *building.roof_h_fallback, cfg);
+      timed_lod11(*building.roof_h_fallback);
     }
     return;
   } else if (building.extrusion_mode == LOD11_FALLBACK) {
-    extrude_lod11(building, building.h_pc_roof_70p, cfg);
+    timed_lod11(building.h_pc_roof_70p);
     return;
   } else if (building.extrusion_mode == STANDARD) {
-    auto t0 = std::chrono::high_resolution_clock::now();
     auto PlaneDetector = roofer::reconstruction::createPlaneDetector();
     auto PlaneDetector_ground = roofer::reconstruction::createPlaneDetector();
     try {
-      auto plane_detector_cfg = reconstruction.plane_detector;
-      PlaneDetector->detect(building.pointcloud_building, plane_detector_cfg);
-      timings["PlaneDetector"] = std::chrono::high_resolution_clock::now() - t0;
-      t0 = std::chrono::high_resolution_clock::now();
-      PlaneDetector_ground->detect(building.pointcloud_ground,
-                                   plane_detector_cfg);
-      timings["PlaneDetector_ground"] =
-          std::chrono::high_resolution_clock::now() - t0;
+      const auto& plane_detector_cfg = reconstruction.plane_detector;
+      run_stages(
+          [&] {
+            stage("plane_detect", [&] {
+              PlaneDetector->detect(building.pointcloud_building,
+                                    plane_detector_cfg);
+            });
+          },
+          [&] {
+            stage("plane_detect_ground", [&] {
+              PlaneDetector_ground->detect(building.pointcloud_ground,
+                                           plane_detector_cfg);
+            });
+          });
 
       building.roof_type = PlaneDetector->roof_type;
       building.roof_elevation_50p =
@@ -367,7 +465,7 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
         building.extrusion_mode = SKIP;
         building.pointcloud_insufficient = true;
         if (building.roof_h_fallback.has_value()) {
-          extrude_lod11(building, *building.roof_h_fallback, cfg);
+          timed_lod11(*building.roof_h_fallback);
         }
         return;
       }
@@ -376,7 +474,7 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
       // region-count limit, but also CGAL preconditions, allocation failures,
       // etc.) degrades gracefully to a LoD 1.1 block model rather than failing
       // the building outright.
-      extrude_lod11(building, building.h_pc_roof_70p, cfg);
+      timed_lod11(building.h_pc_roof_70p);
       logger.warning("[reconstructor] {}, LoD1.1 fallback: {}",
                      building.jsonl_path.string(), e.what());
       return;
@@ -391,11 +489,39 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
     //         "world/segmented_points",
     //         rerun::Points3D(points_roof).with_class_ids(PlaneDetector->plane_id));
     // #endif
-    t0 = std::chrono::high_resolution_clock::now();
+
+    // The boundary lines need the roof alpha shapes, the ground alpha shapes
+    // and the intersection lines only need the detected planes.
     auto AlphaShaper = roofer::reconstruction::createAlphaShaper();
-    AlphaShaper->compute(PlaneDetector->pts_per_roofplane,
-                         reconstruction.alpha_shaper);
-    timings["AlphaShaper"] = std::chrono::high_resolution_clock::now() - t0;
+    auto AlphaShaper_ground = roofer::reconstruction::createAlphaShaper();
+    auto LineDetector = roofer::reconstruction::createLineDetector();
+    auto PlaneIntersector = roofer::reconstruction::createPlaneIntersector();
+    run_stages(
+        [&] {
+          stage("alpha_shape", [&] {
+            AlphaShaper->compute(PlaneDetector->pts_per_roofplane,
+                                 reconstruction.alpha_shaper);
+          });
+          stage("line_detect", [&] {
+            LineDetector->detect(
+                AlphaShaper->alpha_rings, AlphaShaper->roofplane_ids,
+                PlaneDetector->pts_per_roofplane, reconstruction.line_detector);
+          });
+        },
+        [&] {
+          stage("alpha_shape_ground", [&] {
+            AlphaShaper_ground->compute(
+                PlaneDetector_ground->pts_per_roofplane,
+                reconstruction.alpha_shaper);
+          });
+        },
+        [&] {
+          stage("plane_intersect", [&] {
+            PlaneIntersector->compute(PlaneDetector->pts_per_roofplane,
+                                      PlaneDetector->plane_adjacencies,
+                                      reconstruction.plane_intersector);
+          });
+        });
     // logger.debug("Completed AlphaShaper (roof), found {} rings, {} labels",
     //  AlphaShaper->alpha_rings.size(),
     //  AlphaShaper->roofplane_ids.size());
@@ -406,12 +532,6 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
                   .with_class_ids(AlphaShaper->roofplane_ids));
     }
 #endif
-    t0 = std::chrono::high_resolution_clock::now();
-    auto AlphaShaper_ground = roofer::reconstruction::createAlphaShaper();
-    AlphaShaper_ground->compute(PlaneDetector_ground->pts_per_roofplane,
-                                reconstruction.alpha_shaper);
-    timings["AlphaShaper_ground"] =
-        std::chrono::high_resolution_clock::now() - t0;
     // logger.debug("Completed AlphaShaper (ground), found {} rings, {} labels",
     //  AlphaShaper_ground->alpha_rings.size(),
     //  AlphaShaper_ground->roofplane_ids.size());
@@ -422,12 +542,6 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
                   .with_class_ids(AlphaShaper_ground->roofplane_ids));
     }
 #endif
-    t0 = std::chrono::high_resolution_clock::now();
-    auto LineDetector = roofer::reconstruction::createLineDetector();
-    LineDetector->detect(AlphaShaper->alpha_rings, AlphaShaper->roofplane_ids,
-                         PlaneDetector->pts_per_roofplane,
-                         reconstruction.line_detector);
-    timings["LineDetector"] = std::chrono::high_resolution_clock::now() - t0;
     // logger.debug("Completed LineDetector");
 #ifdef RF_USE_RERUN
     if (cfg->use_rerun) {
@@ -436,14 +550,6 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
     }
 #endif
 
-    t0 = std::chrono::high_resolution_clock::now();
-    auto PlaneIntersector = roofer::reconstruction::createPlaneIntersector();
-    PlaneIntersector->compute(PlaneDetector->pts_per_roofplane,
-                              PlaneDetector->plane_adjacencies,
-                              reconstruction.plane_intersector);
-    timings["PlaneIntersector"] =
-        std::chrono::high_resolution_clock::now() - t0;
-
     size_t hr_i;
     float hr_z;
     building.roof_n_ridgelines =
@@ -459,12 +565,32 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
     }
 #endif
 
-    t0 = std::chrono::high_resolution_clock::now();
     auto LineRegulariser = roofer::reconstruction::createLineRegulariser();
-    LineRegulariser->compute(LineDetector->edge_segments,
-                             PlaneIntersector->segments,
-                             reconstruction.line_regulariser);
-    timings["LineRegulariser"] = std::chrono::high_resolution_clock::now() - t0;
+    auto SegmentRasteriser = roofer::reconstruction::createSegmentRasteriser();
+    auto rasteriser_config = reconstruction.segment_rasteriser;
+    rasteriser_config.use_ground =
+        !building.pointcloud_ground.empty() && reconstruction.clip_terrain;
+    run_stages(
+        [&] {
+          stage("line_regularise", [&] {
+            LineRegulariser->compute(LineDetector->edge_segments,
+                                     PlaneIntersector->segments,
+                                     reconstruction.line_regulariser);
+          });
+        },
+        [&] {
+          stage("segment_rasterise", [&] {
+            if (reconstruction.alpha_shaper.shared_triangulation) {
+              SegmentRasteriser->compute(
+                  AlphaShaper->alpha_triangle_mesh,
+                  AlphaShaper_ground->alpha_triangle_mesh, rasteriser_config);
+            } else {
+              SegmentRasteriser->compute(AlphaShaper->alpha_triangles,
+                                         AlphaShaper_ground->alpha_triangles,
+                                         rasteriser_config);
+            }
+          });
+        });
     // logger.debug("Completed LineRegulariser");
 #ifdef RF_USE_RERUN
     if (cfg->use_rerun) {
@@ -472,17 +598,6 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
               rerun::LineStrips3D(LineRegulariser->regularised_edges));
     }
 #endif
-
-    t0 = std::chrono::high_resolution_clock::now();
-    auto SegmentRasteriser = roofer::reconstruction::createSegmentRasteriser();
-    auto rasteriser_config = reconstruction.segment_rasteriser;
-    rasteriser_config.use_ground =
-        !building.pointcloud_ground.empty() && reconstruction.clip_terrain;
-    SegmentRasteriser->compute(AlphaShaper->alpha_triangles,
-                               AlphaShaper_ground->alpha_triangles,
-                               rasteriser_config);
-    timings["SegmentRasteriser"] =
-        std::chrono::high_resolution_clock::now() - t0;
     // logger.debug("Completed SegmentRasteriser");
 
 #ifdef RF_USE_RERUN
@@ -491,21 +606,20 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
       heightfield_copy.set_nodata(0);
       rec.log(
           "world/heightfield",
-          rerun::DepthImage(heightfield_copy.vals_->data(),
+          rerun::DepthImage(heightfield_copy.vals_.data(),
                             {static_cast<uint32_t>(heightfield_copy.dimx_),
                              static_cast<uint32_t>(heightfield_copy.dimy_)}));
     }
 #endif
 
-    t0 = std::chrono::high_resolution_clock::now();
     roofer::Arrangement_2 arrangement;
-    auto ArrangementBuilder =
-        roofer::reconstruction::createArrangementBuilder();
-    ArrangementBuilder->compute(arrangement, building.footprint,
-                                LineRegulariser->exact_regularised_edges,
-                                reconstruction.arrangement_builder);
-    timings["ArrangementBuilder"] =
-        std::chrono::high_resolution_clock::now() - t0;
+    stage("arrangement_build", [&] {
+      auto ArrangementBuilder =
+          roofer::reconstruction::createArrangementBuilder();
+      ArrangementBuilder->compute(arrangement, building.footprint,
+                                  LineRegulariser->exact_regularised_edges,
+                                  reconstruction.arrangement_builder);
+    });
     // logger.debug("Completed ArrangementBuilder");
     // logger.debug("Roof partition has {} faces",
     // arrangement.number_of_faces());
@@ -517,51 +631,107 @@ void reconstruct_building(BuildingObject& building, RooferConfig* cfg) {
     }
 #endif
 
-    t0 = std::chrono::high_resolution_clock::now();
-    auto ArrangementOptimiser =
-        roofer::reconstruction::createArrangementOptimiser();
-    auto optimiser_config = reconstruction.arrangement_optimiser;
-    optimiser_config.use_ground =
-        !building.pointcloud_ground.empty() && reconstruction.clip_terrain;
-    ArrangementOptimiser->compute(arrangement, SegmentRasteriser->heightfield,
-                                  PlaneDetector->pts_per_roofplane,
-                                  PlaneDetector_ground->pts_per_roofplane,
-                                  optimiser_config);
-    timings["ArrangementOptimiser"] =
-        std::chrono::high_resolution_clock::now() - t0;
+    stage("arrangement_optimise", [&] {
+      auto ArrangementOptimiser =
+          roofer::reconstruction::createArrangementOptimiser();
+      auto optimiser_config = reconstruction.arrangement_optimiser;
+      optimiser_config.use_ground =
+          !building.pointcloud_ground.empty() && reconstruction.clip_terrain;
+      ArrangementOptimiser->compute(arrangement, SegmentRasteriser->heightfield,
+                                    PlaneDetector->pts_per_roofplane,
+                                    PlaneDetector_ground->pts_per_roofplane,
+                                    optimiser_config);
+    });
     // logger.debug("Completed ArrangementOptimiser");
     // rec.log("world/optimised_partition", rerun::LineStrips3D(
     // roofer::reconstruction::arr2polygons(arrangement) ));
 
     // LoDs
-    // attributes to be filled during reconstruction
-    // logger.debug("LoD={}", cfg->lod);
-    t0 = std::chrono::high_resolution_clock::now();
-    if (cfg->reconstruction.lod12) {
-      building.multisolids_lod12 = extrude_lod22(
-          arrangement, building, cfg, SegmentRasteriser.get(), LOD12,
-          building.rmse_lod12, building.volume_lod12, building.val3dity_lod12);
-    }
+    // The LoD 2.2 dissolve runs once on the optimised arrangement, and the
+    // coarser LoDs are derived from its result: LoD 1.3 by also dissolving the
+    // step edges, LoD 1.2 by dissolving all interior edges of the LoD 1.3 (or
+    // LoD 2.2) partition. The snapper modifies the arrangement of each LoD and
+    // the LoDs are extruded concurrently, so a LoD that is derived from one
+    // that is extruded as well needs a copy of it. Otherwise it is dissolved
+    // in place. The copies are of the dissolved partition, of which the
+    // graph-cut costs are released first, and the exact coordinates are shared
+    // with the original by reference counting.
+    std::unique_ptr<roofer::reconstruction::ElevationProvider>
+        elevation_provider;
+    std::optional<roofer::Arrangement_2> lod13_copy;
+    std::optional<roofer::Arrangement_2> lod12_copy;
+    roofer::Arrangement_2* arrangement_lod13 = nullptr;
+    roofer::Arrangement_2* arrangement_lod12 = nullptr;
+    stage("arrangement_dissolve", [&] {
+      roofer::reconstruction::arr_clear_optimiser_data(arrangement);
+      elevation_provider =
+          roofer::reconstruction::createElevationProvider(*building.h_ground);
+      dissolve_lod(arrangement, cfg, SegmentRasteriser.get(),
+                   *elevation_provider, LOD22, false);
+      // the finest LoD so far and whether it is extruded
+      roofer::Arrangement_2* finer = &arrangement;
+      bool finer_extruded = cfg->reconstruction.lod22;
+      auto derive = [&](std::optional<roofer::Arrangement_2>& copy) {
+        if (!finer_extruded) return finer;
+        return &copy.emplace(*finer);
+      };
+      if (cfg->reconstruction.lod13) {
+        arrangement_lod13 = derive(lod13_copy);
+        dissolve_lod(*arrangement_lod13, cfg, SegmentRasteriser.get(),
+                     *elevation_provider, LOD13, true);
+        finer = arrangement_lod13;
+        finer_extruded = true;
+      }
+      if (cfg->reconstruction.lod12) {
+        arrangement_lod12 = derive(lod12_copy);
+        dissolve_lod(*arrangement_lod12, cfg, SegmentRasteriser.get(),
+                     *elevation_provider, LOD12, true);
+      }
+    });
 
-    if (cfg->reconstruction.lod13) {
-      building.multisolids_lod13 = extrude_lod22(
-          arrangement, building, cfg, SegmentRasteriser.get(), LOD13,
-          building.rmse_lod13, building.volume_lod13, building.val3dity_lod13);
-    }
+    // The LoDs are extruded from their own arrangement and write their own
+    // attributes, so they are independent of each other.
+    // logger.debug("LoD={}", cfg->lod);
+    run_stages(
+        [&] {
+          if (!cfg->reconstruction.lod12) return;
+          stage("extrude_lod12", [&] {
+            building.multisolids_lod12 =
+                extrude_lod(*arrangement_lod12, building, cfg, stage,
+                            *elevation_provider, LOD12, building.rmse_lod12,
+                            building.volume_lod12, building.val3dity_lod12);
+          });
+        },
+        [&] {
+          if (!cfg->reconstruction.lod13) return;
+          stage("extrude_lod13", [&] {
+            building.multisolids_lod13 =
+                extrude_lod(*arrangement_lod13, building, cfg, stage,
+                            *elevation_provider, LOD13, building.rmse_lod13,
+                            building.volume_lod13, building.val3dity_lod13);
+          });
+        },
+        [&] {
+          if (!cfg->reconstruction.lod22) return;
+          stage("extrude_lod22", [&] {
+            building.multisolids_lod22 =
+                extrude_lod(arrangement, building, cfg, stage,
+                            *elevation_provider, LOD22, building.rmse_lod22,
+                            building.volume_lod22, building.val3dity_lod22);
+          });
+        });
 
     if (cfg->reconstruction.lod22) {
-      building.multisolids_lod22 = extrude_lod22(
-          arrangement, building, cfg, SegmentRasteriser.get(), LOD22,
-          building.rmse_lod22, building.volume_lod22, building.val3dity_lod22);
-      compute_mesh_properties(
-          building.multisolids_lod12, building.multisolids_lod13,
-          building.multisolids_lod22, building.z_offset, cfg);
+      stage("mesh_properties", [&] {
+        compute_mesh_properties(
+            building.multisolids_lod12, building.multisolids_lod13,
+            building.multisolids_lod22, building.z_offset, cfg);
+      });
     }
-    timings["extrude"] = std::chrono::high_resolution_clock::now() - t0;
 
     std::string timings_str =
         fmt::format("[reconstructor t] {} (", building.jsonl_path.string());
-    for (const auto& [key, value] : timings) {
+    for (const auto& [key, value] : building.stage_timings) {
       auto ms = static_cast<int>(
           std::chrono::duration_cast<std::chrono::milliseconds>(value).count());
       timings_str += fmt::format("({}, {}),", key, ms);
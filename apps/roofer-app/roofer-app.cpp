@@ -38,6 +38,7 @@ namespace fs = std::filesystem;
 #include <roofer/logger/logger.h>
 #include <roofer/misc/projHelper.hpp>
 #include <roofer/common/datastructures.hpp>
+#include <roofer/common/memory_resource.hpp>
 #include <roofer/io/SpatialReferenceSystem.hpp>
 
 // crop
@@ -75,7 +76,9 @@ namespace fs = std::filesystem;
 // serialisation
 #include <roofer/io/CityJsonWriter.hpp>
 
-#include "BS_thread_pool.hpp"
+#include "metrics.hpp"
+#include "scheduler.hpp"
+#include "timing_report.hpp"
 
 #ifdef RF_USE_RERUN
 #include <rerun.hpp>
@@ -90,6 +93,21 @@ namespace fs = std::filesystem;
 
 enum ExtrusionMode { STANDARD, LOD11_FALLBACK, SKIP, FAIL };
 
+inline std::string_view extrusion_mode_name(ExtrusionMode mode) {
+  switch (mode) {
+    case STANDARD:
+      return "standard";
+    case LOD11_FALLBACK:
+      return "lod11_fallback";
+    case SKIP:
+      return "skip";
+    case FAIL:
+      return "fail";
+    default:
+      return "unknown";
+  }
+}
+
 /**
  * @brief A single building object
  *
@@ -109,6 +127,9 @@ struct BuildingObject {
   size_t attribute_index;
   bool reconstruction_success = false;
   int reconstruction_time = 0;
+  // time spent in each stage of reconstruct_building(), keyed by the names in
+  // reconstruction_stages
+  std::unordered_map<std::string, std::chrono::duration<double>> stage_timings;
 
   // set in crop
   fs::path jsonl_path;
@@ -489,15 +510,23 @@ int main(int argc, const char* argv[]) {
   // Multithreading setup. The -j/--jobs value is the user-facing worker budget.
   // The cropper, sorter, serializer, logger, and optional tracer use additional
   // mostly-blocking pipeline threads, so keep one job aside for that overhead
-  // and give the rest to the CPU-heavy reconstruction pool.
+  // and give the rest to the CPU-heavy reconstruction scheduler. All
+  // reconstruction work, including parallel loops inside a building, runs on
+  // this one scheduler so that the job budget is not oversubscribed.
   const size_t requested_jobs = static_cast<size_t>(handler._jobs);
   const size_t nthreads_reconstructor_pool =
       requested_jobs > 1 ? requested_jobs - 1 : 1;
   const auto system_threads = std::thread::hardware_concurrency();
-  logger.info(
-      "Using {} threads for the reconstructor pool (-j/--jobs {}, system "
-      "offers {})",
-      nthreads_reconstructor_pool, requested_jobs, system_threads);
+  std::optional<TaskScheduler> reconstructor_pool;
+  if (!handler._crop_only) {
+    reconstructor_pool.emplace(nthreads_reconstructor_pool,
+                               handler._cpu_affinity);
+    logger.info(
+        "Using {} threads for the reconstructor pool (-j/--jobs {}, system "
+        "offers {}{})",
+        nthreads_reconstructor_pool, requested_jobs, system_threads,
+        handler._cpu_affinity ? ", pinned to CPUs" : "");
+  }
 
   std::atomic crop_running{true};
   std::deque<BuildingTile> cropped_tiles;
@@ -531,33 +560,121 @@ int main(int argc, const char* argv[]) {
   std::atomic<size_t> serialized_buildings_cnt = 0;
   std::optional<std::thread> tracer_thread;
 
+  auto& metrics_registry = metrics::Registry::get();
+  auto pipeline_duration = [&metrics_registry](std::string_view stage)
+      -> metrics::Histogram& {
+    return metrics_registry.histogram(
+        "roofer_pipeline_stage_duration_seconds",
+        "Duration of the crop (per tile), reconstruct (per building) and "
+        "serialize (per tile) stages.",
+        {{"stage", stage}});
+  };
+  std::optional<TimingReport> timing_report;
+  if (!handler._timing_report.empty() && !handler._crop_only) {
+    timing_report.emplace(reconstruction_stages);
+  }
+  std::optional<metrics::Exporter> metrics_exporter;
+  if (!handler._metrics_file.empty() || !handler._metrics_socket.empty()) {
+    try {
+      metrics_exporter.emplace(
+          handler._metrics_file, handler._metrics_socket,
+          std::chrono::seconds(handler._metrics_interval), [&] {
+            auto& r = metrics_registry;
+            r.counter("roofer_tiles_cropped", "Tiles that were cropped.")
+                .set(cropped_tiles_cnt);
+            r.counter("roofer_buildings_cropped",
+                      "Buildings that were cropped.")
+                .set(cropped_buildings_cnt);
+            r.counter("roofer_buildings_reconstructed",
+                      "Buildings that finished reconstruction, including "
+                      "failures.")
+                .set(reconstructed_buildings_cnt);
+            r.counter("roofer_tiles_serialized", "Tiles that were written.")
+                .set(serialized_tiles_cnt);
+            r.counter("roofer_buildings_serialized",
+                      "Buildings that were written.")
+                .set(serialized_buildings_cnt);
+
+            auto queue_depth = [&r](std::string_view queue) -> metrics::Gauge& {
+              return r.gauge("roofer_queue_depth",
+                             "Number of items waiting in a pipeline queue.",
+                             {{"queue", queue}});
+            };
+            {
+              std::scoped_lock lock{cropped_tiles_mutex};
+              queue_depth("cropped_tiles").set(cropped_tiles.size());
+            }
+            {
+              std::scoped_lock lock{reconstructed_buildings_mutex};
+              queue_depth("reconstructed_buildings")
+                  .set(reconstructed_buildings.size());
+            }
+            {
+              std::scoped_lock lock{reconstructed_tiles_mutex};
+              queue_depth("reconstructed_tiles")
+                  .set(reconstructed_tiles.size());
+            }
+            {
+              std::scoped_lock lock{sorted_tiles_mutex};
+              queue_depth("sorted_tiles").set(sorted_tiles.size());
+            }
+            if (reconstructor_pool.has_value()) {
+              queue_depth("buildings_to_reconstruct")
+                  .set(reconstructor_pool->tasks_queued());
+              r.gauge("roofer_busy_workers",
+                      "Reconstruction workers that are running a task.")
+                  .set(reconstructor_pool->tasks_running());
+            }
+            r.gauge("roofer_resident_memory_bytes", "Resident set size.")
+                .set(GetCurrentRSS());
+#ifdef RF_ENABLE_HEAP_TRACING
+            r.gauge("roofer_heap_bytes",
+                    "Bytes currently allocated on the heap.")
+                .set(heap_allocation_counter.current_usage());
+#endif
+          });
+    } catch (const std::exception& e) {
+      logger.error("Failed to start the metrics exporter. {}", e.what());
+      return EXIT_FAILURE;
+    }
+  }
+
   std::thread reconstructor_thread;
   std::thread serializer_thread;
   std::thread sorter_thread;
 
+#ifdef RF_ENABLE_HEAP_TRACING
+  // Bytes allocated so far in each allocation scope that has been closed
+  auto trace_allocation_scopes = [&logger] {
+    for (const auto& [scope, stats] : AllocationScope::totals()) {
+      logger.trace("alloc_" + scope, stats.allocated);
+    }
+  };
+#endif
   if (do_tracing) {
     tracer_thread.emplace([&] {
       while (crop_running.load() || reconstruction_running.load() ||
              serialization_running.load()) {
 #ifdef RF_ENABLE_HEAP_TRACING
         logger.trace("heap", heap_allocation_counter.current_usage());
+        trace_allocation_scopes();
 #endif
         logger.trace("rss", GetCurrentRSS());
         logger.trace("crop", cropped_buildings_cnt);
         logger.trace("reconstruct", reconstructed_buildings_cnt);
         logger.trace("sort", sorted_buildings_cnt);
         logger.trace("serialize", serialized_buildings_cnt);
-        // logger.debug(
-        //     "[reconstructor] reconstructor_pool nr. tasks waiting in the
-        //     queue "
-        //     "== {}",
-        //     reconstructor_pool.get_tasks_queued());
+        if (reconstructor_pool.has_value()) {
+          logger.trace("tasks_queued", reconstructor_pool->tasks_queued());
+          logger.trace("tasks_running", reconstructor_pool->tasks_running());
+        }
         std::this_thread::sleep_for(trace_interval);
       }
 // We log once more after all threads have finished, to measure the finaly
 // memory use
 #ifdef RF_ENABLE_HEAP_TRACING
       logger.trace("heap", heap_allocation_counter.current_usage());
+      trace_allocation_scopes();
 #endif
       logger.trace("rss", GetCurrentRSS());
       logger.trace("crop", cropped_buildings_cnt);
@@ -575,6 +692,7 @@ int main(int argc, const char* argv[]) {
       try {
         // crop each tile
         logger.debug("[cropper] Cropping tile {}", building_tile);
+        auto crop_start = std::chrono::steady_clock::now();
         // crop_tile returns true if at least one building was cropped
         if (!crop_tile(building_tile.extent,        // tile extent
                        handler.input_pointclouds_,  // input pointclouds
@@ -584,6 +702,8 @@ int main(int argc, const char* argv[]) {
           logger.info("No footprints found in tile {}, skipping...",
                       building_tile.id);
         } else {
+          pipeline_duration("crop").observe(std::chrono::steady_clock::now() -
+                                            crop_start);
           building_tile.buildings_cnt = building_tile.buildings.size();
           building_tile.buildings_progresses.resize(
               building_tile.buildings_cnt);
@@ -619,7 +739,6 @@ int main(int argc, const char* argv[]) {
   });
 
   if (!handler._crop_only) {
-    BS::thread_pool reconstructor_pool(nthreads_reconstructor_pool);
     reconstructor_thread = std::thread([&]() {
       logger.info(
           "[reconstructor] Starting reconstruction with {} worker "
@@ -678,12 +797,17 @@ int main(int argc, const char* argv[]) {
           cropped_buildings.pop_front();
           ++reconstructed_started_cnt;
 
-          reconstructor_pool.detach_task([bref = std::move(building_ref),
+          reconstructor_pool->detach_task([bref = std::move(building_ref),
                                           cfg = &handler.cfg_,
+                                          scheduler = &*reconstructor_pool,
                                           &reconstructed_buildings,
                                           &reconstructed_buildings_cnt,
                                           &reconstructed_buildings_mutex,
-                                          &reconstructed_pending] {
+                                          &reconstructed_pending,
+                                          &reconstruct_duration =
+                                              pipeline_duration("reconstruct"),
+                                          &metrics_registry,
+                                          &timing_report] {
             // TODO: It seems that I need to assign the moved 'building_ref' to
             // a
             //  new variable with an explicit type here, because 'bref' contains
@@ -691,22 +815,26 @@ int main(int argc, const char* argv[]) {
             //  that "Non-const lvalue reference to type BuildingObject cannot
             //  bind to lvalue of type const BuildingObject".
             BuildingObjectRef building_object_ref = bref;
+            const auto start = std::chrono::high_resolution_clock::now();
             try {
               auto& logger = roofer::logger::Logger::get_logger();
-              auto start = std::chrono::high_resolution_clock::now();
               logger.debug("[reconstructor] start: {}",
                            building_object_ref.building.jsonl_path.string());
-              reconstruct_building(building_object_ref.building, cfg);
+              reconstruct_building(building_object_ref.building, cfg,
+                                   scheduler);
               logger.debug("[reconstructor] finish: {}",
                            building_object_ref.building.jsonl_path.string());
               // TODO: These two seem to be redundant
               building_object_ref.progress = RECONSTRUCTION_SUCCEEDED;
               building_object_ref.building.reconstruction_success = true;
+              const auto duration =
+                  std::chrono::high_resolution_clock::now() - start;
               building_object_ref.building.reconstruction_time =
                   static_cast<int>(
                       std::chrono::duration_cast<std::chrono::milliseconds>(
-                          std::chrono::high_resolution_clock::now() - start)
+                          duration)
                           .count());
+              reconstruct_duration.observe(duration);
             } catch (const std::exception& e) {
               building_object_ref.building.multisolids_lod12.clear();
               building_object_ref.building.multisolids_lod13.clear();
@@ -730,6 +858,22 @@ int main(int argc, const char* argv[]) {
                   "exception.",
                   building_object_ref.building.jsonl_path.string());
             }
+            for (const auto& [stage, duration] :
+                 building_object_ref.building.stage_timings) {
+              metrics_registry
+                  .histogram(
+                      "roofer_reconstruction_stage_duration_seconds",
+                      "Duration of each reconstruction stage per building.",
+                      {{"stage", stage}})
+                  .observe(duration);
+            }
+            if (timing_report) {
+              timing_report->add(
+                  building_object_ref.building.stage_timings,
+                  extrusion_mode_name(
+                      building_object_ref.building.extrusion_mode),
+                  std::chrono::high_resolution_clock::now() - start);
+            }
             size_t processed_count = 0;
             {
               std::scoped_lock lock_reconstructed{
@@ -749,7 +893,7 @@ int main(int argc, const char* argv[]) {
 
       logger.debug(
           "[reconstructor] Waiting for all reconstructor threads to join...");
-      reconstructor_pool.wait();
+      reconstructor_pool->wait();
 
       if (!cropped_tiles.empty()) {
         logger.error(
@@ -858,6 +1002,13 @@ int main(int argc, const char* argv[]) {
     serializer_thread = std::thread([&]() {
       logger.info("[serializer] Output directory: {}",
                   handler.cfg_.output_path);
+      auto& bytes_written = metrics_registry.counter(
+          "roofer_output_bytes", "Bytes written to the output files.");
+      auto close_and_count = [&bytes_written](std::ofstream& ofs) {
+        const auto pos = ofs.tellp();
+        if (pos > 0) bytes_written.inc(static_cast<uint64_t>(pos));
+        ofs.close();
+      };
       while (true) {
         std::unique_lock lock{sorted_tiles_mutex};
         sorted_pending.wait(lock, [&sorted_tiles, &sorting_running] {
@@ -873,6 +1024,8 @@ int main(int argc, const char* argv[]) {
 
         while (!pending_serialized.empty()) {
           auto& building_tile = pending_serialized.front();
+          auto serialize_start = std::chrono::steady_clock::now();
+          AllocationScope heap_scope("serialize");
           logger.info("[serializer] Tile {}: writing {} buildings",
                       building_tile.id, building_tile.buildings_cnt);
           logger.debug("[serializer] Serializing tile {}", building_tile);
@@ -946,7 +1099,7 @@ int main(int argc, const char* argv[]) {
               CityJsonWriter->write_metadata(
                   ofs, project_srs.get(), building_tile.extent,
                   {.identifier = std::to_string(building_tile.id)});
-              ofs.close();
+              close_and_count(ofs);
             }
           }
 
@@ -963,6 +1116,7 @@ int main(int argc, const char* argv[]) {
               CityJsonWriter->write_tin_relief_feature(
                   terrain_ofs, terrain_id, building_tile.terrain->components,
                   building_tile.terrain->attributes);
+              close_and_count(terrain_ofs);
             } else {
               CityJsonWriter->write_tin_relief_feature(
                   ofs, terrain_id, building_tile.terrain->components,
@@ -1014,26 +1168,25 @@ int main(int argc, const char* argv[]) {
                 attrow.insert_optional(handler.cfg_.a_roof_n_ridgelines,
                                        building.roof_n_ridgelines);
               if (!handler.cfg_.a_extrusion_mode.empty()) {
-                std::string extrusion_mode_str;
-                switch (building.extrusion_mode) {
-                  case STANDARD:
-                    extrusion_mode_str = "standard";
-                    break;
-                  case LOD11_FALLBACK:
-                    extrusion_mode_str = "lod11_fallback";
-                    break;
-                  case SKIP:
-                    extrusion_mode_str = "skip";
-                    break;
-                  case FAIL:
-                    extrusion_mode_str = "fail";
-                    break;
-                  default:
-                    extrusion_mode_str = "unknown";
-                    break;
+                attrow.insert(
+                    handler.cfg_.a_extrusion_mode,
+                    std::string(extrusion_mode_name(building.extrusion_mode)));
+              }
+              if (handler.cfg_.write_stage_timings &&
+                  !handler.cfg_.a_stage_time_prefix.empty()) {
+                for (const auto& stage : reconstruction_stages) {
+                  std::optional<int> ms;
+                  auto it = building.stage_timings.find(std::string(stage));
+                  if (it != building.stage_timings.end()) {
+                    ms = static_cast<int>(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                            it->second)
+                            .count());
+                  }
+                  attrow.insert_optional(
+                      handler.cfg_.a_stage_time_prefix + std::string(stage),
+                      ms);
                 }
-                attrow.insert(handler.cfg_.a_extrusion_mode,
-                              extrusion_mode_str);
               }
 
               std::unordered_map<int, roofer::Mesh>* ms12 = nullptr;
@@ -1089,7 +1242,7 @@ int main(int argc, const char* argv[]) {
               CityJsonWriter->write_feature(ofs, building.footprint, ms12, ms13,
                                             ms22, attrow);
               if (handler.cfg_.split_cjseq) {
-                ofs.close();
+                close_and_count(ofs);
               }
               ++serialized_buildings_cnt;
             } catch (const std::exception& e) {
@@ -1098,9 +1251,11 @@ int main(int argc, const char* argv[]) {
             }
           }
           if (!handler.cfg_.split_cjseq) {
-            ofs.close();
+            close_and_count(ofs);
           }
           ++serialized_tiles_cnt;
+          pipeline_duration("serialize")
+              .observe(std::chrono::steady_clock::now() - serialize_start);
           logger.info("[serializer] Tile {}: wrote {} buildings",
                       building_tile.id, building_tile.buildings_cnt);
           pending_serialized.pop_front();
@@ -1124,6 +1279,26 @@ int main(int argc, const char* argv[]) {
     tracer_thread->join();
   }
 
+  if (timing_report) {
+    auto report = timing_report->to_json();
+#ifdef RF_ENABLE_HEAP_TRACING
+    nlohmann::ordered_json allocation_scopes;
+    for (const auto& [scope, stats] : AllocationScope::totals()) {
+      allocation_scopes[scope] = {{"count", stats.count},
+                                  {"allocated_bytes", stats.allocated},
+                                  {"freed_bytes", stats.freed},
+                                  {"peak_bytes", stats.peak}};
+    }
+    report["allocation_scopes"] = std::move(allocation_scopes);
+#endif
+    if (write_json(handler._timing_report, report)) {
+      logger.info("Wrote timing report to {}", handler._timing_report);
+    } else {
+      logger.error("Failed to write timing report to {}",
+                   handler._timing_report);
+    }
+  }
+
   if (!cropped_tiles.empty() && !handler._crop_only) {
     logger.error(
         "all threads have been joined, but cropped_tiles is "
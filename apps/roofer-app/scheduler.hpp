@@ -0,0 +1,256 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#if defined(IS_WINDOWS)
+#include <windows.h>
+#elif defined(IS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef RF_USE_TBB
+#include <tbb/global_control.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#include <tbb/task_scheduler_observer.h>
+#else
+#include "BS_thread_pool.hpp"
+#endif
+
+// Pin the calling thread to a single logical CPU. The slot is wrapped around
+// the number of logical CPUs. Returns false if pinning is not supported on
+// this platform (eg. macOS) or failed.
+inline bool pin_current_thread(std::size_t slot) {
+  const auto ncpu = std::thread::hardware_concurrency();
+  if (ncpu == 0) return false;
+  const std::size_t cpu = slot % ncpu;
+#if defined(IS_WINDOWS)
+  if (cpu >= sizeof(DWORD_PTR) * 8) return false;
+  return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#elif defined(IS_LINUX)
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpu, &cpu_set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                &cpu_set) == 0;
+#else
+  return false;
+#endif
+}
+
+// The single scheduler that executes all CPU-heavy work of the application.
+// It is sized to the -j/--jobs budget and owns every worker thread, so that
+// nested parallelism (eg. CGAL's Parallel_tag algorithms when roofer is built
+// with TBB) runs on the same workers instead of spawning its own thread pool
+// on top of the building tasks.
+//
+// With RF_USE_TBB the scheduler is a tbb::task_arena, and TBB's global
+// parallelism is capped to the same budget. Otherwise it wraps a
+// BS::thread_pool.
+class TaskScheduler {
+ public:
+  TaskScheduler(std::size_t concurrency, bool pin_threads)
+      : concurrency_(concurrency == 0 ? 1 : concurrency)
+#ifdef RF_USE_TBB
+        ,
+        // +1 for the external thread that submits the tasks, the arena
+        // itself is limited to `concurrency` slots
+        global_limit_(tbb::global_control::max_allowed_parallelism,
+                      concurrency_ + 1),
+        arena_(static_cast<int>(concurrency_), 0),
+        observer_(arena_, pin_threads)
+#else
+        ,
+        pool_(concurrency_, [pin_threads](std::size_t idx) {
+          if (pin_threads) pin_current_thread(idx);
+        })
+#endif
+  {
+  }
+
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+  ~TaskScheduler() { wait(); }
+
+  [[nodiscard]] std::size_t concurrency() const { return concurrency_; }
+
+  // Submit a task without a result. Use wait() to block until all submitted
+  // tasks are finished.
+  template <typename F>
+  void detach_task(F&& task) {
+    ++tasks_pending_;
+    auto wrapped = [this, task = std::forward<F>(task)]() {
+      // the counters are also released if the task throws
+      struct RunningGuard {
+        TaskScheduler& scheduler;
+        explicit RunningGuard(TaskScheduler& s) : scheduler(s) {
+          ++scheduler.tasks_running_;
+        }
+        ~RunningGuard() {
+          --scheduler.tasks_running_;
+          --scheduler.tasks_pending_;
+        }
+      } guard(*this);
+      task();
+    };
+#ifdef RF_USE_TBB
+    arena_.execute([&] { group_.run(std::move(wrapped)); });
+#else
+    pool_.detach_task(std::move(wrapped));
+#endif
+  }
+
+  // Block until all tasks that were submitted with detach_task are finished.
+  // The calling thread must not be one of the scheduler's own workers.
+  void wait() {
+#ifdef RF_USE_TBB
+    arena_.execute([&] { group_.wait(); });
+#else
+    pool_.wait();
+#endif
+  }
+
+  // Run the callables concurrently and return when all of them are finished.
+  // This is meant for splitting up a task that is already running on the
+  // scheduler, and may be nested. The first exception that is thrown by a
+  // callable is rethrown after all callables are finished.
+  //
+  // Without TBB the calling thread runs the first callable itself, and then
+  // claims each of the others that no worker has started yet. It only blocks
+  // on callables that are already running on another worker, so the call can
+  // not deadlock when all workers are busy.
+  template <typename... F>
+  void parallel_invoke(F&&... callables) {
+    static_assert(sizeof...(F) >= 2, "parallel_invoke needs two callables");
+#ifdef RF_USE_TBB
+    // While it waits, the calling thread only takes part in the work of this
+    // call. Without isolation it could steal another building's task, which
+    // would delay this building and count the other building's time and
+    // allocations as its own.
+    arena_.execute([&] {
+      tbb::this_task_arena::isolate(
+          [&] { tbb::parallel_invoke(callables...); });
+    });
+#else
+    struct Subtask {
+      std::atomic<bool> claimed = false;
+      std::atomic<bool> done = false;
+      std::exception_ptr error;
+    };
+    // Shared with the pool tasks, which may only run after this call returned
+    // if the calling thread claimed their callable.
+    auto subtasks = std::make_shared<std::array<Subtask, sizeof...(F)>>();
+    auto run = [](Subtask& subtask, auto& callable) {
+      try {
+        callable();
+      } catch (...) {
+        subtask.error = std::current_exception();
+      }
+      subtask.done = true;
+      subtask.done.notify_all();
+    };
+    std::tuple<F&...> refs(callables...);
+
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      // offer all but the first callable to the workers
+      (
+          [&] {
+            if constexpr (I > 0) {
+              pool_.detach_task(
+                  [subtasks, run, &callable = std::get<I>(refs)] {
+                    auto& subtask = (*subtasks)[I];
+                    if (!subtask.claimed.exchange(true)) run(subtask, callable);
+                  });
+            }
+          }(),
+          ...);
+      // run every callable that has not been claimed by a worker
+      (
+          [&] {
+            auto& subtask = (*subtasks)[I];
+            if (!subtask.claimed.exchange(true)) {
+              run(subtask, std::get<I>(refs));
+            }
+          }(),
+          ...);
+    }(std::index_sequence_for<F...>{});
+
+    for (auto& subtask : *subtasks) subtask.done.wait(false);
+    for (auto& subtask : *subtasks) {
+      if (subtask.error) std::rethrow_exception(subtask.error);
+    }
+#endif
+  }
+
+  [[nodiscard]] std::size_t tasks_running() const { return tasks_running_; }
+  [[nodiscard]] std::size_t tasks_queued() const {
+    // a task that finishes between the two loads lowers both counters, so
+    // read the running count first and clamp the difference at zero
+    const std::size_t running = tasks_running_;
+    const std::size_t pending = tasks_pending_;
+    return pending > running ? pending - running : 0;
+  }
+
+ private:
+#ifdef RF_USE_TBB
+  // Pins each thread that enters the arena to the CPU of its arena slot.
+  class PinningObserver : public tbb::task_scheduler_observer {
+    bool pin_threads_;
+
+   public:
+    PinningObserver(tbb::task_arena& arena, bool pin_threads)
+        : tbb::task_scheduler_observer(arena), pin_threads_(pin_threads) {
+      if (pin_threads_) observe(true);
+    }
+    ~PinningObserver() override {
+      if (pin_threads_) observe(false);
+    }
+    void on_scheduler_entry(bool) override {
+      const int slot = tbb::this_task_arena::current_thread_index();
+      if (slot >= 0) pin_current_thread(static_cast<std::size_t>(slot));
+    }
+  };
+#endif
+
+  std::size_t concurrency_;
+  std::atomic<std::size_t> tasks_pending_ = 0;
+  std::atomic<std::size_t> tasks_running_ = 0;
+#ifdef RF_USE_TBB
+  tbb::global_control global_limit_;
+  tbb::task_arena arena_;
+  PinningObserver observer_;
+  tbb::task_group group_;
+#else
+  BS::thread_pool<> pool_;
+#endif
+};
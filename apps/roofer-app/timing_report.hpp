@@ -0,0 +1,156 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "metrics.hpp"
+
+// Write `json` to the file at `path`. Returns false if the file could not be
+// written.
+inline bool write_json(const std::string& path,
+                       const nlohmann::ordered_json& json) {
+  std::ofstream ofs(path);
+  ofs << json.dump(2) << '\n';
+  ofs.close();
+  return !ofs.fail();
+}
+
+// Collects the per-stage reconstruction timings of all buildings in a run and
+// summarises them in a JSON report. Each stage is tracked per building outcome
+// (the extrusion mode: standard, lod11_fallback, skip or fail) and over all
+// buildings. The extrude stages of the individual LoDs are additionally
+// reported per LoD.
+//
+// Quantiles come from metrics::Histogram and are accurate to one histogram
+// bucket, ie. within 12.5% of the exact value. Totals are exact sums of the
+// time spent on the workers, which equals CPU time for the stages that run
+// single threaded.
+class TimingReport {
+ public:
+  using StageTimings =
+      std::unordered_map<std::string, std::chrono::duration<double>>;
+
+  // `stages` gives the order of the stages in the report. Stages that are not
+  // in this list are reported after them.
+  explicit TimingReport(std::span<const std::string_view> stages)
+      : stage_order_(stages.begin(), stages.end()) {}
+
+  // Add the stage timings of one building. `total` is the wall-clock time of
+  // the complete reconstruction of the building.
+  void add(const StageTimings& timings, std::string_view outcome,
+           std::chrono::duration<double> total) {
+    std::scoped_lock lock{mutex_};
+    auto& by_stage = histograms_[std::string(outcome)];
+    by_stage[std::string(total_key)].observe(total);
+    all_[std::string(total_key)].observe(total);
+    for (const auto& [stage, duration] : timings) {
+      by_stage[stage].observe(duration);
+      all_[stage].observe(duration);
+    }
+  }
+
+  [[nodiscard]] nlohmann::ordered_json to_json() const {
+    std::scoped_lock lock{mutex_};
+    // ordered_json is backed by a vector, so the sections are filled before
+    // they are added to the report to keep references valid
+    nlohmann::ordered_json buildings, stages, lods;
+    buildings["all"] = count(all_, total_key);
+    for (const auto& [outcome, by_stage] : histograms_) {
+      buildings[outcome] = count(by_stage, total_key);
+    }
+
+    for (const auto& stage : ordered_stages()) {
+      nlohmann::ordered_json entry;
+      entry["all"] = summary(all_.at(stage));
+      for (const auto& [outcome, by_stage] : histograms_) {
+        if (auto it = by_stage.find(stage); it != by_stage.end()) {
+          entry[outcome] = summary(it->second);
+        }
+      }
+      constexpr std::string_view extrude_prefix = "extrude_";
+      if (stage.starts_with(extrude_prefix)) {
+        lods[stage.substr(extrude_prefix.size())] = entry;
+      }
+      stages[stage] = std::move(entry);
+    }
+    return {{"buildings", std::move(buildings)},
+            {"stages", std::move(stages)},
+            {"lods", std::move(lods)}};
+  }
+
+ private:
+  // Key under which the complete reconstruction time of a building is stored.
+  static constexpr std::string_view total_key = "total";
+
+  using Histograms = std::map<std::string, metrics::Histogram, std::less<>>;
+
+  static uint64_t count(const Histograms& histograms, std::string_view key) {
+    auto it = histograms.find(key);
+    return it == histograms.end() ? 0 : it->second.count();
+  }
+
+  static nlohmann::ordered_json summary(const metrics::Histogram& h) {
+    return {{"count", h.count()},
+            {"p50", h.quantile_seconds(0.5)},
+            {"p90", h.quantile_seconds(0.9)},
+            {"p99", h.quantile_seconds(0.99)},
+            {"max", h.max_seconds()},
+            {"total", h.sum_seconds()}};
+  }
+
+  // The stages that have at least one observation, in pipeline order,
+  // followed by the total reconstruction time.
+  [[nodiscard]] std::vector<std::string> ordered_stages() const {
+    std::vector<std::string> stages;
+    for (const auto& stage : stage_order_) {
+      if (all_.contains(stage)) stages.push_back(stage);
+    }
+    for (const auto& [stage, histogram] : all_) {
+      if (stage != total_key &&
+          std::find(stage_order_.begin(), stage_order_.end(), stage) ==
+              stage_order_.end()) {
+        stages.push_back(stage);
+      }
+    }
+    if (all_.contains(total_key)) stages.emplace_back(total_key);
+    return stages;
+  }
+
+  std::vector<std::string> stage_order_;
+  mutable std::mutex mutex_;
+  // outcome -> stage -> histogram
+  std::map<std::string, Histograms> histograms_;
+  // stage -> histogram, over all outcomes
+  Histograms all_;
+};
@@ -0,0 +1,71 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+// Alpha shapes and segment rasterisation of a single building, with one
+// triangulation per plane and with one shared triangulation, on synthetic
+// roofs of increasing size.
+#include <cstddef>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/AlphaShaper.hpp>
+#include <roofer/reconstruction/PlaneDetector.hpp>
+#include <roofer/reconstruction/SegmentRasteriser.hpp>
+
+#include "synthetic_roofs.hpp"
+
+TEST_CASE("alpha shapes per building size", "[benchmark]") {
+  for (std::size_t n : {10000, 100000, 1000000}) {
+    const auto roof = roofer::bench::synthetic_roof_with_density(n, 20.F);
+    auto detector = roofer::reconstruction::createPlaneDetector();
+    detector->detect(roof);
+
+    for (bool shared : {false, true}) {
+      roofer::reconstruction::AlphaShaperConfig cfg;
+      cfg.shared_triangulation = shared;
+      const auto mode = shared ? "shared" : "per plane";
+      BENCHMARK(fmt::format("{} points, {} triangulation", n, mode)) {
+        auto shaper = roofer::reconstruction::createAlphaShaper();
+        shaper->compute(detector->pts_per_roofplane, cfg);
+        return shaper->alpha_rings.size();
+      };
+      BENCHMARK(fmt::format("{} points, {} triangulation, rasterised", n,
+                            mode)) {
+        auto shaper = roofer::reconstruction::createAlphaShaper();
+        shaper->compute(detector->pts_per_roofplane, cfg);
+        auto rasteriser = roofer::reconstruction::createSegmentRasteriser();
+        roofer::reconstruction::SegmentRasteriserConfig raster_cfg;
+        raster_cfg.use_ground = false;
+        if (shared) {
+          roofer::IndexedTriangleCollection no_ground;
+          rasteriser->compute(shaper->alpha_triangle_mesh, no_ground,
+                              raster_cfg);
+        } else {
+          roofer::TriangleCollection no_ground;
+          rasteriser->compute(shaper->alpha_triangles, no_ground, raster_cfg);
+        }
+        return rasteriser->heightfield.dimx_;
+      };
+    }
+  }
+}
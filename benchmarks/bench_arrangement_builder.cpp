@@ -0,0 +1,108 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+
+// Arrangement construction on a footprint with an increasing number of roof
+// lines, with the lines inserted in one sweep, one at a time, or after snap
+// rounding them. The second benchmark of each mode also computes the area of
+// every face, as the stages after the builder do, which evaluates the
+// coordinates of the constructed intersection points.
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/ArrangementBase.hpp>
+#include <roofer/reconstruction/ArrangementBuilder.hpp>
+
+namespace {
+  using roofer::EPECK;
+
+  roofer::LinearRing square_footprint(double size) {
+    roofer::LinearRing footprint;
+    footprint.push_back({0, 0, 0});
+    footprint.push_back({float(size), 0, 0});
+    footprint.push_back({float(size), float(size), 0});
+    footprint.push_back({0, float(size), 0});
+    return footprint;
+  }
+
+  std::vector<EPECK::Segment_2> random_lines(std::size_t n, double size) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> pos(0., size), len(2., 10.);
+    std::uniform_int_distribution<int> direction(0, 7);
+    std::vector<EPECK::Segment_2> lines;
+    for (std::size_t i = 0; i < n; ++i) {
+      const double angle = direction(gen) * std::numbers::pi / 8;
+      const double x = pos(gen), y = pos(gen), l = len(gen);
+      lines.emplace_back(EPECK::Point_2(x, y),
+                         EPECK::Point_2(x + l * std::cos(angle),
+                                        y + l * std::sin(angle)));
+    }
+    return lines;
+  }
+
+  enum class Mode { batch, incremental, snap_rounded };
+
+  roofer::Arrangement_2 build(roofer::LinearRing& footprint,
+                              std::vector<EPECK::Segment_2>& lines, Mode mode) {
+    roofer::reconstruction::ArrangementBuilderConfig cfg;
+    cfg.incremental_insert = mode == Mode::incremental;
+    cfg.snap_rounding = mode == Mode::snap_rounded;
+    roofer::Arrangement_2 arrangement;
+    roofer::reconstruction::createArrangementBuilder()->compute(
+        arrangement, footprint, lines, cfg);
+    return arrangement;
+  }
+}  // namespace
+
+TEST_CASE("arrangement construction per line count", "[benchmark]") {
+  const std::pair<Mode, const char*> modes[] = {
+      {Mode::batch, "sweep"},
+      {Mode::incremental, "incremental"},
+      {Mode::snap_rounded, "snap rounded"}};
+  for (std::size_t n : {25, 250, 1000}) {
+    const double size = 5. * std::sqrt(double(n));
+    auto footprint = square_footprint(size);
+    auto lines = random_lines(n, size);
+    for (auto [mode, name] : modes) {
+      BENCHMARK(fmt::format("{} lines, {}", n, name)) {
+        return build(footprint, lines, mode).number_of_faces();
+      };
+      BENCHMARK(fmt::format("{} lines, {}, face areas", n, name)) {
+        auto arrangement = build(footprint, lines, mode);
+        double area = 0;
+        for (auto face : arrangement.face_handles()) {
+          if (face->is_unbounded() || !face->data().in_footprint) continue;
+          area += CGAL::to_double(
+              roofer::reconstruction::arr_cell2polygon(face).area());
+        }
+        return area;
+      };
+    }
+  }
+}
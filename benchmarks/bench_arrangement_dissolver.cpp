@@ -0,0 +1,98 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+
+// Dissolving the step edges of a grid arrangement over a synthetic
+// heightfield, which computes the elevation statistics of the faces before
+// and after merging them. The arrangement is copied in each run, because the
+// dissolver merges its faces.
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/ArrangementDissolver.hpp>
+
+namespace {
+  using roofer::Point_2;
+  using roofer::Segment_2;
+
+  // a grid of k x k faces with a flat roof each, on one of 5 elevations that
+  // are 2 m apart, so that the step edges between most faces are dissolved
+  roofer::Arrangement_2 grid_arrangement(std::size_t k, double size) {
+    roofer::Arrangement_2 arrangement;
+    for (std::size_t i = 0; i <= k; ++i) {
+      const double t = size * double(i) / double(k);
+      CGAL::insert(arrangement, Segment_2(Point_2(t, 0), Point_2(t, size)));
+      CGAL::insert(arrangement, Segment_2(Point_2(0, t), Point_2(size, t)));
+    }
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> level(0, 4);
+    int segid = 0;
+    for (auto face : arrangement.face_handles()) {
+      if (face->is_unbounded()) continue;
+      face->data().in_footprint = true;
+      face->data().segid = ++segid;
+      face->data().plane = roofer::Plane(0, 0, 1, -10 - 2 * level(gen));
+    }
+    return arrangement;
+  }
+
+  roofer::RasterTools::Raster noisy_heightfield(double size) {
+    roofer::RasterTools::Raster heightfield(0.5, 0, size, 0, size);
+    heightfield.prefill_arrays(roofer::RasterTools::MIN);
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<float> height(10.F, 18.F);
+    for (std::size_t row = 0; row < heightfield.dimy_; ++row) {
+      for (std::size_t col = 0; col < heightfield.dimx_; ++col) {
+        // leave some cells without data
+        if ((row * 7 + col * 3) % 11 == 0) continue;
+        heightfield.set_val(col, row, height(gen));
+      }
+    }
+    return heightfield;
+  }
+}  // namespace
+
+TEST_CASE("arrangement dissolve per face count", "[benchmark]") {
+  auto elevation_provider =
+      roofer::reconstruction::createElevationProvider(0.0F);
+  for (std::size_t k : {10, 20, 40, 80}) {
+    const double size = 2.0 * double(k);
+    const auto arrangement = grid_arrangement(k, size);
+    const auto heightfield = noisy_heightfield(size);
+    for (bool face_label_raster : {false, true}) {
+      roofer::reconstruction::ArrangementDissolverConfig cfg;
+      cfg.dissolve_step_edges = true;
+      cfg.face_label_raster = face_label_raster;
+      BENCHMARK(fmt::format("{} faces{}", k * k,
+                            face_label_raster ? ", face label raster" : "")) {
+        auto arr = arrangement;
+        roofer::reconstruction::createArrangementDissolver()->compute(
+            arr, heightfield, *elevation_provider, cfg);
+        return arr.number_of_faces();
+      };
+    }
+  }
+}
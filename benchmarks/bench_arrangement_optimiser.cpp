@@ -0,0 +1,128 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+
+// Graph-cut optimisation of a grid arrangement over a synthetic heightfield,
+// with the data term computed from one raster of face labels and, as before,
+// by rasterising every face separately, and with each of the graph-cut
+// implementations. The arrangement is copied in each run, because the
+// optimiser writes its labels into the faces.
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/ArrangementOptimiser.hpp>
+
+namespace {
+  using roofer::Point_2;
+  using roofer::Segment_2;
+
+  roofer::Arrangement_2 grid_arrangement(std::size_t k, double size) {
+    roofer::Arrangement_2 arrangement;
+    for (std::size_t i = 0; i <= k; ++i) {
+      const double t = size * double(i) / double(k);
+      CGAL::insert(arrangement, Segment_2(Point_2(t, 0), Point_2(t, size)));
+      CGAL::insert(arrangement, Segment_2(Point_2(0, t), Point_2(size, t)));
+    }
+    for (auto face : arrangement.face_handles()) {
+      face->data().in_footprint = !face->is_unbounded();
+    }
+    return arrangement;
+  }
+
+  // a heightfield of two gables along x, with noise
+  roofer::RasterTools::Raster gable_heightfield(double size) {
+    roofer::RasterTools::Raster heightfield(0.5, 0, size, 0, size);
+    heightfield.prefill_arrays(roofer::RasterTools::MIN);
+    std::mt19937 gen(1);
+    std::normal_distribution<float> noise(0.F, 0.05F);
+    for (std::size_t row = 0; row < heightfield.dimy_; ++row) {
+      for (std::size_t col = 0; col < heightfield.dimx_; ++col) {
+        const double y = heightfield.miny_ + (double(row) + 0.5) * 0.5;
+        const double ridge = std::abs(std::fmod(y, size / 2) - size / 4);
+        heightfield.set_val(col, row, 10 - 0.5 * ridge + noise(gen));
+      }
+    }
+    return heightfield;
+  }
+
+  roofer::IndexedPlanesWithPoints roof_planes(std::size_t n) {
+    roofer::IndexedPlanesWithPoints planes;
+    for (std::size_t i = 0; i < n; ++i) {
+      const double slope = 0.5 * (i % 2 ? 1 : -1);
+      planes[int(i) + 1] = {roofer::Plane(0, slope, 1, -10 - double(i)), {}};
+    }
+    return planes;
+  }
+}  // namespace
+
+TEST_CASE("arrangement optimisation per face count", "[benchmark]") {
+  const auto planes = roof_planes(12);
+  const roofer::IndexedPlanesWithPoints ground_planes;
+  for (std::size_t k : {10, 20, 40}) {
+    const double size = 2.0 * double(k);
+    const auto arrangement = grid_arrangement(k, size);
+    const auto heightfield = gable_heightfield(size);
+    for (bool face_label_raster : {false, true}) {
+      roofer::reconstruction::ArrangementOptimiserConfig cfg;
+      cfg.face_label_raster = face_label_raster;
+      BENCHMARK(fmt::format("{} faces, {}", k * k,
+                            face_label_raster ? "face label raster"
+                                              : "per face rasterisation")) {
+        auto arr = arrangement;
+        roofer::reconstruction::createArrangementOptimiser()->compute(
+            arr, heightfield, planes, ground_planes, cfg);
+        return arr.number_of_faces();
+      };
+    }
+  }
+}
+
+TEST_CASE("arrangement optimisation per graph-cut implementation",
+          "[benchmark]") {
+  const auto planes = roof_planes(12);
+  const roofer::IndexedPlanesWithPoints ground_planes;
+  const char* names[] = {"boost adjacency list", "boost compressed sparse row",
+                         "MaxFlow", "in-tree"};
+  for (std::size_t k : {10, 20, 40, 80}) {
+    const double size = 2.0 * double(k);
+    const auto arrangement = grid_arrangement(k, size);
+    const auto heightfield = gable_heightfield(size);
+    for (int impl = 0; impl < 4; ++impl) {
+      for (bool warm_start : {false, true}) {
+        roofer::reconstruction::ArrangementOptimiserConfig cfg;
+        cfg.graph_cut_impl = impl;
+        cfg.warm_start = warm_start;
+        BENCHMARK(fmt::format("{} faces, {}{}", k * k, names[impl],
+                              warm_start ? ", warm start" : "")) {
+          auto arr = arrangement;
+          roofer::reconstruction::createArrangementOptimiser()->compute(
+              arr, heightfield, planes, ground_planes, cfg);
+          return arr.number_of_faces();
+        };
+      }
+    }
+  }
+}
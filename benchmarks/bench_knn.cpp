@@ -0,0 +1,83 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+// k-nearest-neighbour graph of a single building with the float32 grid index
+// and with the CGAL kd-tree, for the k that plane detection uses for normal
+// estimation and region growing. The saving of sharing one graph between the
+// normal estimation, the region growing and the plane adjacency is measured
+// against the three searches that these stages used to run.
+#include <cstddef>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/KnnGraph.hpp>
+#include <roofer/reconstruction/KnnIndex.hpp>
+
+#include "synthetic_roofs.hpp"
+
+TEST_CASE("k-NN graph per building", "[benchmark]") {
+  using roofer::reconstruction::KnnBackend;
+  constexpr std::size_t k = 16;
+
+  for (std::size_t n : {1000, 10000, 100000, 1000000}) {
+    const auto roof = roofer::bench::synthetic_roof_with_density(n, 20.F);
+
+    BENCHMARK(fmt::format("{} points, CGAL kd-tree", n)) {
+      return roofer::reconstruction::compute_knn_graph(
+          roof, k, KnnBackend::cgal_kd_tree);
+    };
+    BENCHMARK(fmt::format("{} points, grid", n)) {
+      return roofer::reconstruction::compute_knn_graph(roof, k,
+                                                       KnnBackend::grid);
+    };
+    BENCHMARK(fmt::format("{} points, grid, sequential", n)) {
+      return roofer::reconstruction::KnnIndex(roof).all_knn(k, false);
+    };
+  }
+}
+
+TEST_CASE("k-NN graph shared by the plane detection stages", "[benchmark]") {
+  using roofer::reconstruction::KnnBackend;
+  // the default normal_neighbour_count and plane_neighbour_count + 1
+  constexpr std::size_t normal_k = 5, plane_k = 16;
+
+  for (std::size_t n : {1000, 10000, 100000}) {
+    const auto roof = roofer::bench::synthetic_roof_with_density(n, 20.F);
+
+    for (auto backend : {KnnBackend::cgal_kd_tree, KnnBackend::grid}) {
+      const char* name = backend == KnnBackend::grid ? "grid" : "CGAL kd-tree";
+      BENCHMARK(fmt::format("{} points, {}, three searches", n, name)) {
+        std::size_t size = 0;
+        for (std::size_t k : {normal_k, plane_k, plane_k}) {
+          size += roofer::reconstruction::compute_knn_graph(roof, k, backend)
+                      .indices.size();
+        }
+        return size;
+      };
+      BENCHMARK(fmt::format("{} points, {}, one shared graph", n, name)) {
+        return roofer::reconstruction::compute_knn_graph(roof, plane_k,
+                                                         backend);
+      };
+    }
+  }
+}
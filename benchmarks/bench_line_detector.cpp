@@ -0,0 +1,96 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+// Line detection on the boundary ring of a single roof plane, with the
+// default min-point-count-range of 5 to 10: one detect() per count as before,
+// and one detect() over the whole range. The noisy ring mostly gives no lines
+// at all, which is where the stepped detection repeats all region growing.
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/LineDetectorBase.hpp>
+
+namespace {
+  using roofer::linedect::LineDetector;
+  using roofer::linedect::Point;
+
+  // a 20x12m rectangle with `noise` metres of gaussian noise on the points
+  std::vector<Point> rectangle_ring(std::size_t n, double noise) {
+    std::mt19937 gen(1);
+    std::normal_distribution<double> d(0, noise);
+    std::vector<Point> points;
+    const double perimeter = 64;
+    for (std::size_t i = 0; i < n; ++i) {
+      const double s = perimeter * double(i) / double(n);
+      double x = 0, y = 0;
+      if (s < 20) {
+        x = s;
+      } else if (s < 32) {
+        x = 20, y = s - 20;
+      } else if (s < 52) {
+        x = 52 - s, y = 12;
+      } else {
+        y = 64 - s;
+      }
+      points.emplace_back(x + d(gen), y + d(gen), 5);
+    }
+    return points;
+  }
+
+  std::vector<std::vector<std::size_t>> ring_neighbours(std::size_t n) {
+    std::vector<std::vector<std::size_t>> neighbours(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t k = n - 2; k <= n + 2; ++k) {
+        neighbours[i].push_back((i + k) % n);
+      }
+    }
+    return neighbours;
+  }
+}  // namespace
+
+TEST_CASE("line detection per ring size", "[benchmark]") {
+  for (std::size_t n : {100, 1000, 10000}) {
+    for (double noise : {0.02, 0.5}) {
+      auto points = rectangle_ring(n, noise);
+      const auto neighbours = ring_neighbours(n);
+      BENCHMARK(fmt::format("{} points, {}m noise, per count", n, noise)) {
+        LineDetector detector(points, neighbours);
+        for (std::size_t count = 10; count >= 5; --count) {
+          detector.min_segment_count = count;
+          detector.detect();
+        }
+        return detector.segment_shapes.size();
+      };
+      BENCHMARK(fmt::format("{} points, {}m noise, count range", n, noise)) {
+        LineDetector detector(points, neighbours);
+        detector.detect(10, 5);
+        return detector.segment_shapes.size();
+      };
+    }
+  }
+}
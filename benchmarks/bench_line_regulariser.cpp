@@ -0,0 +1,111 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+// Angle and distance clustering of the line regulariser on synthetic line
+// sets of increasing size, spread over a building footprint that grows with
+// the line count so that the line density stays constant. Short lines in
+// eight directions, and building-scale lines of 10 to 50m along the
+// diagonals, which span many buckets of a grid over the footprint.
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <random>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/LineRegulariserBase.hpp>
+
+namespace {
+  roofer::SegmentCollection random_segments(std::size_t n) {
+    std::mt19937 gen(1);
+    const float extent = 10.F * std::sqrt(float(n));
+    std::uniform_real_distribution<float> pos(0.F, extent), len(1.F, 10.F);
+    std::normal_distribution<float> noise(0.F, 0.05F);
+    std::uniform_int_distribution<int> direction(0, 7);
+    roofer::SegmentCollection segments;
+    for (std::size_t i = 0; i < n; ++i) {
+      const float angle =
+          float(direction(gen)) * std::numbers::pi_v<float> / 8 + noise(gen);
+      const float x = pos(gen), y = pos(gen), l = len(gen);
+      segments.push_back({roofer::arr3f{x, y, 0},
+                          roofer::arr3f{x + l * std::cos(angle),
+                                        y + l * std::sin(angle), 0}});
+    }
+    return segments;
+  }
+
+  // groups of three nearly collinear lines, as the edges of the roof planes
+  // of a building that line up
+  roofer::SegmentCollection diagonal_segments(std::size_t n) {
+    std::mt19937 gen(1);
+    const float extent = 10.F * std::sqrt(float(n));
+    std::uniform_real_distribution<float> pos(0.F, extent), len(10.F, 50.F),
+        shift(-10.F, 10.F);
+    std::normal_distribution<float> noise(0.F, 0.02F), offset(0.F, 0.5F);
+    std::uniform_int_distribution<int> direction(0, 1);
+    roofer::SegmentCollection segments;
+    float x = 0, y = 0, angle = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (i % 3 == 0) {
+        x = pos(gen);
+        y = pos(gen);
+        angle = float(2 * direction(gen) + 1) * std::numbers::pi_v<float> / 4;
+      }
+      const float a = angle + noise(gen), l = len(gen), s = shift(gen),
+                  o = offset(gen);
+      const float x0 = x + s * std::cos(angle) - o * std::sin(angle);
+      const float y0 = y + s * std::sin(angle) + o * std::cos(angle);
+      segments.push_back({roofer::arr3f{x0, y0, 0},
+                          roofer::arr3f{x0 + l * std::cos(a),
+                                        y0 + l * std::sin(a), 0}});
+    }
+    return segments;
+  }
+
+  std::size_t regularise(const roofer::SegmentCollection& segments) {
+    roofer::linereg::LineRegulariser LR;
+    LR.add_segments(0, segments);
+    LR.angle_threshold = 8.594367 * std::numbers::pi / 180.0;
+    LR.dist_threshold = 0.8 * 0.8;
+    LR.perform_angle_clustering();
+    LR.perform_distance_clustering();
+    return LR.dist_clusters.size();
+  }
+}  // namespace
+
+TEST_CASE("line regularisation per line count", "[benchmark]") {
+  for (std::size_t n : {100, 1000, 10000}) {
+    const auto segments = random_segments(n);
+    BENCHMARK(fmt::format("{} lines", n)) { return regularise(segments); };
+  }
+}
+
+TEST_CASE("line regularisation of building-scale diagonal lines",
+          "[benchmark]") {
+  for (std::size_t n : {100, 1000, 10000}) {
+    const auto segments = diagonal_segments(n);
+    BENCHMARK(fmt::format("{} diagonal lines", n)) {
+      return regularise(segments);
+    };
+  }
+}
@@ -0,0 +1,85 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+// Normal estimation and seed ranking of plane detection: one sweep of the
+// batched closed-form kernel, against the two sweeps of CGAL least squares
+// fitting that it replaces.
+#include <CGAL/linear_least_squares_fitting_3.h>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/KnnGraph.hpp>
+#include <roofer/reconstruction/NeighbourhoodPca.hpp>
+#include <roofer/reconstruction/cgal_shared_definitions.hpp>
+
+#include "synthetic_roofs.hpp"
+
+namespace {
+  double cgal_fit(const roofer::PointCollection& points,
+                  std::span<const std::size_t> neighbours, Plane& plane) {
+    std::vector<Point> neighbour_points;
+    neighbour_points.reserve(neighbours.size());
+    for (auto j : neighbours) {
+      neighbour_points.emplace_back(points[j][0], points[j][1], points[j][2]);
+    }
+    return CGAL::linear_least_squares_fitting_3(
+        neighbour_points.begin(), neighbour_points.end(), plane,
+        CGAL::Dimension_tag<0>());
+  }
+}  // namespace
+
+TEST_CASE("neighbourhood plane fitting", "[benchmark]") {
+  constexpr std::size_t normal_k = 5, seed_k = 15;
+
+  for (std::size_t n : {10000, 100000, 1000000}) {
+    const auto roof = roofer::bench::synthetic_roof_with_density(n, 20.F);
+    const auto graph =
+        roofer::reconstruction::compute_knn_graph(roof, seed_k + 1);
+
+    BENCHMARK(fmt::format("{} points, CGAL least squares", n)) {
+      std::vector<Vector> normals(roof.size());
+      std::vector<double> scores(roof.size());
+      Plane plane;
+      for (std::size_t i = 0; i < roof.size(); ++i) {
+        cgal_fit(roof, graph.neighbours(i, normal_k), plane);
+        normals[i] = plane.orthogonal_vector();
+      }
+      for (std::size_t i = 0; i < roof.size(); ++i) {
+        scores[i] =
+            cgal_fit(roof, graph.neighbours(i, seed_k + 1).subspan(1), plane);
+      }
+      return scores.back();
+    };
+    BENCHMARK(fmt::format("{} points, closed-form kernel", n)) {
+      roofer::vec3f normals;
+      roofer::vec1f scores;
+      roofer::reconstruction::fit_neighbourhood_planes(roof, graph, normal_k,
+                                                       seed_k, normals, scores);
+      return scores.back();
+    };
+  }
+}
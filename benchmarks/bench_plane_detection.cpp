@@ -0,0 +1,43 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+// Plane detection of a single building on synthetic roofs of increasing
+// size, at a constant point density.
+#include <cstddef>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/PlaneDetector.hpp>
+
+#include "synthetic_roofs.hpp"
+
+TEST_CASE("plane detection per building size", "[benchmark]") {
+  for (std::size_t n : {10000, 100000, 1000000}) {
+    const auto roof = roofer::bench::synthetic_roof_with_density(n, 20.F);
+    BENCHMARK(fmt::format("{} points", n)) {
+      auto detector = roofer::reconstruction::createPlaneDetector();
+      detector->detect(roof);
+      return detector->plane_id.size();
+    };
+  }
+}
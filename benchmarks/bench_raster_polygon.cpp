@@ -0,0 +1,67 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+
+// Scan line fill of star shaped polygons with 10, 100 and 1000 vertices on a
+// 20 by 20 m raster at the default cell size of 5 cm.
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <numbers>
+#include <random>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/common/Raster.hpp>
+#include <roofer/common/common.hpp>
+
+TEST_CASE("polygon fill per vertex count", "[benchmark]") {
+  roofer::RasterTools::BasicRaster<int32_t> raster(0.05, 0, 20, 0, 20);
+  raster.prefill_arrays(roofer::RasterTools::ZERO);
+
+  for (size_t vertex_count : {10, 100, 1000}) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> radius(6, 9.5);
+    roofer::vec2f polygon;
+    for (size_t i = 0; i < vertex_count; ++i) {
+      const double angle =
+          2 * std::numbers::pi * double(i) / double(vertex_count);
+      const double r = radius(gen);
+      polygon.push_back({float(10 + r * std::cos(angle)),
+                         float(10 + r * std::sin(angle))});
+    }
+
+    BENCHMARK(fmt::format("{} vertices", vertex_count)) {
+      size_t cell_count = 0;
+      raster.scan_ring(polygon,
+                       [&](size_t row, size_t col_begin, size_t col_end) {
+                         auto cells = raster.row(row);
+                         std::fill(cells.begin() + col_begin,
+                                   cells.begin() + col_end, 1);
+                         cell_count += col_end - col_begin;
+                       });
+      return cell_count;
+    };
+  }
+}
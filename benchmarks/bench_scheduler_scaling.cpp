@@ -0,0 +1,72 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+// Strong scaling of the application scheduler: a fixed batch of buildings is
+// plane-detected with an increasing number of jobs. With RF_USE_TBB the
+// normal estimation inside each building runs in parallel on the same
+// scheduler, so the total thread count must not exceed the job budget.
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/PlaneDetector.hpp>
+
+#include "scheduler.hpp"
+#include "synthetic_roofs.hpp"
+
+TEST_CASE("plane detection throughput per job count", "[benchmark]") {
+  constexpr std::size_t building_count = 64;
+  constexpr std::size_t points_per_building = 5000;
+
+  std::vector<roofer::PointCollection> roofs;
+  roofs.reserve(building_count);
+  for (std::size_t i = 0; i < building_count; ++i) {
+    roofs.push_back(roofer::bench::synthetic_roof(points_per_building,
+                                                  static_cast<unsigned>(i)));
+  }
+
+  const std::size_t max_jobs =
+      std::max(1U, std::thread::hardware_concurrency());
+  std::vector<std::size_t> job_counts;
+  for (std::size_t jobs = 1; jobs < max_jobs; jobs *= 2)
+    job_counts.push_back(jobs);
+  job_counts.push_back(max_jobs);
+
+  for (auto jobs : job_counts) {
+    for (bool pin : {false, true}) {
+      BENCHMARK(fmt::format("{} buildings, {} jobs{}", building_count, jobs,
+                            pin ? ", pinned" : "")) {
+        TaskScheduler scheduler(jobs, pin);
+        for (auto& roof : roofs) {
+          scheduler.detach_task([&roof] {
+            auto detector = roofer::reconstruction::createPlaneDetector();
+            detector->detect(roof);
+          });
+        }
+        scheduler.wait();
+      };
+    }
+  }
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+// Plane detection of a tile of buildings with and without a scratch arena per
+// building. The benchmark times give the allocator overhead, and the growth
+// of the resident set size after a number of tiles shows how much the heap
+// fragments. Run the two modes in separate processes (eg. with a test name
+// filter) for a clean RSS comparison, because freed memory is not always
+// returned to the OS.
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/common/memory_resource.hpp>
+#include <roofer/reconstruction/PlaneDetector.hpp>
+
+#include "allocators.hpp"
+#include "synthetic_roofs.hpp"
+
+namespace {
+  // Buildings of very different sizes, as they occur in a tile
+  std::vector<roofer::PointCollection> synthetic_tile() {
+    std::vector<roofer::PointCollection> roofs;
+    for (unsigned i = 0; i < 48; ++i) {
+      const std::size_t n = 1000 + (i * 7919) % 40000;
+      roofs.push_back(roofer::bench::synthetic_roof_with_density(n, 20.F, i));
+    }
+    return roofs;
+  }
+
+  void detect_tile(const std::vector<roofer::PointCollection>& roofs,
+                   bool use_arena) {
+    for (const auto& roof : roofs) {
+      std::optional<roofer::ScratchArena> arena;
+      if (use_arena) arena.emplace();
+      auto detector = roofer::reconstruction::createPlaneDetector();
+      detector->detect(roof);
+    }
+  }
+
+  void report_rss_growth(const std::vector<roofer::PointCollection>& roofs,
+                         bool use_arena) {
+    constexpr int tiles = 20;
+    detect_tile(roofs, use_arena);
+    const auto rss_before = GetCurrentRSS();
+    for (int i = 0; i < tiles; ++i) detect_tile(roofs, use_arena);
+    const auto rss_after = GetCurrentRSS();
+    fmt::print("{}: RSS {:.1f} MiB -> {:.1f} MiB after {} tiles\n",
+               use_arena ? "scratch arena" : "default heap",
+               rss_before / 1048576.0, rss_after / 1048576.0, tiles);
+  }
+}  // namespace
+
+TEST_CASE("plane detection with the default heap", "[benchmark]") {
+  const auto roofs = synthetic_tile();
+  BENCHMARK("tile, default heap") { detect_tile(roofs, false); };
+  report_rss_growth(roofs, false);
+}
+
+TEST_CASE("plane detection with a scratch arena", "[benchmark]") {
+  const auto roofs = synthetic_tile();
+  BENCHMARK("tile, scratch arena") { detect_tile(roofs, true); };
+  report_rss_growth(roofs, true);
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+
+// Segment rasterisation of the alpha triangles of a synthetic roof at several
+// megapixel limits, which double the cell size until the raster fits, with
+// and without filling the cells without data.
+#include <cstddef>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fmt/format.h>
+
+#include <roofer/reconstruction/AlphaShaper.hpp>
+#include <roofer/reconstruction/PlaneDetector.hpp>
+#include <roofer/reconstruction/SegmentRasteriser.hpp>
+
+#include "synthetic_roofs.hpp"
+
+TEST_CASE("segment rasterisation per megapixel limit", "[benchmark]") {
+  // about 5000 m2, or 2 megapixels at the default cell size of 5 cm
+  const auto roof = roofer::bench::synthetic_roof_with_density(100000, 20.F);
+  auto detector = roofer::reconstruction::createPlaneDetector();
+  detector->detect(roof);
+  auto shaper = roofer::reconstruction::createAlphaShaper();
+  shaper->compute(detector->pts_per_roofplane);
+  auto& triangles = shaper->alpha_triangles;
+
+  for (int megapixel_limit : {1, 2, 4, 8}) {
+    for (bool fill_nodata : {false, true}) {
+      roofer::reconstruction::SegmentRasteriserConfig cfg;
+      cfg.megapixel_limit = megapixel_limit;
+      cfg.fill_nodata = fill_nodata;
+      cfg.use_ground = false;
+      BENCHMARK(fmt::format("{} megapixel limit{}", megapixel_limit,
+                            fill_nodata ? ", filled" : "")) {
+        roofer::TriangleCollection no_ground;
+        auto rasteriser = roofer::reconstruction::createSegmentRasteriser();
+        rasteriser->compute(triangles, no_ground, cfg);
+        return rasteriser->heightfield.dimx_;
+      };
+    }
+  }
+}
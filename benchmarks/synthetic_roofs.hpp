@@ -0,0 +1,87 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+
+#include <roofer/common/common.hpp>
+
+namespace roofer::bench {
+
+  // Footprint of the synthetic building: a width x depth rectangle with the
+  // origin in its lower left corner.
+  inline LinearRing synthetic_footprint(float width = 20.F,
+                                        float depth = 12.F) {
+    LinearRing footprint;
+    footprint.push_back({0.F, 0.F, 0.F});
+    footprint.push_back({width, 0.F, 0.F});
+    footprint.push_back({width, depth, 0.F});
+    footprint.push_back({0.F, depth, 0.F});
+    return footprint;
+  }
+
+  // Sample `n` points on a gable roof with a flat annex over the footprint of
+  // synthetic_footprint(). The ridge runs along the x-axis, the annex covers
+  // the last quarter of the building. Gaussian noise with `noise` standard
+  // deviation is added to the elevations. The same seed gives the same points.
+  inline PointCollection synthetic_roof(std::size_t n, unsigned seed = 1,
+                                        float width = 20.F, float depth = 12.F,
+                                        float noise = 0.02F) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> ux(0.F, width);
+    std::uniform_real_distribution<float> uy(0.F, depth);
+    std::normal_distribution<float> nz(0.F, noise);
+
+    const float eave = 6.F;
+    const float ridge = 10.F;
+    const float annex_x = 0.75F * width;
+    const float annex_z = 4.F;
+
+    PointCollection points;
+    points.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      const float x = ux(gen);
+      const float y = uy(gen);
+      float z;
+      if (x > annex_x) {
+        z = annex_z;
+      } else {
+        const float d = std::abs(y - depth / 2) / (depth / 2);
+        z = ridge - d * (ridge - eave);
+      }
+      points.push_back({x, y, z + nz(gen)});
+    }
+    return points;
+  }
+
+  // Scale the building footprint with the point count, so that the point
+  // density stays at `density` points per square metre.
+  inline PointCollection synthetic_roof_with_density(std::size_t n,
+                                                     float density = 20.F,
+                                                     unsigned seed = 1) {
+    const float area = static_cast<float>(n) / density;
+    const float depth = std::sqrt(area / 1.6F);
+    return synthetic_roof(n, seed, 1.6F * depth, depth);
+  }
+
+}  // namespace roofer::bench
@@ -25,9 +25,14 @@
 #include <array>
 #include <cfloat>
 #include <cmath>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
+#include <roofer/common/memory_resource.hpp>
+#include <span>
+#include <utility>
 #include <vector>
 
 // #include <gdal_priv.h>
@@ -37,16 +42,19 @@
 namespace roofer {
   namespace RasterTools {
     enum alg { MIN, MAX, ZERO };
-    class Raster {
+    /**
+     * Regular grid of cells with a value of type T, stored row by row. Row 0
+     * is at miny_ and column 0 at minx_.
+     */
+    template <typename T>
+    class BasicRaster {
      public:
+      typedef T value_type;
       typedef std::array<float, 3> point3d;
       typedef std::array<float, 2> point2d;
-      Raster(double cellsize, double min_x, double max_x, double min_y,
-             double max_y);
-      Raster(const Raster &);
-      void operator=(const Raster &r);
-      Raster(){};
-      ~Raster(){};
+      BasicRaster(double cellsize, double min_x, double max_x, double min_y,
+                  double max_y);
+      BasicRaster(){};
       /**
        * Prefills the raster array based on the specified method.
        * @param[in] a The method to be used for prefilling the raster arrays:
@@ -105,107 +113,143 @@ namespace roofer {
       bool isNoData(size_t col, size_t row);
       bool isNoData(double &x, double &y);
       void set_nodata(double new_nodata_val);
+      // fill each nodata cell with the minimum of the cells in the window
+      // [-window_size, window_size) around it. Sets nodata to the largest
+      // value of T.
       void fill_nn(size_t window_size);
       // void write(const char* WKGCS, alg a, void * dataPtr, const char*
       // outFile);
 
-      // rasterise a polygon and return a list with points - one in the center
-      // of each pixel inside the polygon in the polygon first point is *not*
-      // repeated as last T should be a vector of arr<float,2> or arr<float,3>
-      template <typename T>
-      std::vector<point3d> rasterise_polygon(T &polygon,
-                                             std::array<double, 2> cr_min,
-                                             std::array<double, 2> cr_max,
-                                             bool returnNoData = true) const {
-        // code adapted from http://alienryderflex.com/polygon_fill/
-        int n_nodes, pixelX, pixelY, i, j, swap;
-        int n_vertices = polygon.size();
-        std::vector<point3d> result;
-
-        // perhaps we can specialise these to the bounding box of the polygon
-        int IMAGE_TOP = std::max(0, (int)std::floor(cr_min[1])),
-            IMAGE_BOT = std::min((int)dimy_, (int)std::ceil(cr_max[1])),
-            IMAGE_LEFT = std::max(0, (int)std::ceil(cr_min[0])),
-            IMAGE_RIGHT = std::min((int)dimx_, (int)std::floor(cr_max[0]));
-
-        // Loop through the rows of the image.
-        for (pixelY = IMAGE_TOP; pixelY < IMAGE_BOT; pixelY++) {
-          std::vector<int>
-              intersect_x;  // vector to hold the x-coordinates where the
-                            // scanline intersects the polygon
+      /**
+       * Gets the cells of a row.
+       * @param[in] row the row, in [0, dimy_)
+       * @return The dimx_ cells of the row, in column order.
+       */
+      std::span<T> row(size_t row) {
+        return {vals_.data() + row * dimx_, dimx_};
+      }
+      std::span<const T> row(size_t row) const {
+        return {vals_.data() + row * dimx_, dimx_};
+      }
 
-          // Build a list of nodes.
-          n_nodes = 0;
-          j = n_vertices - 1;
-          for (i = 0; i < n_vertices; i++) {
-            auto pi =
-                getColRowCoord((double)polygon[i][0], (double)polygon[i][1]);
-            auto pj =
-                getColRowCoord((double)polygon[j][0], (double)polygon[j][1]);
-            // std::cerr << pi[0] << " " << pi[1] << "\n";
-            // std::cerr << pj[0] << " " << pj[1] << "\n";
-            if ((pi[1] < (double)pixelY && pj[1] >= (double)pixelY) ||
-                (pj[1] < (double)pixelY && pi[1] >= (double)pixelY)) {
-              intersect_x.push_back(
-                  (int)(pi[0] +
-                        (pixelY - pi[1]) / (pj[1] - pi[1]) * (pj[0] - pi[0])));
-              ++n_nodes;
+      /**
+       * Visits the cells inside a polygon, one run of cells of a row at a
+       * time. A cell is inside if its centre is inside by the even-odd rule
+       * over all rings. Edges are evaluated from their lowest end point, so
+       * that polygons that share an edge split the cells along it. The ring
+       * crossings are kept in the scratch_resource().
+       *
+       * @param[in] rings Rings of the polygon. Each ring is a range of points
+       * with x and y as their first two elements, the first point of a ring
+       * is not repeated.
+       * @param[in] visit Called as visit(row, col_begin, col_end) for each run
+       * [col_begin, col_end) of inside cells, in row order.
+       */
+      template <typename Rings, typename Visitor>
+      void scan_rings(const Rings &rings, Visitor &&visit) const {
+        // (row, column in cell units) of the crossings of the rings with the
+        // horizontal lines through the row centres
+        std::pmr::vector<std::pair<size_t, double>> crossings(
+            scratch_resource());
+        for (const auto &ring : rings) {
+          const size_t n = ring.size();
+          for (size_t i = 0, j = n - 1; i < n; j = i++) {
+            std::array<double, 2> lo = {
+                (double(ring[j][0]) - minx_) / cellSize_,
+                (double(ring[j][1]) - miny_) / cellSize_};
+            std::array<double, 2> hi = {
+                (double(ring[i][0]) - minx_) / cellSize_,
+                (double(ring[i][1]) - miny_) / cellSize_};
+            if (hi[1] < lo[1] || (hi[1] == lo[1] && hi[0] < lo[0])) {
+              std::swap(lo, hi);
             }
-            j = i;
-          }
-
-          // Sort the nodes, via a simple “Bubble” sort.
-          i = 0;
-          while (i < n_nodes - 1) {
-            if (intersect_x[i] > intersect_x[i + 1]) {
-              swap = intersect_x[i];
-              intersect_x[i] = intersect_x[i + 1];
-              intersect_x[i + 1] = swap;
-              if (i) i--;
-            } else {
-              i++;
+            if (!(lo[1] < hi[1])) continue;
+            // rows whose centre row + 0.5 is in [lo.y, hi.y)
+            const double first = std::max(0.0, std::ceil(lo[1] - 0.5));
+            const double last =
+                std::min(double(dimy_), std::ceil(hi[1] - 0.5));
+            const double slope = (hi[0] - lo[0]) / (hi[1] - lo[1]);
+            for (double r = first; r < last; ++r) {
+              crossings.emplace_back(size_t(r),
+                                     lo[0] + (r + 0.5 - lo[1]) * slope);
             }
           }
+        }
+        std::sort(crossings.begin(), crossings.end());
 
-          // Fill the pixels between node pairs.
-          for (i = 0; i < n_nodes; i += 2) {
-            if (intersect_x[i] >= IMAGE_RIGHT) break;
-            if (intersect_x[i + 1] > IMAGE_LEFT) {
-              if (intersect_x[i] < IMAGE_LEFT) intersect_x[i] = IMAGE_LEFT;
-              if (intersect_x[i + 1] > IMAGE_RIGHT)
-                intersect_x[i + 1] = IMAGE_RIGHT;
-              for (pixelX = intersect_x[i]; pixelX <= intersect_x[i + 1];
-                   pixelX++) {
-                auto p = getPointFromRasterCoords(pixelX, pixelY);
-                if (p[2] == noDataVal_) {
-                  if (returnNoData) {
-                    result.push_back(p);
-                  }
-                } else {
-                  result.push_back(p);
-                }
-              }
+        // the cells whose centre col + 0.5 is in [x_a, x_b) between each
+        // pair of crossings
+        for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+          const auto [r, x_a] = crossings[i];
+          const double x_b = crossings[i + 1].second;
+          const double first = std::max(0.0, std::ceil(x_a - 0.5));
+          const double last = std::min(double(dimx_), std::ceil(x_b - 0.5));
+          if (first < last) visit(r, size_t(first), size_t(last));
+        }
+      }
+      /**
+       * Visits the cells inside a polygon without holes, like scan_rings().
+       * @param[in] ring The points of the polygon, the first point is not
+       * repeated.
+       * @param[in] visit Called as visit(row, col_begin, col_end)
+       */
+      template <typename Ring, typename Visitor>
+      void scan_ring(const Ring &ring, Visitor &&visit) const {
+        scan_rings(std::span<const Ring>(&ring, 1), visit);
+      }
+      /**
+       * Visits the cells of a polygon without holes by the scan line rule of
+       * the former rasterise_polygon(). The crossings of the ring with the
+       * bottom edge of a row are truncated to a column, and a run includes
+       * the cells of both crossings. Polygons that share an edge therefore
+       * both get the cells along it, and the cells differ from scan_ring().
+       * Kept to reproduce the per-face data term of the arrangement
+       * optimiser.
+       *
+       * @param[in] ring The points of the polygon, the first point is not
+       * repeated.
+       * @param[in] visit Called as visit(row, col_begin, col_end) for each run
+       * [col_begin, col_end) of cells, in row order.
+       */
+      template <typename Ring, typename Visitor>
+      void scan_ring_row_edges(const Ring &ring, Visitor &&visit) const {
+        const size_t n = ring.size();
+        if (n == 0) return;
+        std::pmr::vector<std::array<double, 2>> pts(scratch_resource());
+        double min_y = DBL_MAX, max_y = -DBL_MAX;
+        for (const auto &p : ring) {
+          pts.push_back(getColRowCoord(double(p[0]), double(p[1])));
+          min_y = std::min(min_y, pts.back()[1]);
+          max_y = std::max(max_y, pts.back()[1]);
+        }
+        // the rows whose bottom edge y can cross the ring, min_y < y <= max_y
+        const double first = std::max(0.0, std::floor(min_y));
+        const double last = std::min(double(dimy_), std::floor(max_y) + 1);
+        const int right = int(dimx_);
+        std::pmr::vector<int> crossings(scratch_resource());
+        for (double y = first; y < last; ++y) {
+          crossings.clear();
+          for (size_t i = 0, j = n - 1; i < n; j = i++) {
+            const auto &pi = pts[i], &pj = pts[j];
+            if ((pi[1] < y && pj[1] >= y) || (pj[1] < y && pi[1] >= y)) {
+              crossings.push_back(
+                  int(pi[0] + (y - pi[1]) / (pj[1] - pi[1]) * (pj[0] - pi[0])));
             }
           }
+          std::sort(crossings.begin(), crossings.end());
+          for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+            if (crossings[i] >= right) break;
+            if (crossings[i + 1] <= 0) continue;
+            visit(size_t(y), size_t(std::max(crossings[i], 0)),
+                  size_t(std::min(crossings[i + 1] + 1, right)));
+          }
         }
-
-        return result;
-      };
-      template <typename T>
-      std::vector<point3d> rasterise_polygon(T &polygon,
-                                             bool returnNoData = true) const {
-        return rasterise_polygon(polygon, {0, 0},
-                                 {double(dimx_), double(dimy_)}, returnNoData);
-      };
-      // template<> std::vector<point3d> rasterise_polygon(std::vector<point2d>&
-      // polygon) const; template<> std::vector<point3d>
-      // rasterise_polygon(std::vector<point3d>& polygon) const;
+      }
 
       double cellSize_, minx_, miny_, maxx_, maxy_;
       size_t dimx_, dimy_;
       double noDataVal_;
-      // std::unique_ptr<std::vector<int16_t>> counts_;
-      std::unique_ptr<std::vector<float>> vals_;
+      std::vector<T> vals_;
 
      private:
       void avg(double &x, double &y, double &val);
@@ -222,5 +266,7 @@ namespace roofer {
       // void cnt(double &x, double &y);
       // OGRSpatialReference oSRS;
     };
+    // The heightfields and other rasters of measured values
+    typedef BasicRaster<float> Raster;
   }  // namespace RasterTools
 }  // namespace roofer
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <unordered_map>
@@ -252,6 +253,21 @@ namespace roofer {
     float* get_data_ptr();
   };
 
+  // IndexedTriangleCollection stores triangles as index triples into one
+  // vertex array, so that a vertex that is shared by several triangles is
+  // stored only once.
+  class IndexedTriangleCollection : public Geometry {
+   public:
+    vec3f vertices;
+    std::vector<std::array<uint32_t, 3>> triangles;
+
+    size_t size() const;
+    bool empty() const;
+    size_t vertex_count() const;
+    virtual void compute_box();
+    float* get_data_ptr();
+  };
+
   // MultiTriangleCollection stores a collection of TriangleCollections along
   // with attributes for each TriangleCollection. The vector of
   // TriangleCollections `trianglecollections_` and the vector of AttributeMaps
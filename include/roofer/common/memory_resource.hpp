@@ -0,0 +1,64 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace roofer {
+
+  /**
+   * @brief Memory resource for the short-lived temporaries of a reconstruction
+   * stage, eg. the scratch vectors of plane and line fitting.
+   *
+   * Outside of a ScratchArena this is the default memory resource. Containers
+   * that use it must be created, grown and destroyed on one thread, and must
+   * not outlive the function that created them.
+   */
+  std::pmr::memory_resource* scratch_resource();
+
+  /**
+   * @brief Installs an arena as the scratch_resource() of the calling thread
+   * for the lifetime of this object.
+   *
+   * Memory that is freed inside the arena is reused by later allocations of
+   * the same size, and everything is handed back at once when the arena is
+   * destroyed. This avoids fragmenting the heap with the many small
+   * allocations of a building. The initial buffer of an arena is kept per
+   * thread and reused by the next arena, so a small building does not touch
+   * the heap at all. Arenas can be nested, eg. when a thread that waits for a
+   * parallel loop picks up another building.
+   */
+  class ScratchArena {
+   public:
+    ScratchArena();
+    ~ScratchArena();
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    // Size of the initial buffer of each arena, in bytes
+    static constexpr std::size_t initial_size = std::size_t(4) << 20;
+
+   private:
+    std::pmr::memory_resource* previous_;
+  };
+
+}  // namespace roofer
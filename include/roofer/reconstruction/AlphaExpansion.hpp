@@ -0,0 +1,100 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace roofer::reconstruction {
+
+  /**
+   * @brief Alpha-expansion graph-cut with a Potts smoothness term.
+   *
+   * Minimises sum_p D(p, l_p) + sum_(p,q) w_pq [l_p != l_q] over the labels
+   * l_p. The graph is kept as a flat compressed sparse row adjacency, and
+   * each expansion move is a max-flow (Dinic) on it. All buffers are
+   * members, so that a solver that is reused for many graphs, eg. one per
+   * worker thread, stops allocating once it has seen the largest graph.
+   */
+  class AlphaExpansion {
+   public:
+    /**
+     * @brief Runs expansion moves until none of them lowers the energy.
+     *
+     * @param node_count  Number of nodes
+     * @param label_count Number of labels
+     * @param costs       Data term, node_count rows of label_count columns
+     * @param edges       Node pairs of the smoothness term. An edge that is
+     *                    listed twice counts twice.
+     * @param weights     Weight of each edge
+     * @param[in,out] labels Initial labels, replaced by the result
+     * @return Energy of the result
+     */
+    double solve(size_t node_count, size_t label_count,
+                 const std::vector<double>& costs,
+                 const std::vector<std::array<uint32_t, 2>>& edges,
+                 const std::vector<double>& weights,
+                 std::vector<size_t>& labels);
+
+    /**
+     * @brief Energy of a labelling.
+     */
+    static double energy(size_t label_count, const std::vector<double>& costs,
+                         const std::vector<std::array<uint32_t, 2>>& edges,
+                         const std::vector<double>& weights,
+                         const std::vector<size_t>& labels);
+
+   private:
+    // CSR adjacency of the nodes followed by the source and the sink. Every
+    // arc is stored together with its reverse arc.
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> arc_head_;
+    std::vector<uint32_t> arc_reverse_;
+    std::vector<double> arc_capacity_;
+    // arc of each edge from its first to its second node, and the arcs
+    // between each node and the source and sink
+    std::vector<uint32_t> edge_arc_;
+    std::vector<uint32_t> source_arc_;
+    std::vector<uint32_t> sink_arc_;
+    // max-flow state
+    std::vector<int32_t> level_;
+    std::vector<uint32_t> next_arc_;
+    std::vector<uint32_t> queue_;
+    std::vector<uint32_t> path_;
+    // expansion move state
+    std::vector<double> expand_cost_;
+    std::vector<size_t> proposal_;
+
+    void build(size_t node_count,
+               const std::vector<std::array<uint32_t, 2>>& edges);
+    bool expand(size_t alpha, size_t label_count,
+                const std::vector<double>& costs,
+                const std::vector<std::array<uint32_t, 2>>& edges,
+                const std::vector<double>& weights,
+                const std::vector<size_t>& labels);
+    double max_flow(uint32_t source, uint32_t sink, double epsilon);
+  };
+
+}  // namespace roofer::reconstruction
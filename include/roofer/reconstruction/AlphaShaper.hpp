@@ -37,7 +37,14 @@ namespace roofer::reconstruction {
     config::no_validation<bool>(), public_)                                    \
   X(bool, clamp_optimal_alpha, true,                                           \
     "Clamp the optimal alpha to at least the configured alpha value.",         \
-    config::no_validation<bool>(), public_)
+    config::no_validation<bool>(), public_)                                    \
+  X(bool, shared_triangulation, false,                                         \
+    "Compute the alpha shapes of all planes on one shared triangulation.",     \
+    config::no_validation<bool>(), public_)                                    \
+  X(int, parallel_plane_points, 20000,                                         \
+    "Minimum point count of a plane to extract its alpha shape in parallel "   \
+    "with the other planes, with a shared triangulation.",                     \
+    config::greater_than(0), public_)
   struct AlphaShaperConfig {
     using Self = AlphaShaperConfig;
     ROOFER_CONFIG_MEMBERS(ROOFER_ALPHA_SHAPER_FIELDS)
@@ -47,6 +54,9 @@ namespace roofer::reconstruction {
   struct AlphaShaperInterface {
     std::vector<LinearRing> alpha_rings;
     TriangleCollection alpha_triangles;
+    // the interior triangles of all alpha shapes when shared_triangulation is
+    // enabled, alpha_triangles is left empty in that case
+    IndexedTriangleCollection alpha_triangle_mesh;
     vec1i roofplane_ids;
 
     // add_output("edge_points", typeid(PointCollection));
@@ -224,6 +224,8 @@ namespace roofer::reconstruction {
   void arr_filter_biggest_face(Arrangement_2& arr, const float& rel_area_thres);
 
   void arrangementface_to_polygon(Face_handle face, vec2f& polygons);
+  // the outer ring of a face followed by its holes
+  void arrangementface_to_rings(Face_handle face, std::vector<vec2f>& rings);
   bool arrangementface_to_polygon(Face_handle face,
                                   roofer::LinearRing& polygons, double h = 0);
 
@@ -238,5 +240,8 @@ namespace roofer::reconstruction {
   void arr_dissolve_fp(Arrangement_2& arr, bool inside, bool outside);
   void arr_snap_duplicates(Arrangement_2& arr, double dupe_threshold);
   void arr_label_buildingparts(Arrangement_2& arr);
+  // Release the graph-cut data of the ArrangementOptimiser from all faces, so
+  // that copies of the arrangement do not carry it along.
+  void arr_clear_optimiser_data(Arrangement_2& arr);
 
 }  // namespace roofer::reconstruction
@@ -36,7 +36,18 @@ namespace roofer::reconstruction {
   X(bool, insert_with_snap, false, "Snap while inserting arrangement edges.", \
     config::no_validation<bool>(), internal)                                  \
   X(bool, insert_lines, true, "Insert detected lines.",                       \
-    config::no_validation<bool>(), internal)
+    config::no_validation<bool>(), internal)                                  \
+  X(bool, incremental_insert, true,                                           \
+    "Insert the footprint edges and lines one at a time, instead of in one "  \
+    "sweep of the lines clipped to the footprint bounds.",                    \
+    config::no_validation<bool>(), internal)                                  \
+  X(bool, snap_rounding, false,                                               \
+    "Snap round the footprint edges and lines to a grid before inserting "    \
+    "them, so that the arrangement has no constructed intersection points.",  \
+    config::no_validation<bool>(), internal)                                  \
+  X(float, snap_rounding_pixel_size, 0.001F,                                  \
+    "Pixel size of the snap rounding grid, in metres.",                       \
+    config::greater_than(0.0F), internal)
   struct ArrangementBuilderConfig {
     using Self = ArrangementBuilderConfig;
     ROOFER_CONFIG_MEMBERS(ROOFER_ARRANGEMENT_BUILDER_FIELDS)
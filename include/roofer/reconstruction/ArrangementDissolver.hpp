@@ -42,7 +42,15 @@ namespace roofer::reconstruction {
     config::no_validation<bool>(), internal)                                  \
   X(float, step_height_threshold, 3.0F,                                       \
     "Step-height threshold in metres (LoD-derived).",                         \
-    config::greater_than(0.0F), internal)
+    config::greater_than(0.0F), internal)                                     \
+  X(bool, clip_to_terrain, true,                                              \
+    "Clip roof faces to the terrain. Can be disabled when the arrangement "   \
+    "was already dissolved with clipping, eg. to derive a coarser LoD.",      \
+    config::no_validation<bool>(), internal)                                  \
+  X(bool, face_label_raster, false,                                           \
+    "Take the face elevations from one raster of face labels by cell "        \
+    "centre, instead of rasterising each face.",                              \
+    config::no_validation<bool>(), internal)
   struct ArrangementDissolverConfig {
     using Self = ArrangementDissolverConfig;
     ROOFER_CONFIG_MEMBERS(ROOFER_ARRANGEMENT_DISSOLVER_FIELDS)
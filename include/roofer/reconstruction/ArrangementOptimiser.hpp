@@ -36,12 +36,23 @@ namespace roofer::reconstruction {
     config::no_validation<bool>(), internal)                              \
   X(bool, normalise, false, "Normalise graph-cut costs.",                 \
     config::no_validation<bool>(), internal)                              \
-  X(int, graph_cut_impl, 0, "Graph-cut implementation selector.",         \
-    config::at_least(0), internal)                                        \
+  X(int, graph_cut_impl, 0,                                               \
+    "Graph-cut implementation: automatic (-1), boost adjacency list "     \
+    "(0), boost compressed sparse row (1), MaxFlow (2) or in-tree (3).",  \
+    config::in_range(-1, 3), internal)                                    \
+  X(bool, warm_start, false,                                              \
+    "Start the graph-cut from the plane with the lowest data cost of "    \
+    "each face.",                                                         \
+    config::no_validation<bool>(), internal)                              \
   X(bool, label_ground_outside_footprint, true,                           \
     "Label ground outside the footprint.", config::no_validation<bool>(), \
     internal)                                                             \
   X(bool, use_ground, true, "Use ground labels (pipeline-derived).",      \
+    config::no_validation<bool>(), internal)                              \
+  X(bool, face_label_raster, false,                                       \
+    "Compute the data term from one raster of face labels, instead of "   \
+    "rasterising every face separately. Cells are assigned by their "     \
+    "centre, which changes the data term on the shared edges of faces.",  \
     config::no_validation<bool>(), internal)
   struct ArrangementOptimiserConfig {
     using Self = ArrangementOptimiserConfig;
@@ -20,7 +20,10 @@
 // Ravi Peters
 
 #pragma once
+#include <array>
+#include <chrono>
 #include <memory>
+#include <string_view>
 #include <roofer/common/datastructures.hpp>
 #include <roofer/reconstruction/ElevationProvider.hpp>
 #include <roofer/reconstruction/cgal_shared_definitions.hpp>
@@ -45,12 +48,27 @@ namespace roofer::reconstruction {
   };
 #undef ROOFER_ARRANGEMENT_SNAPPER_FIELDS
 
+  // The phases of the arrangement snapper that are timed, in the order in
+  // which they run: building the constrained triangulation, labelling its
+  // triangles with the arrangement faces, collapsing small triangles and
+  // short edges, flattening thin triangles, removing dangling constraints,
+  // repairing non-manifold vertices and transferring the labels to the
+  // snapped arrangement.
+  inline constexpr std::array<std::string_view, 7> arrangement_snapper_phases =
+      {"triangulate",     "label",  "collapse", "flatten",
+       "remove_dangling", "repair", "transfer"};
+
   struct ArrangementSnapperInterface {
     // add_output("triangles_og", typeid(TriangleCollection));
     // add_output("segment_ids_og", typeid(vec1i));
     // add_output("triangles_snapped", typeid(TriangleCollection));
     // add_output("segment_ids_snapped", typeid(vec1i));
 
+    // Time spent in each of the arrangement_snapper_phases by the last call
+    // to compute()
+    std::array<std::chrono::duration<double>, arrangement_snapper_phases.size()>
+        phase_timings{};
+
     virtual ~ArrangementSnapperInterface() = default;
     virtual void compute(
         Arrangement_2& arrangement,
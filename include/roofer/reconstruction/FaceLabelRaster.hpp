@@ -0,0 +1,77 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <roofer/common/Raster.hpp>
+#include <roofer/common/common.hpp>
+#include <vector>
+
+namespace roofer::reconstruction {
+
+  /**
+   * @brief Raster of face labels that is aligned with a heightfield.
+   *
+   * A cell is labelled with a face if its centre is inside the face, so that
+   * the faces of an arrangement partition the cells. Cells that are not in
+   * any face keep the label `no_face`, which is also the nodata value.
+   */
+  class FaceLabelRaster : public RasterTools::BasicRaster<int32_t> {
+   public:
+    static constexpr int32_t no_face = -1;
+
+    explicit FaceLabelRaster(const RasterTools::Raster& grid);
+
+    /**
+     * @brief Labels the cells of a face.
+     *
+     * @param rings Rings of the face, the outer ring followed by the holes.
+     *              The first point of a ring is not repeated.
+     * @param label Label of the face
+     */
+    void add_face(const std::vector<vec2f>& rings, int32_t label);
+  };
+
+  /**
+   * @brief Data term of the faces for a set of planes.
+   *
+   * For every face and plane the sum over the cells of the face of
+   * |z - (a x + b y + c)|, with z the heightfield value and (x, y) the cell
+   * centre. Cells without data are skipped. The raster is traversed once,
+   * and each cell adds to the sums of all planes of its face at once.
+   *
+   * @param heightfield Heightfield that `faces` is aligned with
+   * @param faces       Face labels, in [0, face_count)
+   * @param face_count  Number of faces
+   * @param planes      Planes as the coefficients (a, b, c) of
+   *                    z = a x + b y + c
+   * @param[out] costs  Sums, face_count rows of planes.size() columns
+   */
+  void face_plane_costs(const RasterTools::Raster& heightfield,
+                        const FaceLabelRaster& faces, size_t face_count,
+                        const std::vector<std::array<double, 3>>& planes,
+                        std::vector<double>& costs);
+
+}  // namespace roofer::reconstruction
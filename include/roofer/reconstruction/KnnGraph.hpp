@@ -0,0 +1,89 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <roofer/common/common.hpp>
+#include <span>
+#include <vector>
+
+namespace roofer::reconstruction {
+
+  /**
+   * @brief The k nearest neighbours of each point of a point set, in
+   * compressed sparse row layout.
+   *
+   * Each point is itself part of the point set that is searched, so the first
+   * neighbour of a point is the point itself (or a duplicate of it). The
+   * neighbours are ordered by increasing distance, so a consumer that needs
+   * fewer than k neighbours can use a prefix of the row.
+   */
+  struct KnnGraph {
+    std::size_t k = 0;
+    // row i is indices[offsets[i]] .. indices[offsets[i + 1]]
+    std::vector<std::size_t> offsets{0};
+    std::vector<std::size_t> indices;
+
+    [[nodiscard]] std::size_t size() const { return offsets.size() - 1; }
+
+    /**
+     * @brief The first `count` neighbours of point `i`, or all of them if the
+     * row is shorter.
+     */
+    [[nodiscard]] std::span<const std::size_t> neighbours(
+        std::size_t i, std::size_t count = SIZE_MAX) const {
+      const auto first = offsets[i];
+      const auto n = std::min(offsets[i + 1] - first, count);
+      return {indices.data() + first, n};
+    }
+  };
+
+  /**
+   * @brief Search structure that compute_knn_graph() uses.
+   *
+   * The grid computes distances in single precision and breaks ties by
+   * index, so it may order neighbours at (nearly) equal distance differently
+   * than the kd-tree. The kd-tree stays the default until the segmentation
+   * with the grid is shown to be the same.
+   */
+  enum class KnnBackend {
+    // float32 uniform grid, see KnnIndex
+    grid,
+    // CGAL kd-tree in double precision
+    cgal_kd_tree
+  };
+
+  /**
+   * @brief Compute the k nearest neighbours of each point with a single
+   * search structure, so that the stages that work on the same point set can
+   * share one neighbourhood structure.
+   *
+   * @param points  Point set
+   * @param k       Number of neighbours per point, including the point itself
+   * @param backend Search structure to use
+   */
+  KnnGraph compute_knn_graph(std::span<const arr3f> points, std::size_t k,
+                             KnnBackend backend = KnnBackend::cgal_kd_tree);
+
+}  // namespace roofer::reconstruction
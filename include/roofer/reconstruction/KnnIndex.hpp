@@ -0,0 +1,107 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <roofer/common/common.hpp>
+#include <roofer/reconstruction/KnnGraph.hpp>
+#include <span>
+#include <vector>
+
+namespace roofer::reconstruction {
+
+  /**
+   * @brief Exact k-nearest-neighbour search for the point set of a single
+   * building.
+   *
+   * The points are bucketed in a uniform grid over their xy extent and stored
+   * as float32 coordinates in flat arrays, sorted by the Morton code of their
+   * grid cell. Roof point clouds are 2.5D, so a 2D grid keeps the cells
+   * evenly filled. The search is still exact in 3D, because the xy distance
+   * to a cell is a lower bound of the 3D distance to its points.
+   *
+   * Coordinates and distances are stored and computed in the scalar type T.
+   * With float, points at (nearly) equal distance may be ordered differently
+   * than by a search in double precision. Exact ties are broken by point
+   * index.
+   */
+  template <typename T>
+  class BasicKnnIndex {
+   public:
+    /**
+     * @param points          Point set, must outlive the index only during
+     *                        construction
+     * @param points_per_cell Average number of points per occupied cell
+     */
+    explicit BasicKnnIndex(std::span<const arr3f> points,
+                           T points_per_cell = 4);
+
+    [[nodiscard]] std::size_t size() const { return index_.size(); }
+
+    /**
+     * @brief Find the k nearest points of `query`.
+     *
+     * @param[out] result Indices of the nearest points, sorted by distance
+     */
+    void query(const arr3f& query, std::size_t k,
+               std::vector<std::size_t>& result) const;
+
+    /**
+     * @brief The k nearest neighbours of every point of the set, the point
+     * itself included.
+     *
+     * The queries are run in the Morton order of the grid cells, so that
+     * consecutive queries visit the same cells. With `parallel` and TBB,
+     * blocks of queries are run concurrently.
+     */
+    [[nodiscard]] KnnGraph all_knn(std::size_t k, bool parallel = true) const;
+
+   private:
+    struct Candidate {
+      T d2;
+      std::uint32_t index;
+      bool operator<(const Candidate& other) const {
+        return d2 < other.d2 || (d2 == other.d2 && index < other.index);
+      }
+    };
+
+    void search(T qx, T qy, T qz, std::size_t k,
+                std::vector<Candidate>& best) const;
+
+    // coordinates and input index of the points, sorted by cell
+    std::vector<T> x_, y_, z_;
+    std::vector<std::uint32_t> index_;
+    // range of sorted points in each cell, in row-major cell order
+    std::vector<std::uint32_t> cell_begin_, cell_end_;
+    T min_x_ = 0, min_y_ = 0;
+    T cell_size_ = 1, inv_cell_size_ = 1;
+    int nx_ = 1, ny_ = 1;
+  };
+
+  extern template class BasicKnnIndex<float>;
+  extern template class BasicKnnIndex<double>;
+
+  /** @brief The index that compute_knn_graph() uses. */
+  using KnnIndex = BasicKnnIndex<float>;
+
+}  // namespace roofer::reconstruction
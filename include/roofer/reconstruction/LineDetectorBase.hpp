@@ -60,6 +60,9 @@ namespace roofer::linedect {
     // Tree tree;
     // vector<bool> point_seed_flags;
     NeighbourVec neighbours;
+    // squared distance of each point to the line fitted to its neighbourhood,
+    // which ranks the seeds and does not depend on the segmentation
+    vector<double> seed_dist;
     size_t region_counter = 1;
 
    public:
@@ -78,10 +81,16 @@ namespace roofer::linedect {
                                 float extension);
     size_t get_bounded_edges(roofer::SegmentCollection &edges);
     std::vector<size_t> detect();
+    // Same result as calling detect() for each min_segment_count from upper
+    // down to lower, but the regions are only grown again for a lower count
+    // when the segmentation has changed. Leaves min_segment_count at lower.
+    std::vector<size_t> detect(size_t upper, size_t lower);
 
    private:
     inline Line fit_line(vector<size_t> &neighbour_idx);
     inline bool valid_candidate(Line &line, Point &p);
-    bool grow_region(size_t seed_idx);
+    bool detect_pass(size_t skip, vector<size_t> &region_sizes,
+                     vector<size_t> &new_regions);
+    size_t grow_region(size_t seed_idx);
   };
 }  // namespace roofer::linedect
@@ -26,8 +26,14 @@
 #include <CGAL/Polygon_2.h>
 #include <CGAL/Polygon_with_holes_2.h>
 
-#include <boost/heap/fibonacci_heap.hpp>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <roofer/common/datastructures.hpp>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 namespace roofer::linereg {
   using K = CGAL::Exact_predicates_exact_constructions_kernel;
@@ -50,68 +56,104 @@ namespace roofer::linereg {
     std::vector<linetype*> lines;
     virtual double distance(Cluster<T>* other_cluster) = 0;
     virtual void calc_mean_value() = 0;
+    // Interval of a 1D key of the value, for the bucketing of DistanceTable.
+    // The keys of two clusters that are closer than a threshold are less than
+    // bounds_radius(threshold) apart.
+    virtual std::array<double, 2> key_range() const = 0;
   };
   struct AngleCluster : public Cluster<double> {
     double distance(Cluster<double>* other_cluster) override;
     void calc_mean_value() override;
+    // the angle itself
+    std::array<double, 2> key_range() const override;
+    static double bounds_radius(double threshold);
   };
   struct DistCluster : public Cluster<Segment_2> {
+    // unit vector that the segment is projected on for its key, the normal
+    // of the direction of its angle cluster. The lines of an angle cluster
+    // are almost parallel, so their keys are short intervals of the offset
+    // across the lines, also for long and diagonal lines.
+    std::array<double, 2> key_axis{1, 0};
+
     double distance(Cluster<Segment_2>* other_cluster) override;
     void calc_mean_value() override;
+    std::array<double, 2> key_range() const override;
+    static double bounds_radius(double threshold);
   };
 
+  // Agglomerative clustering table. Each cluster keeps its nearest cluster
+  // that is closer than the threshold, and the clusters are kept in a binary
+  // heap on that distance, so that the top of the heap is the closest pair.
+  // Clusters are bucketed on the key range of their value, so that only the
+  // clusters in neighbouring buckets are measured. The buckets are at least
+  // as wide as the bounds radius, so when most keys lie within it, as the
+  // angles of a building with a few main directions do, most pairs are
+  // still measured and the time stays close to quadratic. After a merge only
+  // distances of the merged cluster are measured again, and the nearest
+  // cluster of the clusters that were nearest to one of the two merged
+  // clusters is searched again.
   template <typename ClusterH>
-  struct DistanceTable {
-    using ClusterPair = std::pair<ClusterH, ClusterH>;
+  class DistanceTable {
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    std::set<ClusterH>& clusters;
+    double threshold;
+
+    // clusters by index
+    std::vector<ClusterH> handles;
+    std::unordered_map<ClusterH, uint32_t> index;
+    std::vector<char> alive;
+
+    // nearest cluster of each cluster (npos if there is none closer than the
+    // threshold), the clusters of which a cluster was found to be the
+    // nearest, and a binary min heap of the clusters that have a nearest
+    // cluster
+    std::vector<uint32_t> nearest;
+    std::vector<double> nearest_dist;
+    std::vector<std::vector<uint32_t>> nearest_of;
+    std::vector<uint32_t> heap;
+    std::vector<uint32_t> heap_pos;
+
+    // buckets of cluster indices over the cluster keys, and the first and
+    // last bucket that each cluster was added to
+    double key0 = 0, bucket_size = 1, radius = 0;
+    std::vector<std::vector<uint32_t>> buckets;
+    std::vector<std::array<size_t, 2>> bucket_range;
+    // query stamp of each cluster, to measure each cluster once per query
+    std::vector<uint32_t> stamp;
+    uint32_t query_cnt = 0;
+
+    bool closer(uint32_t cluster, double dist, uint32_t other) const;
+    bool heap_less(uint32_t lhs, uint32_t rhs) const;
+    void heap_sift_up(size_t pos);
+    void heap_sift_down(size_t pos);
+    void heap_update(uint32_t cluster);
+    void heap_erase(uint32_t cluster);
+    void set_nearest(uint32_t cluster, uint32_t other, double dist);
+
+    std::array<size_t, 2> buckets_of(const std::array<double, 2>& key,
+                                     double margin) const;
+    void add_to_buckets(uint32_t cluster);
+    // measure the clusters in the buckets around a cluster and set its
+    // nearest cluster. With update_others, also make the cluster the nearest
+    // of every cluster for which it is closer than their current nearest.
+    void find_nearest(uint32_t cluster, bool update_others);
 
-    // fibonacci heap from boost
+   public:
     struct ClusterPairDist {
-      ClusterPairDist(ClusterPair p, double d) : clusters(p), dist(d) {}
-      ClusterPair clusters;
+      std::pair<ClusterH, ClusterH> clusters;
       double dist;
-
-      bool operator<(ClusterPairDist const& rhs) const {
-        return dist > rhs.dist;
-      }
     };
-    using DistanceHeap = boost::heap::fibonacci_heap<ClusterPairDist>;
-    using heap_handle = typename DistanceHeap::handle_type;
-
-    // define hash function such that the same hash results regardless of the
-    // order of cluster handles in the pair struct KeyHash {
-    //   size_t operator()(const ClusterPair& key) const {
-    //     if (key.first.get() < key.second.get())
-    //       return std::hash<ClusterH>()(key.first) ^
-    //         (std::hash<ClusterH>()(key.second) << 1);
-    //     else
-    //       return std::hash<ClusterH>()(key.second) ^
-    //         (std::hash<ClusterH>()(key.first) << 1);
-
-    //   }
-    // };
-    // // True equality function is needed to deal with collisions
-    // struct KeyEqual {
-    //   bool operator()(const ClusterPair& lhs, const ClusterPair& rhs) const {
-    //     return
-    //       ((lhs.first==rhs.first) && (lhs.second==rhs.second))
-    //       ||
-    //       ((lhs.first==rhs.second) && (lhs.second==rhs.first));
-    //   }
-    // };
-    using Cluster2DistPairMap =
-        std::unordered_map<ClusterH, std::list<std::shared_ptr<heap_handle>>>;
-
-    Cluster2DistPairMap cluster_to_dist_pairs;
-    DistanceHeap distances;
-    std::set<ClusterH>& clusters;
 
-    DistanceTable(std::set<ClusterH>& clusters);  // computes initial distances
-    void merge(
-        ClusterH lhs,
-        ClusterH rhs);  // merges two clusters, then removes one from the
-                        // distances map and update the affected distances
-    ClusterPairDist
-    get_closest_pair();  // returns the cluster pair with the smallest distance
+    // computes initial distances
+    DistanceTable(std::set<ClusterH>& clusters, double threshold);
+    // merges two clusters, removes rhs from the clusters and updates the
+    // distances of lhs
+    void merge(ClusterH lhs, ClusterH rhs);
+    // returns the cluster pair with the smallest distance
+    ClusterPairDist get_closest_pair() const;
+    // true if no cluster pair is closer than the threshold
+    bool empty() const;
   };
 
   // extern template class Cluster<double>;
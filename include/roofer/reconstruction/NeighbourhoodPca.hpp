@@ -0,0 +1,191 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <roofer/common/common.hpp>
+#include <roofer/reconstruction/KnnGraph.hpp>
+#include <span>
+
+namespace roofer::reconstruction {
+
+  /**
+   * @brief Eigenvalues and the eigenvector of the smallest eigenvalue of a
+   * symmetric 3x3 matrix, with the closed-form trigonometric solution.
+   *
+   * @param c           Upper triangle of the matrix, in the order
+   *                    xx, xy, xz, yy, yz, zz
+   * @param[out] values Eigenvalues in ascending order
+   * @param[out] vector Unit eigenvector of the smallest eigenvalue
+   * @return false if all eigenvalues are equal, in which case `vector` is
+   * set to (0, 0, 1)
+   */
+  template <typename T>
+  inline bool smallest_eigenvector(const std::array<T, 6>& c,
+                                   std::array<T, 3>& values,
+                                   std::array<T, 3>& vector) {
+    vector = {0, 0, 1};
+    // scale the matrix to avoid overflow and underflow in the determinant
+    T scale = 0;
+    for (auto v : c) scale = std::max(scale, std::abs(v));
+    if (!(scale > 0)) {
+      values = {0, 0, 0};
+      return false;
+    }
+    const T a00 = c[0] / scale, a01 = c[1] / scale, a02 = c[2] / scale;
+    const T a11 = c[3] / scale, a12 = c[4] / scale, a22 = c[5] / scale;
+
+    const T q = (a00 + a11 + a22) / 3;
+    const T b00 = a00 - q, b11 = a11 - q, b22 = a22 - q;
+    const T p2 = b00 * b00 + b11 * b11 + b22 * b22 +
+                 2 * (a01 * a01 + a02 * a02 + a12 * a12);
+    const T p = std::sqrt(p2 / 6);
+    if (!(p > 0)) {
+      values = {q * scale, q * scale, q * scale};
+      return false;
+    }
+    // half the determinant of (A - qI) / p
+    const T det = b00 * (b11 * b22 - a12 * a12) -
+                  a01 * (a01 * b22 - a12 * a02) +
+                  a02 * (a01 * a12 - b11 * a02);
+    const T r = std::clamp(det / (2 * p * p * p), T(-1), T(1));
+    const T phi = std::acos(r) / 3;
+    constexpr T two_thirds_pi = T(2.0943951023931954923);
+    const T l2 = q + 2 * p * std::cos(phi);
+    T l0 = q + 2 * p * std::cos(phi + two_thirds_pi);
+    // acos() loses half the digits when l1 and l2 are (nearly) equal, which
+    // is typical for a planar patch. One Newton step on the characteristic
+    // polynomial restores the precision of l0 when it is a simple root.
+    {
+      const T d0 = a00 - l0, d1 = a11 - l0, d2 = a22 - l0;
+      const T m0 = d1 * d2 - a12 * a12, m1 = d0 * d2 - a02 * a02,
+              m2 = d0 * d1 - a01 * a01;
+      const T f = d0 * m0 - a01 * (a01 * d2 - a12 * a02) +
+                  a02 * (a01 * a12 - d1 * a02);
+      const T df = -(m0 + m1 + m2);
+      if (df < 0) {
+        const T refined = l0 - f / df;
+        if (refined <= q) l0 = refined;
+      }
+    }
+    const T l1 = 3 * q - l0 - l2;
+    values = {l0 * scale, l1 * scale, l2 * scale};
+
+    // the eigenvector is orthogonal to the rows of A - l0 I, take the most
+    // stable cross product of two rows
+    auto null_vector = [&](T l, std::array<T, 3>& v) {
+      const std::array<T, 3> r0{a00 - l, a01, a02}, r1{a01, a11 - l, a12},
+          r2{a02, a12, a22 - l};
+      auto cross = [](const std::array<T, 3>& u, const std::array<T, 3>& w) {
+        return std::array<T, 3>{u[1] * w[2] - u[2] * w[1],
+                                u[2] * w[0] - u[0] * w[2],
+                                u[0] * w[1] - u[1] * w[0]};
+      };
+      auto norm2 = [](const std::array<T, 3>& u) {
+        return u[0] * u[0] + u[1] * u[1] + u[2] * u[2];
+      };
+      std::array<std::array<T, 3>, 3> candidates{cross(r0, r1), cross(r0, r2),
+                                                 cross(r1, r2)};
+      T best = 0;
+      for (const auto& candidate : candidates) {
+        const T n2 = norm2(candidate);
+        if (n2 > best) {
+          best = n2;
+          v = candidate;
+        }
+      }
+      if (!(best > std::numeric_limits<T>::epsilon() *
+                       std::numeric_limits<T>::epsilon())) {
+        return false;
+      }
+      const T inv = 1 / std::sqrt(best);
+      for (auto& x : v) x *= inv;
+      return true;
+    };
+    if (!null_vector(l0, vector)) {
+      // l0 is a double eigenvalue, any vector orthogonal to the eigenvector
+      // of l2 will do
+      std::array<T, 3> v2{0, 0, 1};
+      null_vector(l2, v2);
+      const std::array<T, 3> axis = std::abs(v2[0]) < T(0.9)
+                                        ? std::array<T, 3>{1, 0, 0}
+                                        : std::array<T, 3>{0, 1, 0};
+      vector = {v2[1] * axis[2] - v2[2] * axis[1],
+                v2[2] * axis[0] - v2[0] * axis[2],
+                v2[0] * axis[1] - v2[1] * axis[0]};
+      const T n = std::sqrt(vector[0] * vector[0] + vector[1] * vector[1] +
+                            vector[2] * vector[2]);
+      for (auto& x : vector) x /= n;
+    }
+    return true;
+  }
+
+  /**
+   * @brief Fit a plane to the neighbourhood of each point, for the normals
+   * and for the ranking of region growing seeds, in a single pass over the
+   * k-NN graph.
+   *
+   * The normal of a point is the eigenvector of the smallest eigenvalue of
+   * the covariance of its first `normal_k` neighbours, the point itself
+   * included. The seed score is the planarity 1 - l0 / l1 of the next
+   * `seed_k` neighbours, the point itself excluded, which is the fitting
+   * quality that CGAL::linear_least_squares_fitting_3() returns.
+   *
+   * The covariances are accumulated in the scalar type T relative to the
+   * query point. The points are processed in blocks, which are the unit of
+   * parallel work, and each covariance is solved with the scalar
+   * smallest_eigenvector(). The normals and seed scores differ from the
+   * double precision least squares fits of estimate_normals() and
+   * PlaneDS::fit_plane() within the precision of T, so the region growing
+   * may visit seeds with nearly equal scores in another order.
+   *
+   * @param[out] normals     Unit normals, not oriented
+   * @param[out] seed_scores Seed score per point, in [0, 1]
+   */
+  template <typename T = float>
+  void fit_neighbourhood_planes(std::span<const arr3f> points,
+                                const KnnGraph& graph, std::size_t normal_k,
+                                std::size_t seed_k, vec3f& normals,
+                                vec1f& seed_scores);
+
+  /**
+   * @brief Estimate the normal of each point with a double precision least
+   * squares plane fit to its first `k` neighbours, the point itself included,
+   * as CGAL::pca_estimate_normals() does with a kd-tree of its own.
+   *
+   * @param[out] normals Unit normals, not oriented
+   */
+  void estimate_normals(std::span<const arr3f> points, const KnnGraph& graph,
+                        std::size_t k, vec3f& normals);
+
+  extern template void fit_neighbourhood_planes<float>(
+      std::span<const arr3f>, const KnnGraph&, std::size_t, std::size_t,
+      vec3f&, vec1f&);
+  extern template void fit_neighbourhood_planes<double>(
+      std::span<const arr3f>, const KnnGraph&, std::size_t, std::size_t,
+      vec3f&, vec1f&);
+
+}  // namespace roofer::reconstruction
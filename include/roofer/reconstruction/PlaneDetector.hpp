@@ -68,6 +68,10 @@ namespace roofer::reconstruction {
     public_)                                                                   \
   X(bool, use_ransac, false, "Use RANSAC plane detection.",                    \
     config::no_validation<bool>(), internal)                                   \
+  X(bool, single_pass_pca, false,                                              \
+    "Estimate the normals and rank the region growing seeds with one single "  \
+    "precision PCA pass over the k-NN graph, instead of least squares fits.",  \
+    config::no_validation<bool>(), internal)                                   \
   X(float, maximum_angle, 25.0F,                                               \
     "Maximum plane regularisation angle, in degrees.",                         \
     config::in_range(0.0F, 90.0F), public_)                                    \
@@ -25,12 +25,17 @@
 #include <CGAL/Plane_3.h>
 #include <CGAL/linear_least_squares_fitting_3.h>
 
-#include <deque>
+#include <array>
+#include <memory_resource>
 #include <queue>
 #include <roofer/common/datastructures.hpp>
+#include <roofer/common/memory_resource.hpp>
+#include <roofer/reconstruction/NeighbourhoodPca.hpp>
 #include <roofer/reconstruction/RegionGrower.hpp>
 #include <roofer/reconstruction/RegionGrower_DS_CGAL.hpp>
 #include <roofer/reconstruction/cgal_shared_definitions.hpp>
+#include <span>
+#include <vector>
 
 namespace roofer {
 
@@ -38,16 +43,25 @@ namespace roofer {
 
     class PlaneDS : public regiongrower::CGAL_RegionGrowerDS {
      public:
-      roofer::vec3f& normals;
+      const roofer::vec3f& normals;
       std::vector<Plane> seed_planes;
+      // planarity of the neighbourhood of each point, the seeds are computed
+      // with fit_plane() if this is empty
+      roofer::vec1f seed_scores;
 
-      PlaneDS(roofer::PointCollection& points, roofer::vec3f& normals,
-              size_t N = 15)
+      PlaneDS(const roofer::PointCollection& points,
+              const roofer::vec3f& normals, size_t N = 15)
           : CGAL_RegionGrowerDS(points, N), normals(normals){};
+      PlaneDS(const roofer::PointCollection& points,
+              const roofer::vec3f& normals,
+              const reconstruction::KnnGraph& graph, size_t N = 15)
+          : CGAL_RegionGrowerDS(points, graph, N), normals(normals){};
 
       // Note this crashes when idx.size()==1;
-      inline double fit_plane(std::vector<size_t>& idx, Plane& plane) {
-        std::vector<Point> neighbor_points;
+      inline double fit_plane(std::span<const size_t> idx, Plane& plane) {
+        // the buffer is reused for all seeds, so that ranking the seeds does
+        // not allocate for every point
+        neighbor_points.clear();
         for (auto i : idx)
           neighbor_points.push_back(
               Point(points[i][0], points[i][1], points[i][2]));
@@ -57,7 +71,7 @@ namespace roofer {
         return quality;
       }
 
-      virtual std::deque<size_t> get_seeds() override {
+      virtual std::vector<size_t> get_seeds() override {
         // seed generation
         typedef std::pair<size_t, double> index_dist_pair;
         auto cmp = [](index_dist_pair left, index_dist_pair right) {
@@ -67,37 +81,103 @@ namespace roofer {
                             decltype(cmp)>
             pq(cmp);
 
-        size_t i = 0;
-        Plane plane;
-        for (size_t pi = 0; pi < size; ++pi) {
-          auto neighbours = get_neighbours(pi);
-          auto quality = fit_plane(neighbours, plane);
-          pq.push(index_dist_pair(i++, quality));
+        if (seed_scores.size() == size) {
+          for (size_t pi = 0; pi < size; ++pi) {
+            pq.push(index_dist_pair(pi, seed_scores[pi]));
+          }
+        } else {
+          Plane plane;
+          for (size_t pi = 0; pi < size; ++pi) {
+            auto quality = fit_plane(get_neighbours(pi), plane);
+            pq.push(index_dist_pair(pi, quality));
+          }
         }
 
-        std::deque<size_t> seed_order;
+        std::vector<size_t> seed_order;
+        seed_order.reserve(size);
         while (pq.size() > 0) {
           seed_order.push_back(pq.top().first);
           pq.pop();
         }
         return seed_order;
       }
+
+     private:
+      // scratch buffer of fit_plane()
+      std::pmr::vector<Point> neighbor_points{scratch_resource()};
     };
 
     class PlaneRegion : public regiongrower::Region {
+      // moments of the inliers relative to the first inlier, so that a refit
+      // does not need to visit the inliers again
+      arr3d origin{};
+      arr3d sum{};
+      std::array<double, 6> outer{};
+      std::array<double, 4> local_plane{};
+
      public:
       using regiongrower::Region::Region;
       Plane plane;
       std::vector<size_t> inliers;
+
+      void add_inlier(size_t idx, const arr3f& p) {
+        if (inliers.empty()) origin = {p[0], p[1], p[2]};
+        inliers.push_back(idx);
+        const double dx = p[0] - origin[0];
+        const double dy = p[1] - origin[1];
+        const double dz = p[2] - origin[2];
+        sum[0] += dx;
+        sum[1] += dy;
+        sum[2] += dz;
+        outer[0] += dx * dx;
+        outer[1] += dx * dy;
+        outer[2] += dx * dz;
+        outer[3] += dy * dy;
+        outer[4] += dy * dz;
+        outer[5] += dz * dz;
+      }
+
+      const arr3d& get_origin() const { return origin; }
+      // plane equation a, b, c, d in coordinates relative to the origin
+      const std::array<double, 4>& get_local_plane() const {
+        return local_plane;
+      }
+
+      void set_plane(const Plane& new_plane) {
+        plane = new_plane;
+        local_plane = {plane.a(), plane.b(), plane.c(),
+                       plane.a() * origin[0] + plane.b() * origin[1] +
+                           plane.c() * origin[2] + plane.d()};
+      }
+
+      // Least squares plane through the inliers, the same plane as
+      // linear_least_squares_fitting_3() would give.
+      void refit_plane() {
+        const double n = double(inliers.size());
+        const std::array<double, 6> covariance{
+            outer[0] - sum[0] * sum[0] / n, outer[1] - sum[0] * sum[1] / n,
+            outer[2] - sum[0] * sum[2] / n, outer[3] - sum[1] * sum[1] / n,
+            outer[4] - sum[1] * sum[2] / n, outer[5] - sum[2] * sum[2] / n};
+        std::array<double, 3> values, normal;
+        reconstruction::smallest_eigenvector(covariance, values, normal);
+        set_plane(Plane(Point(origin[0] + sum[0] / n, origin[1] + sum[1] / n,
+                              origin[2] + sum[2] / n),
+                        Vector(normal[0], normal[1], normal[2])));
+      }
     };
 
+    // Tests whether a neighbour fits the plane of the region. The test is
+    // evaluated in the scalar type T, on coordinates relative to the first
+    // inlier of the region. See docs/numerical_precision.md for why float is
+    // accurate enough.
+    template <typename T = float>
     class DistAndNormalTester {
      public:
-      float dist_thres;
-      float normal_thres;
+      T dist_thres;
+      T normal_thres;
       size_t n_refit, refit_counter = 0;
 
-      DistAndNormalTester(float dist_thres = 0.04, float normal_thres = 0.9,
+      DistAndNormalTester(T dist_thres = T(0.04), T normal_thres = T(0.9),
                           size_t n_refit = 5)
           : dist_thres(dist_thres),
             normal_thres(normal_thres),
@@ -105,29 +185,28 @@ namespace roofer {
 
       bool is_valid(PlaneDS& cds, size_t candidate, size_t neighbour,
                     PlaneRegion& shape) {
-        Point p_c = Point(cds.points[candidate][0], cds.points[candidate][1],
-                          cds.points[candidate][2]);
-        Vector n_c =
-            Vector(cds.normals[candidate][0], cds.normals[candidate][1],
-                   cds.normals[candidate][2]);
-        Point p = Point(cds.points[neighbour][0], cds.points[neighbour][1],
-                        cds.points[neighbour][2]);
-        Vector n = Vector(cds.normals[neighbour][0], cds.normals[neighbour][1],
-                          cds.normals[neighbour][2]);
-
         if (shape.inliers.size() == 0) {
-          shape.plane = Plane(p_c, n_c);
-          shape.inliers.push_back(candidate);
+          const auto& p_c = cds.points[candidate];
+          const auto& n_c = cds.normals[candidate];
+          shape.add_inlier(candidate, p_c);
+          shape.set_plane(Plane(Point(p_c[0], p_c[1], p_c[2]),
+                                Vector(n_c[0], n_c[1], n_c[2])));
         }
 
+        const auto& p = cds.points[neighbour];
+        const auto& n = cds.normals[neighbour];
+        const auto& origin = shape.get_origin();
+        const auto& e = shape.get_local_plane();
+        const T a = T(e[0]), b = T(e[1]), c = T(e[2]);
+        const T dist = a * (T(p[0]) - T(origin[0])) +
+                       b * (T(p[1]) - T(origin[1])) +
+                       c * (T(p[2]) - T(origin[2])) + T(e[3]);
         bool valid =
-            (CGAL::squared_distance(shape.plane, p) < dist_thres) &&
-            (std::abs(shape.plane.orthogonal_vector() * n) > normal_thres);
+            (dist * dist / (a * a + b * b + c * c) < dist_thres) &&
+            (std::abs(a * T(n[0]) + b * T(n[1]) + c * T(n[2])) > normal_thres);
         if (valid) {
-          shape.inliers.push_back(neighbour);
-          if (shape.inliers.size() % n_refit == 0) {
-            cds.fit_plane(shape.inliers, shape.plane);
-          }
+          shape.add_inlier(neighbour, p);
+          if (shape.inliers.size() % n_refit == 0) shape.refit_plane();
         }
         return valid;
       }
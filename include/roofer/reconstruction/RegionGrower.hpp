@@ -21,11 +21,14 @@
 
 #pragma once
 
-#include <deque>
-#include <type_traits>
-#include <unordered_map>
+#include <algorithm>
+#include <map>
+#include <memory_resource>
+#include <roofer/common/memory_resource.hpp>
 #include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace roofer {
 
@@ -57,29 +60,32 @@ namespace roofer {
                         // plane_ids (all lower)
 
      private:
+      // one (region, adjacent region) pair per neighbour that links them
+      typedef pmr::vector<pair<size_t, size_t>> edge_vector;
+
       template <typename Tester>
       inline bool grow_one_region(candidateDS& cds, Tester& tester,
-                                  size_t& seed_handle) {
-        deque<size_t> candidates;
-        vector<size_t> handles_in_region;
+                                  size_t seed_handle, edge_vector& edges) {
+        // the handles in the order they were added to the region, the ones
+        // from `next` onwards are the candidates that still need to be grown
+        pmr::vector<size_t> handles_in_region(scratch_resource());
+        const auto edges_begin = edges.size();
         regions.push_back(regionType(cur_region_id));
 
-        candidates.push_back(seed_handle);
         handles_in_region.push_back(seed_handle);
         region_ids[seed_handle] = cur_region_id;  // regions.size();
 
-        while (candidates.size() > 0) {
-          auto candidate = candidates.front();
-          candidates.pop_front();
+        for (size_t next = 0; next < handles_in_region.size(); ++next) {
+          const auto candidate = handles_in_region[next];
           for (auto neighbour : cds.get_neighbours(candidate)) {
-            if (region_ids[neighbour] != 0) {
-              if (region_ids[neighbour] != cur_region_id) {
-                adjacencies[cur_region_id][region_ids[neighbour]]++;
+            const auto neighbour_region = region_ids[neighbour];
+            if (neighbour_region != 0) {
+              if (neighbour_region != cur_region_id) {
+                edges.emplace_back(cur_region_id, neighbour_region);
               }
               continue;
             }
             if (tester.is_valid(cds, candidate, neighbour, regions.back())) {
-              candidates.push_back(neighbour);
               handles_in_region.push_back(neighbour);
               region_ids[neighbour] = cur_region_id;  // regions.size();
             }
@@ -88,50 +94,58 @@ namespace roofer {
         // undo region if it doesn't satisfy quality criteria
         if (handles_in_region.size() < min_segment_count) {
           regions.erase(regions.end() - 1);
-          adjacencies.erase(cur_region_id);
+          edges.resize(edges_begin);
           for (auto handle : handles_in_region) region_ids[handle] = 0;
           return false;
         }
         return true;
       };
 
+      // count the pairs per region and adjacent region
+      void collect_adjacencies(edge_vector& edges) {
+        std::sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size();) {
+          size_t j = i + 1;
+          while (j < edges.size() && edges[j] == edges[i]) ++j;
+          adjacencies[edges[i].first][edges[i].second] += j - i;
+          i = j;
+        }
+      }
+
      public:
       template <typename Tester>
       void grow_regions(candidateDS& cds, Tester& tester) {
-        std::vector<size_t> new_regions;
-        std::deque<size_t> seeds = cds.get_seeds();
+        const auto seeds = cds.get_seeds();
+        edge_vector edges(scratch_resource());
 
         region_ids.resize(cds.size, 0);
         // first region means unsegmented
         regions.push_back(regionType(0));
 
         // region growing from seed points
-        while (seeds.size() > 0) {
-          auto idx = seeds.front();
-          seeds.erase(seeds.begin());
+        for (auto idx : seeds) {
           if (region_ids[idx] == 0) {
-            grow_one_region(cds, tester, idx);
+            grow_one_region(cds, tester, idx, edges);
             ++cur_region_id;
           }
         }
+        collect_adjacencies(edges);
       };
 
       template <typename Tester>
       void grow_regions_with_limits(candidateDS& cds, Tester& tester,
                                     size_t limit_n_regions) {
-        std::vector<size_t> new_regions;
-        std::deque<size_t> seeds = cds.get_seeds();
+        const auto seeds = cds.get_seeds();
+        edge_vector edges(scratch_resource());
 
         region_ids.resize(cds.size, 0);
         // first region means unsegmented
         regions.push_back(regionType(0));
 
         // region growing from seed points
-        while (seeds.size() > 0) {
-          auto idx = seeds.front();
-          seeds.erase(seeds.begin());
+        for (auto idx : seeds) {
           if (region_ids[idx] == 0) {
-            grow_one_region(cds, tester, idx);
+            grow_one_region(cds, tester, idx, edges);
             ++cur_region_id;
             if (regions.size() >= limit_n_regions) {
               throw std::runtime_error(
@@ -140,6 +154,7 @@ namespace roofer {
             }
           }
         }
+        collect_adjacencies(edges);
       };
     };
 
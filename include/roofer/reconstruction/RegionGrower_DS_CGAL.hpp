@@ -28,10 +28,11 @@
 #include <CGAL/property_map.h>
 
 #include <algorithm>
-#include <deque>
 #include <random>
 #include <roofer/common/common.hpp>
+#include <roofer/reconstruction/KnnGraph.hpp>
 #include <roofer/reconstruction/cgal_shared_definitions.hpp>
+#include <span>
 #include <vector>
 
 namespace roofer {
@@ -49,13 +50,14 @@ namespace roofer {
       typedef CGAL::Orthogonal_k_neighbor_search<TreeTraits> Neighbor_search;
       typedef Neighbor_search::Tree Tree;
 
-      typedef std::vector<std::vector<size_t>> vecvecui;
-
-      roofer::PointCollection& points;
-      vecvecui neighbours;
+      const roofer::PointCollection& points;
+      // neighbours of point i are neighbours[neighbour_offsets[i]] ..
+      // neighbours[neighbour_offsets[i + 1]]
+      std::vector<size_t> neighbour_offsets;
+      std::vector<size_t> neighbours;
       size_t size;
 
-      CGAL_RegionGrowerDS(roofer::PointCollection& points, size_t N = 15)
+      CGAL_RegionGrowerDS(const roofer::PointCollection& points, size_t N = 15)
           : points(points) {
         size = points.size();
 
@@ -68,25 +70,42 @@ namespace roofer {
               std::make_pair(Point(p[0], p[1], p[2]), i++));
         Tree tree;
         tree.insert(indexed_points.begin(), indexed_points.end());
-        neighbours.resize(size);
+        neighbour_offsets.reserve(size + 1);
+        neighbour_offsets.push_back(0);
+        neighbours.reserve(size * N);
 
         for (auto pi : indexed_points) {
           auto p = pi.first;
-          neighbours[pi.second].reserve(N);
           Neighbor_search search(tree, p, N + 1);
-          // auto gp = glm::make_vec3(points[pi.second].data());
           // skip the first point since it is identical to the query point
           for (auto neighbour = search.begin() + 1; neighbour < search.end();
                ++neighbour) {
-            neighbours[pi.second].push_back(neighbour->first.second);
-            // std::cout << pi.second << " : " <<
-            // glm::distance(gp,glm::make_vec3(points[neighbour->first.second].data()))
-            // << "\n";
+            neighbours.push_back(neighbour->first.second);
+          }
+          neighbour_offsets.push_back(neighbours.size());
+        }
+      };
+      // Take the N nearest neighbours from a k-NN graph of the same points,
+      // with k > N.
+      CGAL_RegionGrowerDS(const roofer::PointCollection& points,
+                          const reconstruction::KnnGraph& graph, size_t N = 15)
+          : points(points) {
+        size = points.size();
+        neighbour_offsets.reserve(size + 1);
+        neighbour_offsets.push_back(0);
+        neighbours.reserve(size * N);
+        for (size_t i = 0; i < size; ++i) {
+          // skip the first neighbour since it is identical to the query point
+          auto row = graph.neighbours(i, N + 1);
+          if (row.size() > 1) {
+            neighbours.insert(neighbours.end(), row.begin() + 1, row.end());
           }
+          neighbour_offsets.push_back(neighbours.size());
         }
       };
-      virtual std::deque<size_t> get_seeds() {
-        std::deque<size_t> seeds;
+      virtual std::vector<size_t> get_seeds() {
+        std::vector<size_t> seeds;
+        seeds.reserve(size);
         for (size_t i = 0; i < size; ++i) {
           seeds.push_back(i);
         }
@@ -95,7 +114,10 @@ namespace roofer {
         std::shuffle(seeds.begin(), seeds.end(), g);
         return seeds;
       }
-      std::vector<size_t> get_neighbours(size_t idx) { return neighbours[idx]; }
+      std::span<const size_t> get_neighbours(size_t idx) const {
+        return {neighbours.data() + neighbour_offsets[idx],
+                neighbours.data() + neighbour_offsets[idx + 1]};
+      }
     };
 
   }  // namespace regiongrower
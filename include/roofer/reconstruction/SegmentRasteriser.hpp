@@ -57,8 +57,6 @@ namespace roofer::reconstruction {
     // add_output("heightfield", typeid(RasterTools::Raster));
 
     // add_output("heightfield", typeid(RasterTools::Raster));
-    // add_output("grid_points", typeid(PointCollection));
-    // add_output("values", typeid(vec1f));
     // add_output("data_area", typeid(float));
 
     virtual ~SegmentRasteriserInterface() = default;
@@ -66,6 +64,11 @@ namespace roofer::reconstruction {
         TriangleCollection& roof_triangles,
         TriangleCollection& ground_triangles,
         SegmentRasteriserConfig config = SegmentRasteriserConfig()) = 0;
+    // Rasterise the indexed triangles of AlphaShaper::alpha_triangle_mesh.
+    virtual void compute(
+        IndexedTriangleCollection& roof_triangles,
+        IndexedTriangleCollection& ground_triangles,
+        SegmentRasteriserConfig config = SegmentRasteriserConfig()) = 0;
   };
 
   std::unique_ptr<SegmentRasteriserInterface> createSegmentRasteriser();
@@ -21,6 +21,7 @@
 // Ravi Peters
 #pragma once
 
+#include <roofer/common/memory_resource.hpp>
 #include <roofer/reconstruction/AlphaShaper.hpp>
 #include <roofer/reconstruction/ArrangementBuilder.hpp>
 #include <roofer/reconstruction/ArrangementDissolver.hpp>
@@ -225,6 +226,8 @@ namespace roofer {
   std::vector<Mesh> reconstruct(const PointCollection& points_roof,
                                 const PointCollection& points_ground,
                                 Footprint& footprint, ReconstructOptions cfg) {
+    // temporaries of the stages below are released together on return
+    ScratchArena scratch;
     try {
       // check if configuration is valid
       if (!cfg.is_valid()) {
@@ -318,9 +321,15 @@ namespace roofer {
         SegmentRasterizerCfg.use_ground = false;
         reconstruction.clip_terrain = false;
       }
-      SegmentRasteriser->compute(AlphaShaper->alpha_triangles,
-                                 AlphaShaper_ground->alpha_triangles,
-                                 SegmentRasterizerCfg);
+      if (reconstruction.alpha_shaper.shared_triangulation) {
+        SegmentRasteriser->compute(AlphaShaper->alpha_triangle_mesh,
+                                   AlphaShaper_ground->alpha_triangle_mesh,
+                                   SegmentRasterizerCfg);
+      } else {
+        SegmentRasteriser->compute(AlphaShaper->alpha_triangles,
+                                   AlphaShaper_ground->alpha_triangles,
+                                   SegmentRasterizerCfg);
+      }
 
       Arrangement_2 arrangement;
       auto ArrangementBuilder =
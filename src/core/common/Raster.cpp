@@ -19,66 +19,43 @@
 // Author(s):
 // Ravi Peters
 
+#include <cstdint>
 #include <limits>
 #include <roofer/common/Raster.hpp>
 
 namespace roofer {
   namespace RasterTools {
 
-    Raster::Raster(double cellsize, double min_x, double max_x, double min_y,
-                   double max_y)
+    template <typename T>
+    BasicRaster<T>::BasicRaster(double cellsize, double min_x, double max_x,
+                                double min_y, double max_y)
         : cellSize_(cellsize),
           minx_(min_x),
-          maxx_(max_x),
           miny_(min_y),
+          maxx_(max_x),
           maxy_(max_y) {
       dimx_ = (maxx_ - minx_) / cellSize_ + 1;
       dimy_ = (maxy_ - miny_) / cellSize_ + 1;
-      vals_ = std::make_unique<std::vector<float>>();
-      vals_->resize(dimx_ * dimy_);
-      // counts_ = std::make_unique<std::vector<int16_t>>();
-      // counts_->resize(dimx_*dimy_);
-    }
-    Raster::Raster(const Raster &r) {
-      cellSize_ = r.cellSize_;
-      maxx_ = r.maxx_;
-      minx_ = r.minx_;
-      maxy_ = r.maxy_;
-      miny_ = r.miny_;
-      noDataVal_ = r.noDataVal_;
-      dimx_ = (maxx_ - minx_) / cellSize_ + 1;
-      dimy_ = (maxy_ - miny_) / cellSize_ + 1;
-      vals_ = std::make_unique<std::vector<float>>(*r.vals_);
-      // counts_ = std::make_unique<std::vector<int16_t>>(*r.counts_);
-    }
-    void Raster::operator=(const Raster &r) {
-      cellSize_ = r.cellSize_;
-      maxx_ = r.maxx_;
-      minx_ = r.minx_;
-      maxy_ = r.maxy_;
-      miny_ = r.miny_;
-      noDataVal_ = r.noDataVal_;
-      dimx_ = (maxx_ - minx_) / cellSize_ + 1;
-      dimy_ = (maxy_ - miny_) / cellSize_ + 1;
-      vals_ = std::make_unique<std::vector<float>>(*r.vals_);
-      // counts_ = std::make_unique<std::vector<int16_t>>(*r.counts_);
+      vals_.resize(dimx_ * dimy_);
     }
 
-    void Raster::prefill_arrays(alg a) {
+    template <typename T>
+    void BasicRaster<T>::prefill_arrays(alg a) {
       if (a == MIN)
-        noDataVal_ = std::numeric_limits<float>::max();
+        noDataVal_ = std::numeric_limits<T>::max();
       else if (a == MAX)
-        noDataVal_ = -std::numeric_limits<float>::max();
+        noDataVal_ = std::numeric_limits<T>::lowest();
       else {
         noDataVal_ = 0;
       }
 
-      std::fill(vals_->begin(), vals_->end(), noDataVal_);
+      std::fill(vals_.begin(), vals_.end(), noDataVal_);
       // std::fill(counts_->begin(), counts_->end(), 0);
     }
 
-    bool Raster::add_point(double x, double y, double z, alg a) {
-      bool first = (*vals_)[getLinearCoord(x, y)] == noDataVal_;
+    template <typename T>
+    bool BasicRaster<T>::add_point(double x, double y, double z, alg a) {
+      bool first = vals_[getLinearCoord(x, y)] == noDataVal_;
       if (a == MIN) {
         min(x, y, z);
       } else if (a == MAX) {
@@ -87,12 +64,14 @@ namespace roofer {
       return first;
     }
 
-    bool Raster::add_value(double x, double y, double val) {
-      bool first = (*vals_)[getLinearCoord(x, y)] == noDataVal_;
+    template <typename T>
+    bool BasicRaster<T>::add_value(double x, double y, double val) {
+      bool first = vals_[getLinearCoord(x, y)] == noDataVal_;
       add(x, y, val);
       return first;
     }
-    bool Raster::check_point(double x, double y) {
+    template <typename T>
+    bool BasicRaster<T>::check_point(double x, double y) {
       auto col = getCol(x, y);
       if (col >= dimx_ || col < 0) return false;
       auto row = getRow(x, y);
@@ -108,19 +87,22 @@ namespace roofer {
     //   ++(*counts_)[c];
     // }
 
-    inline void Raster::min(double &x, double &y, double &val) {
+    template <typename T>
+    inline void BasicRaster<T>::min(double &x, double &y, double &val) {
       size_t c = getLinearCoord(x, y);
-      if ((*vals_)[c] > val) (*vals_)[c] = val;
+      if (vals_[c] > val) vals_[c] = val;
     }
 
-    inline void Raster::max(double &x, double &y, double &val) {
+    template <typename T>
+    inline void BasicRaster<T>::max(double &x, double &y, double &val) {
       size_t c = getLinearCoord(x, y);
-      if ((*vals_)[c] < val) (*vals_)[c] = val;
+      if (vals_[c] < val) vals_[c] = val;
     }
 
-    inline void Raster::add(double &x, double &y, double &val) {
+    template <typename T>
+    inline void BasicRaster<T>::add(double &x, double &y, double &val) {
       size_t c = getLinearCoord(x, y);
-      (*vals_)[c] = (*vals_)[c] + val;
+      vals_[c] = vals_[c] + val;
     }
 
     // inline void Raster::cnt(double &x, double &y)
@@ -129,33 +111,40 @@ namespace roofer {
     //   ++(*counts_)[c];
     // }
 
-    std::array<double, 2> Raster::getColRowCoord(double x, double y) const {
+    template <typename T>
+    std::array<double, 2> BasicRaster<T>::getColRowCoord(double x,
+                                                         double y) const {
       double r = (y - miny_) / cellSize_;
       double c = (x - minx_) / cellSize_;
 
       return {c, r};
     }
 
-    size_t Raster::getRow(double x, double y) const {
+    template <typename T>
+    size_t BasicRaster<T>::getRow(double x, double y) const {
       return static_cast<size_t>(floor((y - miny_) / cellSize_));
     }
-    size_t Raster::getCol(double x, double y) const {
+    template <typename T>
+    size_t BasicRaster<T>::getCol(double x, double y) const {
       return static_cast<size_t>(floor((x - minx_) / cellSize_));
     }
 
-    size_t Raster::getLinearCoord(double x, double y) const {
+    template <typename T>
+    size_t BasicRaster<T>::getLinearCoord(double x, double y) const {
       size_t r = static_cast<size_t>(floor((y - miny_) / cellSize_));
       size_t c = static_cast<size_t>(floor((x - minx_) / cellSize_));
 
       return r * dimx_ + c;
     }
 
-    size_t Raster::getLinearCoord(size_t r, size_t c) const {
+    template <typename T>
+    size_t BasicRaster<T>::getLinearCoord(size_t r, size_t c) const {
       return r * dimx_ + c;
     }
 
-    std::array<float, 3> Raster::getPointFromRasterCoords(size_t col,
-                                                          size_t row) const {
+    template <typename T>
+    std::array<float, 3> BasicRaster<T>::getPointFromRasterCoords(
+        size_t col, size_t row) const {
       std::array<float, 3> p;
       p[0] = minx_ + col * cellSize_ + cellSize_ / 2;
       p[1] = miny_ + row * cellSize_ + cellSize_ / 2;
@@ -164,68 +153,86 @@ namespace roofer {
       if (col >= dimx_ || row >= dimy_) {
         p[2] = noDataVal_;
       } else {
-        p[2] = (*vals_)[col + row * dimx_];
+        p[2] = vals_[col + row * dimx_];
       }
       return p;
     }
 
-    double Raster::sample(double &x, double &y) {
-      return (*vals_)[getLinearCoord(x, y)];
+    template <typename T>
+    double BasicRaster<T>::sample(double &x, double &y) {
+      return vals_[getLinearCoord(x, y)];
     }
 
-    void Raster::set_val(size_t col, size_t row, double val) {
-      (*vals_)[col + row * dimx_] = val;
+    template <typename T>
+    void BasicRaster<T>::set_val(size_t col, size_t row, double val) {
+      vals_[col + row * dimx_] = val;
     }
 
-    double Raster::get_val(size_t col, size_t row) {
-      return (*vals_)[col + row * dimx_];
+    template <typename T>
+    double BasicRaster<T>::get_val(size_t col, size_t row) {
+      return vals_[col + row * dimx_];
     }
 
-    bool Raster::isNoData(size_t col, size_t row) {
+    template <typename T>
+    bool BasicRaster<T>::isNoData(size_t col, size_t row) {
       return get_val(col, row) == noDataVal_;
     }
-    bool Raster::isNoData(double &x, double &y) {
-      return (*vals_)[getLinearCoord(x, y)] == noDataVal_;
+    template <typename T>
+    bool BasicRaster<T>::isNoData(double &x, double &y) {
+      return vals_[getLinearCoord(x, y)] == noDataVal_;
     }
 
-    void Raster::set_nodata(double new_nodata_val) {
+    template <typename T>
+    void BasicRaster<T>::set_nodata(double new_nodata_val) {
       for (size_t i = 0; i < dimx_ * dimy_; ++i) {
-        if ((*vals_)[i] == noDataVal_) {
-          (*vals_)[i] = new_nodata_val;
+        if (vals_[i] == noDataVal_) {
+          vals_[i] = new_nodata_val;
         }
       }
       noDataVal_ = new_nodata_val;
     }
 
-    void Raster::fill_nn(size_t window_size) {
-      // set nodata to max float
-      std::vector<float> new_vals(dimx_ * dimy_);
-
-      set_nodata(std::numeric_limits<float>::max());
-      // iterate though raster pixels
-      for (size_t col = 0; col < dimx_; ++col) {
-        for (size_t row = 0; row < dimy_; ++row) {
-          // if there is nodata here
-          if (get_val(col, row) == noDataVal_) {
-            // look in window of size radius around this pixel and collect the
-            // minimal value
-            size_t left = std::max(int(0), int(col) - int(window_size));
-            size_t right = std::min(int(dimx_), int(col) + int(window_size));
-            size_t bottom = std::max(int(0), int(row) - int(window_size));
-            size_t top = std::min(int(dimy_), int(row) + int(window_size));
-            double min_val = noDataVal_;
-            for (size_t wc = left; wc < right; ++wc) {
-              for (size_t wr = bottom; wr < top; ++wr) {
-                min_val = std::min(min_val, get_val(wc, wr));
-              }
-            }
-            new_vals[col + row * dimx_] = min_val;
-          } else {
-            new_vals[col + row * dimx_] = get_val(col, row);
+    template <typename T>
+    void BasicRaster<T>::fill_nn(size_t window_size) {
+      // set nodata to the largest value, so that it never is the minimum
+      set_nodata(std::numeric_limits<T>::max());
+      if (window_size == 0) return;
+
+      // The minimum over the window [-window_size, window_size) is separable,
+      // so it is the minimum over the rows of the window of the minima over
+      // its columns. Both passes take the minimum of whole rows at a time,
+      // which the compiler vectorises.
+      const T nodata = T(noDataVal_);
+      auto& vals = vals_;
+      std::vector<T> line(dimx_ + 2 * window_size, nodata);
+      std::vector<T> row_min(vals.size());
+      for (size_t row = 0; row < dimy_; ++row) {
+        std::copy_n(&vals[row * dimx_], dimx_, &line[window_size]);
+        T* dst = &row_min[row * dimx_];
+        std::copy_n(&line[0], dimx_, dst);
+        for (size_t k = 1; k < 2 * window_size; ++k) {
+          const T* src = &line[k];
+          for (size_t col = 0; col < dimx_; ++col) {
+            dst[col] = std::min(dst[col], src[col]);
+          }
+        }
+      }
+      std::vector<T> window_min(dimx_);
+      for (size_t row = 0; row < dimy_; ++row) {
+        const size_t first = row < window_size ? 0 : row - window_size;
+        const size_t last = std::min(dimy_, row + window_size);
+        std::fill(window_min.begin(), window_min.end(), nodata);
+        for (size_t r = first; r < last; ++r) {
+          const T* src = &row_min[r * dimx_];
+          for (size_t col = 0; col < dimx_; ++col) {
+            window_min[col] = std::min(window_min[col], src[col]);
           }
         }
+        T* dst = &vals[row * dimx_];
+        for (size_t col = 0; col < dimx_; ++col) {
+          if (dst[col] == nodata) dst[col] = window_min[col];
+        }
       }
-      (*vals_) = new_vals;
     }
 
     // void Raster::write(const char* WKGCS, alg a, void * dataPtr, const char*
@@ -270,5 +277,8 @@ namespace roofer {
     //   GDALClose( (GDALDatasetH) poDstDS );
     // }
 
+    template class BasicRaster<float>;
+    template class BasicRaster<int32_t>;
+
   }  // namespace RasterTools
 }  // namespace roofer
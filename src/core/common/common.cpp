@@ -384,6 +384,23 @@ namespace roofer {
   }
   float* TriangleCollection::get_data_ptr() { return (*this)[0][0].data(); }
 
+  size_t IndexedTriangleCollection::size() const { return triangles.size(); }
+  bool IndexedTriangleCollection::empty() const { return triangles.empty(); }
+  size_t IndexedTriangleCollection::vertex_count() const {
+    return vertices.size();
+  }
+  void IndexedTriangleCollection::compute_box() {
+    if (!bbox.has_value()) {
+      bbox = Box();
+      for (auto& p : vertices) {
+        bbox->add(p);
+      }
+    }
+  }
+  float* IndexedTriangleCollection::get_data_ptr() {
+    return vertices[0].data();
+  }
+
   size_t SegmentCollection::vertex_count() const { return size() * 2; }
   void SegmentCollection::compute_box() {
     if (!bbox.has_value()) {
@@ -0,0 +1,70 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+#include <memory>
+#include <optional>
+#include <roofer/common/memory_resource.hpp>
+#include <vector>
+
+namespace roofer {
+
+  namespace {
+    // The pool reuses freed blocks within a building, the monotonic resource
+    // below it gets its memory from the initial buffer first, and then from
+    // the default resource in chunks of increasing size.
+    struct Arena {
+      std::unique_ptr<std::byte[]> buffer =
+          std::make_unique_for_overwrite<std::byte[]>(
+              ScratchArena::initial_size);
+      std::optional<std::pmr::monotonic_buffer_resource> monotonic;
+      std::optional<std::pmr::unsynchronized_pool_resource> pool;
+    };
+
+    // one arena per nesting level, kept for the lifetime of the thread
+    thread_local std::vector<std::unique_ptr<Arena>> arenas;
+    thread_local std::size_t arena_depth = 0;
+    thread_local std::pmr::memory_resource* current_resource = nullptr;
+  }  // namespace
+
+  std::pmr::memory_resource* scratch_resource() {
+    return current_resource ? current_resource
+                            : std::pmr::get_default_resource();
+  }
+
+  ScratchArena::ScratchArena() : previous_(current_resource) {
+    if (arenas.size() == arena_depth) {
+      arenas.push_back(std::make_unique<Arena>());
+    }
+    auto& arena = *arenas[arena_depth++];
+    arena.monotonic.emplace(arena.buffer.get(), initial_size,
+                            std::pmr::get_default_resource());
+    arena.pool.emplace(&*arena.monotonic);
+    current_resource = &*arena.pool;
+  }
+
+  ScratchArena::~ScratchArena() {
+    auto& arena = *arenas[--arena_depth];
+    current_resource = previous_;
+    arena.pool.reset();
+    arena.monotonic.reset();
+  }
+
+}  // namespace roofer
@@ -0,0 +1,235 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <roofer/reconstruction/AlphaExpansion.hpp>
+
+namespace roofer::reconstruction {
+
+  double AlphaExpansion::energy(
+      size_t label_count, const std::vector<double>& costs,
+      const std::vector<std::array<uint32_t, 2>>& edges,
+      const std::vector<double>& weights, const std::vector<size_t>& labels) {
+    double sum = 0;
+    for (size_t p = 0; p < labels.size(); ++p) {
+      sum += costs[p * label_count + labels[p]];
+    }
+    for (size_t e = 0; e < edges.size(); ++e) {
+      if (labels[edges[e][0]] != labels[edges[e][1]]) sum += weights[e];
+    }
+    return sum;
+  }
+
+  void AlphaExpansion::build(
+      size_t node_count, const std::vector<std::array<uint32_t, 2>>& edges) {
+    // every node has an arc to the source and one to the sink, which are the
+    // last two nodes
+    const uint32_t source = uint32_t(node_count);
+    const uint32_t sink = source + 1;
+    offsets_.assign(node_count + 3, 0);
+    for (auto& [u, v] : edges) {
+      ++offsets_[u + 1];
+      ++offsets_[v + 1];
+    }
+    for (size_t p = 0; p < node_count; ++p) offsets_[p + 1] += 2;
+    offsets_[source + 1] = uint32_t(node_count);
+    offsets_[sink + 1] = uint32_t(node_count);
+    for (size_t i = 1; i < offsets_.size(); ++i) offsets_[i] += offsets_[i - 1];
+
+    const size_t arc_count = offsets_.back();
+    arc_head_.resize(arc_count);
+    arc_reverse_.resize(arc_count);
+    arc_capacity_.resize(arc_count);
+    next_arc_.assign(offsets_.begin(), offsets_.end() - 1);
+    auto add_arc_pair = [&](uint32_t u, uint32_t v) {
+      const uint32_t a = next_arc_[u]++;
+      const uint32_t b = next_arc_[v]++;
+      arc_head_[a] = v;
+      arc_head_[b] = u;
+      arc_reverse_[a] = b;
+      arc_reverse_[b] = a;
+      return a;
+    };
+    edge_arc_.resize(edges.size());
+    for (size_t e = 0; e < edges.size(); ++e) {
+      edge_arc_[e] = add_arc_pair(edges[e][0], edges[e][1]);
+    }
+    source_arc_.resize(node_count);
+    sink_arc_.resize(node_count);
+    for (uint32_t p = 0; p < node_count; ++p) {
+      source_arc_[p] = add_arc_pair(source, p);
+      sink_arc_[p] = add_arc_pair(p, sink);
+    }
+  }
+
+  double AlphaExpansion::max_flow(uint32_t source, uint32_t sink,
+                                  double epsilon) {
+    const size_t n = offsets_.size() - 1;
+    double flow = 0;
+    while (true) {
+      // level graph of the residual arcs
+      level_.assign(n, -1);
+      queue_.clear();
+      queue_.push_back(source);
+      level_[source] = 0;
+      for (size_t i = 0; i < queue_.size(); ++i) {
+        const uint32_t u = queue_[i];
+        for (uint32_t a = offsets_[u]; a < offsets_[u + 1]; ++a) {
+          const uint32_t v = arc_head_[a];
+          if (level_[v] < 0 && arc_capacity_[a] > epsilon) {
+            level_[v] = level_[u] + 1;
+            queue_.push_back(v);
+          }
+        }
+      }
+      if (level_[sink] < 0) return flow;
+
+      // blocking flow, by depth-first search for augmenting paths without
+      // recursion. next_arc_ skips the arcs that are known to be useless.
+      next_arc_.assign(offsets_.begin(), offsets_.end() - 1);
+      path_.clear();
+      uint32_t u = source;
+      while (true) {
+        if (u == sink) {
+          double f = std::numeric_limits<double>::max();
+          for (uint32_t a : path_) f = std::min(f, arc_capacity_[a]);
+          size_t saturated = path_.size();
+          for (size_t i = 0; i < path_.size(); ++i) {
+            const uint32_t a = path_[i];
+            arc_capacity_[a] -= f;
+            arc_capacity_[arc_reverse_[a]] += f;
+            if (saturated == path_.size() && !(arc_capacity_[a] > epsilon)) {
+              saturated = i;
+            }
+          }
+          flow += f;
+          // continue from the tail of the first saturated arc
+          path_.resize(saturated);
+          u = path_.empty() ? source : arc_head_[path_.back()];
+          continue;
+        }
+        uint32_t& a = next_arc_[u];
+        const uint32_t end = offsets_[u + 1];
+        while (a < end && !(arc_capacity_[a] > epsilon &&
+                            level_[arc_head_[a]] == level_[u] + 1)) {
+          ++a;
+        }
+        if (a < end) {
+          path_.push_back(a);
+          u = arc_head_[a];
+        } else {
+          if (u == source) break;
+          // dead end, no other path will use u in this phase
+          level_[u] = -1;
+          path_.pop_back();
+          u = path_.empty() ? source : arc_head_[path_.back()];
+        }
+      }
+    }
+  }
+
+  bool AlphaExpansion::expand(
+      size_t alpha, size_t label_count, const std::vector<double>& costs,
+      const std::vector<std::array<uint32_t, 2>>& edges,
+      const std::vector<double>& weights, const std::vector<size_t>& labels) {
+    // Binary problem of the move: x_p = 1 if p takes alpha. The cost of
+    // keeping its label is in the arc to the sink, the cost of taking alpha
+    // in the arc from the source, and a node takes alpha if it ends up on the
+    // sink side of the minimum cut (Kolmogorov and Zabih 2004).
+    const size_t node_count = labels.size();
+    std::fill(arc_capacity_.begin(), arc_capacity_.end(), 0.0);
+    expand_cost_.resize(node_count);
+    for (size_t p = 0; p < node_count; ++p) {
+      expand_cost_[p] = costs[p * label_count + alpha] -
+                        costs[p * label_count + labels[p]];
+    }
+    // pairwise term E(x_p, x_q) with E(0, 0) = A, E(0, 1) = B, E(1, 0) = C
+    // and E(1, 1) = 0. It is C - A for x_p = 1, -C for x_q = 1, and B + C - A
+    // for x_p = 0 and x_q = 1, which is not negative for the Potts model.
+    double total = 0;
+    for (size_t e = 0; e < edges.size(); ++e) {
+      const auto [p, q] = edges[e];
+      if (p == q) continue;
+      const double w = weights[e];
+      const double A = labels[p] != labels[q] ? w : 0;
+      const double B = labels[p] != alpha ? w : 0;
+      const double C = labels[q] != alpha ? w : 0;
+      expand_cost_[p] += C - A;
+      expand_cost_[q] -= C;
+      arc_capacity_[edge_arc_[e]] = B + C - A;
+      total += B + C - A;
+    }
+    for (size_t p = 0; p < node_count; ++p) {
+      const double d = expand_cost_[p];
+      if (d > 0) {
+        arc_capacity_[source_arc_[p]] = d;
+      } else {
+        arc_capacity_[sink_arc_[p]] = -d;
+      }
+      total += std::abs(d);
+    }
+
+    const uint32_t source = uint32_t(node_count);
+    max_flow(source, source + 1, total * 1e-14);
+
+    // the last level graph holds the nodes that the source can still reach
+    bool changed = false;
+    proposal_.assign(labels.begin(), labels.end());
+    for (size_t p = 0; p < node_count; ++p) {
+      if (level_[p] < 0 && labels[p] != alpha) {
+        proposal_[p] = alpha;
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  double AlphaExpansion::solve(
+      size_t node_count, size_t label_count, const std::vector<double>& costs,
+      const std::vector<std::array<uint32_t, 2>>& edges,
+      const std::vector<double>& weights, std::vector<size_t>& labels) {
+    labels.resize(node_count, 0);
+    build(node_count, edges);
+    double current = energy(label_count, costs, edges, weights, labels);
+    // like CGAL's alpha_expansion_graphcut, cycle over the labels until no
+    // expansion lowers the energy
+    bool success = true;
+    while (success) {
+      success = false;
+      for (size_t alpha = 0; alpha < label_count; ++alpha) {
+        if (!expand(alpha, label_count, costs, edges, weights, labels)) {
+          continue;
+        }
+        const double e = energy(label_count, costs, edges, weights, proposal_);
+        if (e < current - 1e-10 * std::abs(current)) {
+          labels.assign(proposal_.begin(), proposal_.end());
+          current = e;
+          success = true;
+        }
+      }
+    }
+    return current;
+  }
+
+}  // namespace roofer::reconstruction
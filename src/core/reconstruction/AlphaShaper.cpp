@@ -28,6 +28,12 @@
 #include <CGAL/Delaunay_triangulation_2.h>
 #include <CGAL/Projection_traits_xy_3.h>
 #include <CGAL/Triangulation_face_base_with_info_2.h>
+#include <CGAL/Triangulation_vertex_base_with_info_2.h>
+#include <CGAL/for_each.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
 
 namespace roofer::reconstruction {
   static const int EXTERIOR = -1, NEVER_VISITED = -2, HOLE = -3;
@@ -54,6 +60,20 @@ namespace roofer::reconstruction {
   typedef Alpha_shape_2::Vertex_circulator Vertex_circulator;
   typedef Alpha_shape_2::Edge_circulator Edge_circulator;
 
+  // One triangulation of the points of all planes. Each vertex stores the
+  // index of its point, and each finite face its index in the face arrays of
+  // SharedAlphaShapes (-1 for the infinite faces).
+  typedef CGAL::Triangulation_vertex_base_with_info_2<uint32_t, Gt> SharedVb;
+  typedef CGAL::Triangulation_face_base_with_info_2<int, Gt> SharedFb;
+  typedef CGAL::Triangulation_data_structure_2<SharedVb, SharedFb> SharedTds;
+  typedef CGAL::Delaunay_triangulation_2<Gt, SharedTds> SharedTriangulation_2;
+
+#ifdef CGAL_LINKED_WITH_TBB
+  typedef CGAL::Parallel_tag Concurrency_tag;
+#else
+  typedef CGAL::Sequential_tag Concurrency_tag;
+#endif
+
   class AlphaShapeRegionGrower {
     Alpha_shape_2& A;
     enum Mode {
@@ -297,9 +317,329 @@ namespace roofer::reconstruction {
     }
   };
 
+  // Alpha shapes of all planes of a building on one shared Delaunay
+  // triangulation of their points. A face belongs to a plane when its three
+  // vertices do, and it is in the alpha shape of that plane when its squared
+  // circumradius is at most alpha. Faces with vertices of different planes are
+  // never part of an alpha shape, so unlike the triangulations per plane the
+  // alpha shapes of two planes can not overlap. Points of different planes
+  // with the same xy coordinates end up as one vertex.
+  //
+  // The triangulation and the face arrays are only read after construction,
+  // and every face and point belongs to at most one plane, so the planes can
+  // be extracted concurrently.
+  class SharedAlphaShapes {
+    typedef SharedTriangulation_2::Face_handle Face_handle;
+    typedef SharedTriangulation_2::Vertex_handle Vertex_handle;
+
+    SharedTriangulation_2 dt;
+    vec3f coordinates;
+    std::vector<int> point_plane;
+    // smallest squared circumradius of the plane faces incident to a point
+    std::vector<double> point_radius;
+    // the finite faces, with their plane (-1 if their vertices are of
+    // different planes) and squared circumradius
+    std::vector<Face_handle> faces;
+    std::vector<int> face_plane;
+    std::vector<double> face_radius;
+    // the faces of each plane, and the index of each face in that list
+    std::vector<size_t> plane_face_offsets;
+    std::vector<size_t> plane_faces;
+    std::vector<uint32_t> face_local;
+
+    bool in_shape(Face_handle fh, int plane, double alpha) const {
+      const int f = fh->info();
+      return f >= 0 && face_plane[f] == plane && face_radius[f] <= alpha;
+    }
+
+    // Walk along the boundary of an alpha shape from the boundary edge
+    // (start, start_k), keeping the alpha shape on the left. This gives a CCW
+    // exterior ring and CW interior rings. At a vertex where the boundary
+    // touches itself the walk stays in the fan of faces it came from. Returns
+    // the signed area of the ring.
+    double extract_ring(Face_handle start, int start_k, int plane, double alpha,
+                        std::vector<char>& extracted, vec3f& ring) const {
+      double area = 0;
+      auto fh = start;
+      int k = start_k;
+      do {
+        extracted[3 * face_local[fh->info()] + k] = true;
+        const auto v = fh->vertex(dt.cw(k));
+        const auto& p = fh->vertex(dt.ccw(k))->point();
+        const auto& q = v->point();
+        ring.push_back({float(p.x()), float(p.y()), float(p.z())});
+        area += (p.x() * q.y() - q.x() * p.y()) / 2;
+        // turn around v to the next edge that has a face outside the shape
+        int j = dt.cw(k);
+        while (true) {
+          k = dt.cw(j);
+          auto neighbor = fh->neighbor(k);
+          if (!in_shape(neighbor, plane, alpha)) break;
+          fh = neighbor;
+          j = fh->index(v);
+        }
+      } while ((fh != start || k != start_k) &&
+               ring.size() <= extracted.size());
+      // rings are closed, like the ones of AlphaShapeRegionGrower
+      ring.push_back(ring.front());
+      return area;
+    }
+
+   public:
+    struct PlaneShape {
+      std::vector<LinearRing> rings;
+      // interior faces, as point indices
+      std::vector<std::array<uint32_t, 3>> triangles;
+    };
+
+    SharedAlphaShapes(const std::vector<const std::vector<Point>*>& planes) {
+      std::vector<std::pair<Point, uint32_t>> labelled_points;
+      for (size_t plane = 0; plane < planes.size(); ++plane) {
+        for (const auto& p : *planes[plane]) {
+          labelled_points.emplace_back(p, uint32_t(coordinates.size()));
+          coordinates.push_back({float(p.x()), float(p.y()), float(p.z())});
+          point_plane.push_back(int(plane));
+        }
+      }
+      dt.insert(labelled_points.begin(), labelled_points.end());
+
+      for (auto fh : dt.all_face_handles()) {
+        fh->info() = -1;
+      }
+      point_radius.assign(coordinates.size(),
+                          std::numeric_limits<double>::infinity());
+      plane_face_offsets.assign(planes.size() + 1, 0);
+      for (auto fh : dt.finite_face_handles()) {
+        fh->info() = int(faces.size());
+        int plane = point_plane[fh->vertex(0)->info()];
+        if (point_plane[fh->vertex(1)->info()] != plane ||
+            point_plane[fh->vertex(2)->info()] != plane) {
+          plane = -1;
+        }
+        const auto& p0 = fh->vertex(0)->point();
+        const auto& p1 = fh->vertex(1)->point();
+        const auto& p2 = fh->vertex(2)->point();
+        const double radius = CGAL::to_double(CGAL::squared_radius(
+            K::Point_2(p0.x(), p0.y()), K::Point_2(p1.x(), p1.y()),
+            K::Point_2(p2.x(), p2.y())));
+        faces.push_back(fh);
+        face_plane.push_back(plane);
+        face_radius.push_back(radius);
+        if (plane != -1) {
+          ++plane_face_offsets[plane + 1];
+          for (int i = 0; i < 3; ++i) {
+            auto& r = point_radius[fh->vertex(i)->info()];
+            r = std::min(r, radius);
+          }
+        }
+      }
+
+      for (size_t plane = 0; plane < planes.size(); ++plane) {
+        plane_face_offsets[plane + 1] += plane_face_offsets[plane];
+      }
+      plane_faces.resize(plane_face_offsets.back());
+      face_local.assign(faces.size(), 0);
+      auto next = plane_face_offsets;
+      for (size_t f = 0; f < faces.size(); ++f) {
+        if (face_plane[f] == -1) continue;
+        const auto plane = face_plane[f];
+        face_local[f] = uint32_t(next[plane] - plane_face_offsets[plane]);
+        plane_faces[next[plane]++] = f;
+      }
+    }
+
+    const arr3f& point(uint32_t index) const { return coordinates[index]; }
+    size_t point_count() const { return coordinates.size(); }
+
+    // The smallest alpha for which the alpha shape of a plane is one solid
+    // component that contains all its points, as find_optimal_alpha(1) of
+    // Alpha_shape_2. Points that are not a vertex of any face of the plane can
+    // not be part of its alpha shape and are ignored.
+    double optimal_alpha(int plane) const {
+      const auto first = plane_faces.begin() + plane_face_offsets[plane];
+      const size_t n = plane_face_offsets[plane + 1] - plane_face_offsets[plane];
+      if (n == 0) return 0;
+
+      double alpha_solid = 0;
+      for (size_t l = 0; l < n; ++l) {
+        for (int i = 0; i < 3; ++i) {
+          alpha_solid = std::max(
+              alpha_solid, point_radius[faces[first[l]]->vertex(i)->info()]);
+        }
+      }
+
+      // add the faces by increasing radius and count the components with a
+      // union-find
+      std::vector<uint32_t> order(n), parent(n);
+      std::iota(order.begin(), order.end(), 0);
+      std::iota(parent.begin(), parent.end(), 0);
+      std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return face_radius[first[a]] < face_radius[first[b]];
+      });
+      auto find = [&](uint32_t l) {
+        while (parent[l] != l) {
+          parent[l] = parent[parent[l]];
+          l = parent[l];
+        }
+        return l;
+      };
+      std::vector<char> added(n, false);
+      size_t component_cnt = 0;
+      for (size_t i = 0; i < n; ++i) {
+        const auto l = order[i];
+        const auto fh = faces[first[l]];
+        added[l] = true;
+        ++component_cnt;
+        for (int k = 0; k < 3; ++k) {
+          const int g = fh->neighbor(k)->info();
+          if (g < 0 || face_plane[g] != plane || !added[face_local[g]]) continue;
+          const auto a = find(l), b = find(face_local[g]);
+          if (a != b) {
+            parent[a] = b;
+            --component_cnt;
+          }
+        }
+        const double radius = face_radius[first[l]];
+        const bool last_of_radius =
+            i + 1 == n || face_radius[first[order[i + 1]]] != radius;
+        if (last_of_radius && radius >= alpha_solid && component_cnt == 1) {
+          return radius;
+        }
+      }
+      return face_radius[first[order.back()]];
+    }
+
+    PlaneShape extract(int plane, double alpha, bool extract_polygons) const {
+      PlaneShape shape;
+      const auto first = plane_faces.begin() + plane_face_offsets[plane];
+      const size_t n = plane_face_offsets[plane + 1] - plane_face_offsets[plane];
+
+      // flood fill the connected components of the alpha shape
+      std::vector<int> component(n, -1);
+      int component_cnt = 0;
+      std::vector<uint32_t> candidates;
+      for (size_t l = 0; l < n; ++l) {
+        if (component[l] != -1 || face_radius[first[l]] > alpha) continue;
+        component[l] = component_cnt;
+        candidates.push_back(uint32_t(l));
+        while (!candidates.empty()) {
+          const auto fh = faces[first[candidates.back()]];
+          candidates.pop_back();
+          shape.triangles.push_back({fh->vertex(0)->info(),
+                                     fh->vertex(1)->info(),
+                                     fh->vertex(2)->info()});
+          for (int k = 0; k < 3; ++k) {
+            const auto neighbor = fh->neighbor(k);
+            if (!in_shape(neighbor, plane, alpha)) continue;
+            const auto nl = face_local[neighbor->info()];
+            if (component[nl] == -1) {
+              component[nl] = component_cnt;
+              candidates.push_back(nl);
+            }
+          }
+        }
+        ++component_cnt;
+      }
+      if (!extract_polygons) return shape;
+
+      // every boundary edge is on exactly one ring, the CCW ring of a
+      // component is its exterior
+      std::vector<LinearRing> rings(component_cnt);
+      std::vector<double> exterior_area(component_cnt, 0);
+      std::vector<char> extracted(3 * n, false);
+      for (size_t l = 0; l < n; ++l) {
+        if (component[l] == -1) continue;
+        const auto fh = faces[first[l]];
+        for (int k = 0; k < 3; ++k) {
+          if (extracted[3 * l + k] || in_shape(fh->neighbor(k), plane, alpha))
+            continue;
+          vec3f ring;
+          const double area =
+              extract_ring(fh, k, plane, alpha, extracted, ring);
+          auto& region = rings[component[l]];
+          if (area > exterior_area[component[l]]) {
+            exterior_area[component[l]] = area;
+            static_cast<vec3f&>(region) = std::move(ring);
+          } else if (area < 0) {
+            region.interior_rings().push_back(std::move(ring));
+          }
+        }
+      }
+      for (auto& ring : rings) {
+        if (ring.size() > 2) shape.rings.push_back(std::move(ring));
+      }
+      return shape;
+    }
+  };
+
   class AlphaShaper : public AlphaShaperInterface {
+    void compute_shared(const IndexedPlanesWithPoints& pts_per_roofplane,
+                        const AlphaShaperConfig& cfg) {
+      std::vector<int> plane_ids;
+      std::vector<const std::vector<Point>*> plane_points;
+      for (auto& [plane_id, plane] : pts_per_roofplane) {
+        if (plane_id == -1 || plane.second.size() < 3) continue;
+        plane_ids.push_back(plane_id);
+        plane_points.push_back(&plane.second);
+      }
+      if (plane_points.empty()) return;
+
+      SharedAlphaShapes shapes(plane_points);
+      std::vector<SharedAlphaShapes::PlaneShape> plane_shapes(
+          plane_points.size());
+      auto extract = [&](size_t plane) {
+        double alpha = cfg.alpha;
+        if (cfg.optimal_alpha) {
+          alpha = shapes.optimal_alpha(int(plane));
+          if (cfg.clamp_optimal_alpha) {
+            alpha = std::max(alpha, double(cfg.alpha));
+          }
+        }
+        plane_shapes[plane] =
+            shapes.extract(int(plane), alpha, cfg.extract_polygons);
+        return true;
+      };
+      // only the large planes are worth a task of their own
+      std::vector<size_t> large_planes;
+      for (size_t plane = 0; plane < plane_points.size(); ++plane) {
+        if (plane_points[plane]->size() >= size_t(cfg.parallel_plane_points)) {
+          large_planes.push_back(plane);
+        } else {
+          extract(plane);
+        }
+      }
+      CGAL::for_each<Concurrency_tag>(large_planes, extract);
+
+      // gather in plane order, so that the output does not depend on the
+      // scheduling, and keep only the vertices that are used by a triangle
+      std::vector<uint32_t> vertex_index(shapes.point_count(),
+                                         std::numeric_limits<uint32_t>::max());
+      for (size_t plane = 0; plane < plane_shapes.size(); ++plane) {
+        for (auto& ring : plane_shapes[plane].rings) {
+          alpha_rings.push_back(std::move(ring));
+          roofplane_ids.push_back(plane_ids[plane]);
+        }
+        for (const auto& triangle : plane_shapes[plane].triangles) {
+          std::array<uint32_t, 3> indexed;
+          for (int i = 0; i < 3; ++i) {
+            auto& index = vertex_index[triangle[i]];
+            if (index == std::numeric_limits<uint32_t>::max()) {
+              index = uint32_t(alpha_triangle_mesh.vertices.size());
+              alpha_triangle_mesh.vertices.push_back(shapes.point(triangle[i]));
+            }
+            indexed[i] = index;
+          }
+          alpha_triangle_mesh.triangles.push_back(indexed);
+        }
+      }
+    }
+
     void compute(const IndexedPlanesWithPoints& pts_per_roofplane,
                  AlphaShaperConfig cfg) override {
+      if (cfg.shared_triangulation) {
+        compute_shared(pts_per_roofplane, cfg);
+        return;
+      }
       std::cout << std::fixed << std::setprecision(4);
 
       PointCollection edge_points;
@@ -55,6 +55,20 @@ namespace roofer::reconstruction {
       // }
     }
   }
+  void arrangementface_to_rings(Face_handle face, std::vector<vec2f>& rings) {
+    rings.clear();
+    rings.emplace_back();
+    arrangementface_to_polygon(face, rings.back());
+    for (auto ccb = face->inner_ccbs_begin(); ccb != face->inner_ccbs_end();
+         ++ccb) {
+      auto& ring = rings.emplace_back();
+      auto he = *ccb;
+      do {
+        ring.push_back({float(CGAL::to_double(he->source()->point().x())),
+                        float(CGAL::to_double(he->source()->point().y()))});
+      } while (++he != *ccb);
+    }
+  }
   bool arrangementface_to_polygon(Face_handle face, roofer::LinearRing& polygon,
                                   double h) {
     // if(extract_face){ // ie it is a face on the interior of the footprint
@@ -252,6 +266,12 @@ namespace roofer::reconstruction {
   //   }
   // }
 
+  void arr_clear_optimiser_data(Arrangement_2& arr) {
+    for (auto& face : arr.face_handles()) {
+      std::vector<double>().swap(face->data().vertex_label_cost);
+    }
+  }
+
   void arr_dissolve_fp(Arrangement_2& arr, bool inside, bool outside) {
     {
       std::vector<Arrangement_2::Halfedge_handle> to_remove;
@@ -19,8 +19,16 @@
 // Author(s):
 // Ravi Peters
 
+#include <array>
+#include <list>
+#include <queue>
+#include <set>
+#include <unordered_set>
+
 #include <CGAL/Polygon_2.h>
 #include <CGAL/Polygon_with_holes_2.h>
+#include <CGAL/Snap_rounding_2.h>
+#include <CGAL/Snap_rounding_traits_2.h>
 
 #include <roofer/reconstruction/ArrangementBase.hpp>
 #include <roofer/reconstruction/ArrangementBuilder.hpp>
@@ -29,6 +37,8 @@
 namespace roofer::reconstruction {
 
   class ArrangementBuilder : public ArrangementBuilderInterface {
+    typedef CGAL::Polygon_with_holes_2<EPECK> Polygon_with_holes_2;
+
     Arrangement_2::Vertex_handle arr_cross_edge(
         Arrangement_2& arr, Segment_2& segment,
         Arrangement_2::Halfedge_handle& edge, const double& dist_threshold) {
@@ -265,6 +275,14 @@ namespace roofer::reconstruction {
       // }
     }
 
+    Segment_2 extend_segment(const Segment_2& segment,
+                             const float& extension) {
+      auto lv = segment.to_vector();
+      lv = lv / CGAL::sqrt(CGAL::to_double(lv.squared_length()));
+      return Segment_2(segment.source() - lv * extension,
+                       segment.target() + lv * extension);
+    }
+
     void arr_extend_insert_segment(Arrangement_2& arr, Segment_2 segment,
                                    const float& extension) {
       auto lv = segment.to_vector();
@@ -284,6 +302,162 @@ namespace roofer::reconstruction {
                             segment.target() + lv * extension));
     }
 
+    // Inserts the segments after iterated snap rounding them on a grid with
+    // the given pixel size. The rounded segments only meet in their
+    // endpoints, which are pixel centres, so they are inserted without
+    // computing any intersections and every point of the arrangement is
+    // constructed from a pair of doubles. The segments are inserted in the
+    // given order, and the observer is switched to hole mode for the
+    // segments in [hole_begin, hole_end).
+    void arr_insert_snap_rounded(Arrangement_2& arr, Face_split_observer& obs,
+                                 const std::vector<Segment_2>& segments,
+                                 size_t hole_begin, size_t hole_end,
+                                 double pixel_size) {
+      typedef CGAL::Snap_rounding_traits_2<EPECK> Snap_rounding_traits;
+      typedef std::list<Point_2> Polyline_2;
+
+      // one polyline for each input segment, in the input order
+      std::list<Polyline_2> polylines;
+      CGAL::snap_rounding_2<Snap_rounding_traits>(
+          segments.begin(), segments.end(), polylines, pixel_size, true,
+          false);
+
+      // segments that are rounded onto the same pixels overlap exactly, and
+      // are inserted only once
+      std::set<std::array<double, 4>> inserted;
+      size_t i = 0;
+      for (auto& polyline : polylines) {
+        obs.set_hole_mode(i >= hole_begin && i < hole_end);
+        ++i;
+        std::array<double, 2> prev;
+        bool first = true;
+        for (auto& p : polyline) {
+          std::array<double, 2> cur = {CGAL::to_double(p.x()),
+                                       CGAL::to_double(p.y())};
+          if (!first && cur != prev) {
+            auto [a, b] = std::minmax(prev, cur);
+            if (inserted.insert({a[0], a[1], b[0], b[1]}).second) {
+              CGAL::insert_non_intersecting_curve(
+                  arr, Segment_2(Point_2(a[0], a[1]), Point_2(b[0], b[1])));
+            }
+          }
+          prev = cur;
+          first = false;
+        }
+      }
+      obs.set_hole_mode(false);
+    }
+
+    // Assigns in_footprint and is_footprint_hole to all faces in one pass.
+    // The faces are visited from the unbounded face, and crossing an edge
+    // that lies on an edge of the footprint boundary or of a hole toggles
+    // being inside of it.
+    void arr_label_footprint(Arrangement_2& arr,
+                             const std::vector<Segment_2>& outer_edges,
+                             const std::vector<Segment_2>& hole_edges) {
+      struct State {
+        bool in_outer = false;
+        bool in_hole = false;
+      };
+      auto lies_on = [](const std::vector<Segment_2>& edges,
+                        const Halfedge_handle& he) {
+        auto& s = he->source()->point();
+        auto& t = he->target()->point();
+        for (auto& e : edges) {
+          if (e.has_on(s) && e.has_on(t)) return true;
+        }
+        return false;
+      };
+
+      std::unordered_set<Face_handle> visited;
+      std::queue<std::pair<Face_handle, State>> queue;
+      for (auto face = arr.unbounded_faces_begin();
+           face != arr.unbounded_faces_end(); ++face) {
+        visited.insert(face);
+        queue.push({face, State()});
+      }
+      auto visit_ccb = [&](Ccb_halfedge_circulator first, State state) {
+        auto he = first;
+        do {
+          auto neighbour = he->twin()->face();
+          if (!he->is_fictitious() && visited.insert(neighbour).second) {
+            State next = state;
+            if (lies_on(outer_edges, he)) next.in_outer = !next.in_outer;
+            if (lies_on(hole_edges, he)) next.in_hole = !next.in_hole;
+            queue.push({neighbour, next});
+          }
+        } while (++he != first);
+      };
+      while (!queue.empty()) {
+        auto [face, state] = queue.front();
+        queue.pop();
+        face->data().in_footprint = state.in_outer && !state.in_hole;
+        face->data().is_footprint_hole = state.in_hole;
+        if (face->has_outer_ccb()) visit_ccb(face->outer_ccb(), state);
+        for (auto ccb = face->inner_ccbs_begin(); ccb != face->inner_ccbs_end();
+             ++ccb) {
+          visit_ccb(*ccb, state);
+        }
+      }
+    }
+
+    // Inserts the footprint edges and the lines in one aggregated sweep, and
+    // labels the faces afterwards. The lines are first clipped to the bounding
+    // box of the extended footprint edges, since the parts outside of it can
+    // only split faces outside the footprint.
+    void arr_insert_batch(Arrangement_2& arr,
+                          const Polygon_with_holes_2& footprint,
+                          const std::vector<EPECK::Segment_2>& lines,
+                          bool insert_lines, const float& extension) {
+      std::vector<X_monotone_curve_2> curves;
+      std::vector<Segment_2> outer_edges, hole_edges;
+      CGAL::Bbox_2 bbox;
+      auto& outer = footprint.outer_boundary();
+      for (auto e = outer.edges_begin(); e != outer.edges_end(); ++e) {
+        auto extended = extend_segment(*e, extension);
+        bbox += extended.bbox();
+        curves.emplace_back(extended);
+        outer_edges.push_back(*e);
+      }
+      for (auto hole = footprint.holes_begin(); hole != footprint.holes_end();
+           ++hole) {
+        // holes that touch the footprint boundary are ignored, like in
+        // Face_split_observer
+        bool touches_outer = false;
+        for (auto v = hole->vertices_begin(); v != hole->vertices_end(); ++v) {
+          for (auto& e : outer_edges) touches_outer |= e.has_on(*v);
+        }
+        for (auto e = hole->edges_begin(); e != hole->edges_end(); ++e) {
+          auto extended = extend_segment(*e, extension);
+          bbox += extended.bbox();
+          curves.emplace_back(extended);
+          if (!touches_outer) hole_edges.push_back(*e);
+        }
+      }
+
+      if (insert_lines) {
+        const EPECK::Iso_rectangle_2 rect(Point_2(bbox.xmin(), bbox.ymin()),
+                                          Point_2(bbox.xmax(), bbox.ymax()));
+        for (auto& s : lines) {
+          if (s.is_degenerate()) continue;
+          auto b = s.bbox();
+          if (b.xmin() >= bbox.xmin() && b.ymin() >= bbox.ymin() &&
+              b.xmax() <= bbox.xmax() && b.ymax() <= bbox.ymax()) {
+            curves.emplace_back(s);
+            continue;
+          }
+          auto result = CGAL::intersection(s, rect);
+          if (!result) continue;
+          if (auto clipped = std::get_if<EPECK::Segment_2>(&*result)) {
+            if (!clipped->is_degenerate()) curves.emplace_back(*clipped);
+          }
+        }
+      }
+
+      CGAL::insert(arr, curves.begin(), curves.end());
+      arr_label_footprint(arr, outer_edges, hole_edges);
+    }
+
    public:
     void compute(Arrangement_2& arrangement, LinearRing& footprint_,
                  std::vector<EPECK::Segment_2>& input_edges,
@@ -315,8 +489,38 @@ namespace roofer::reconstruction {
 
       // insert footprint segments
       // Arrangement_2 arrangement;
+      const bool batch = !cfg.snap_rounding && !cfg.incremental_insert &&
+                         !cfg.insert_with_snap;
       Face_split_observer obs(arrangement);
-      {
+      if (batch) {
+        // the faces are labelled after the sweep
+        obs.detach();
+        arr_insert_batch(arrangement, footprint, input_edges, cfg.insert_lines,
+                         cfg.footprint_extension);
+      } else if (cfg.snap_rounding) {
+        // the footprint edges and the lines are rounded together, so that
+        // the rounded segments do not cross each other
+        std::vector<Segment_2> segments;
+        for (auto e = footprint.outer_boundary().edges_begin();
+             e != footprint.outer_boundary().edges_end(); ++e) {
+          segments.push_back(extend_segment(*e, cfg.footprint_extension));
+        }
+        const size_t hole_begin = segments.size();
+        for (auto hole = footprint.holes_begin(); hole != footprint.holes_end();
+             ++hole) {
+          for (auto e = hole->edges_begin(); e != hole->edges_end(); ++e) {
+            segments.push_back(extend_segment(*e, cfg.footprint_extension));
+          }
+        }
+        const size_t hole_end = segments.size();
+        if (cfg.insert_lines) {
+          for (auto& s : input_edges) {
+            if (!s.is_degenerate()) segments.push_back(s);
+          }
+        }
+        arr_insert_snap_rounded(arrangement, obs, segments, hole_begin,
+                                hole_end, cfg.snap_rounding_pixel_size);
+      } else {
         // insert(arr_base, footprint.outer_boundary().edges_begin(),
         // footprint.outer_boundary().edges_end()); arr_insert_polygon(arr_base,
         // footprint); insert_non_intersecting_curves(arr_base,
@@ -338,7 +542,7 @@ namespace roofer::reconstruction {
         obs.set_hole_mode(false);
       }
 
-      if (cfg.insert_lines) {
+      if (cfg.insert_lines && !cfg.snap_rounding && !batch) {
         typedef std::pair<Point_2, Point_2> PointPair;
 
         int arr_complexity = input_edges.size();
@@ -19,8 +19,12 @@
 // Author(s):
 // Ravi Peters
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <roofer/reconstruction/ArrangementBase.hpp>
 #include <roofer/reconstruction/ArrangementDissolver.hpp>
+#include <roofer/reconstruction/FaceLabelRaster.hpp>
 
 namespace roofer::reconstruction {
 
@@ -39,6 +43,60 @@ namespace roofer::reconstruction {
       }
     };
 
+    size_t find_root(std::vector<size_t>& parent, size_t i) {
+      while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+      }
+      return i;
+    }
+
+    // Joins the sets of two footprint faces, by their v_index, when they are
+    // merged.
+    class Face_union_observer : public CGAL::Arr_observer<Arrangement_2> {
+      std::vector<size_t>& parent_;
+
+     public:
+      Face_union_observer(Arrangement_2& arrangement,
+                          std::vector<size_t>& parent)
+          : CGAL::Arr_observer<Arrangement_2>(arrangement), parent_(parent) {}
+
+      void before_merge_face(Face_handle remaining_face,
+                             Face_handle discarded_face,
+                             Halfedge_handle) override {
+        if (!remaining_face->data().in_footprint ||
+            !discarded_face->data().in_footprint) {
+          return;
+        }
+        const size_t remaining =
+            find_root(parent_, remaining_face->data().v_index);
+        const size_t discarded =
+            find_root(parent_, discarded_face->data().v_index);
+        parent_[discarded] = remaining;
+      }
+    };
+
+    // Sets the elevation percentiles of a face from the heights of its cells,
+    // which are reordered.
+    void set_elevations(FaceInfo& data, std::vector<float>& heights) {
+      const size_t last = heights.size() - 1;
+      auto index = [last](double fraction) {
+        return size_t(std::floor(fraction * float(last)));
+      };
+      const size_t i50 = index(0.5), i70 = index(0.7), i97 = index(0.97);
+      // each selection leaves the lower heights in front of it, where the
+      // next lower percentile is selected
+      auto begin = heights.begin();
+      std::nth_element(begin, begin + i97, heights.end());
+      std::nth_element(begin, begin + i70, begin + i97);
+      std::nth_element(begin, begin + i50, begin + i70);
+      data.elevation_50p = heights[i50];
+      data.elevation_70p = heights[i70];
+      data.elevation_97p = heights[i97];
+      data.elevation_min = *std::min_element(begin, begin + i50 + 1);
+      data.elevation_max = *std::max_element(begin + i97, heights.end());
+    }
+
     Polygon_with_holes_2 face_polygon(Face_handle face) {
       Polygon_2 outer;
       auto edge = face->outer_ccb();
@@ -161,6 +219,150 @@ namespace roofer::reconstruction {
   }  // namespace
 
   class ArrangementDissolver : public ArrangementDissolverInterface {
+    // The footprint faces, by v_index, before any face is dissolved. The
+    // heights of the cells of face i are heights_[offsets_[i]] up to
+    // heights_[offsets_[i + 1]], with the data_counts_[i] cells that have
+    // data first.
+    std::vector<Face_handle> faces_;
+    std::vector<size_t> offsets_;
+    std::vector<size_t> data_counts_;
+    std::vector<float> heights_;
+    // union-find of the faces that were merged since, and the faces of each
+    // set
+    std::vector<size_t> parent_;
+    std::vector<size_t> member_offsets_;
+    std::vector<size_t> members_;
+    // scratch buffers
+    std::vector<size_t> next_;
+    std::vector<float> face_heights_;
+    std::vector<float> fill_heights_;
+    std::vector<vec2f> rings_;
+
+    // Appends the heights of the cells of a face that have data to heights,
+    // with the cells of the former rasterise_polygon(), and returns the
+    // number of cells. If fill_heights is given the cells without data get
+    // the height of the plane of the face at the cell centre in there.
+    size_t scan_face_cells(Face_handle face,
+                           const RasterTools::Raster& heightfield,
+                           std::vector<float>& heights,
+                           std::vector<float>* fill_heights) {
+      const float nodata = float(heightfield.noDataVal_);
+      const auto& plane = face->data().plane;
+      size_t cell_count = 0;
+      arrangementface_to_rings(face, rings_);
+      heightfield.scan_ring_row_edges(
+          rings_.front(), [&](size_t row, size_t col_begin, size_t col_end) {
+            auto cells = heightfield.row(row);
+            cell_count += col_end - col_begin;
+            for (size_t col = col_begin; col < col_end; ++col) {
+              if (cells[col] != nodata) {
+                heights.push_back(cells[col]);
+              } else if (fill_heights) {
+                auto p = heightfield.getPointFromRasterCoords(col, row);
+                fill_heights->push_back(-plane.a() / plane.c() * p[0] -
+                                        plane.b() / plane.c() * p[1] -
+                                        plane.d() / plane.c());
+              }
+            }
+          });
+      return cell_count;
+    }
+
+    // Collects the heights of the cells of all footprint faces, either face
+    // by face or from one raster of face labels. If fill_from_plane is set
+    // the cells without data get the height of the plane of their face at
+    // the cell centre, after the cells with data.
+    void collect_face_heights(Arrangement_2& arr,
+                              const RasterTools::Raster& heightfield,
+                              bool fill_from_plane, bool face_label_raster) {
+      faces_.clear();
+      for (auto face : arr.face_handles()) {
+        if (!face->data().in_footprint) continue;
+        face->data().v_index = faces_.size();
+        faces_.push_back(face);
+      }
+      const size_t face_count = faces_.size();
+      parent_.resize(face_count);
+      std::iota(parent_.begin(), parent_.end(), 0);
+
+      if (!face_label_raster) {
+        // the faces are rasterised again for the final elevations, so the
+        // heights are only needed to dissolve the step edges, which is when
+        // they are filled from the planes
+        if (!fill_from_plane) return;
+        heights_.clear();
+        offsets_.assign(1, 0);
+        data_counts_.resize(face_count);
+        for (size_t i = 0; i < face_count; ++i) {
+          fill_heights_.clear();
+          const size_t begin = heights_.size();
+          scan_face_cells(faces_[i], heightfield, heights_, &fill_heights_);
+          data_counts_[i] = heights_.size() - begin;
+          heights_.insert(heights_.end(), fill_heights_.begin(),
+                          fill_heights_.end());
+          offsets_.push_back(heights_.size());
+        }
+        return;
+      }
+
+      FaceLabelRaster face_raster(heightfield);
+      for (auto face : faces_) {
+        arrangementface_to_rings(face, rings_);
+        face_raster.add_face(rings_, int32_t(face->data().v_index));
+      }
+      const auto& labels = face_raster.vals_;
+      const auto& vals = heightfield.vals_;
+      const float nodata = float(heightfield.noDataVal_);
+
+      offsets_.assign(face_count + 1, 0);
+      data_counts_.assign(face_count, 0);
+      for (size_t cell = 0; cell < labels.size(); ++cell) {
+        if (labels[cell] == FaceLabelRaster::no_face) continue;
+        ++offsets_[labels[cell] + 1];
+        if (vals[cell] != nodata) ++data_counts_[labels[cell]];
+      }
+      std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+
+      heights_.resize(offsets_.back());
+      next_.resize(2 * face_count);
+      for (size_t i = 0; i < face_count; ++i) {
+        next_[2 * i] = offsets_[i];
+        next_[2 * i + 1] = offsets_[i] + data_counts_[i];
+      }
+      for (size_t row = 0; row < face_raster.dimy_; ++row) {
+        for (size_t col = 0; col < face_raster.dimx_; ++col) {
+          const size_t cell = row * face_raster.dimx_ + col;
+          const int32_t label = labels[cell];
+          if (label == FaceLabelRaster::no_face) continue;
+          if (vals[cell] != nodata) {
+            heights_[next_[2 * label]++] = vals[cell];
+          } else if (fill_from_plane) {
+            auto p = heightfield.getPointFromRasterCoords(col, row);
+            auto& plane = faces_[label]->data().plane;
+            heights_[next_[2 * label + 1]++] =
+                -plane.a() / plane.c() * p[0] - plane.b() / plane.c() * p[1] -
+                plane.d() / plane.c();
+          }
+        }
+      }
+    }
+
+    // Groups the collected faces by the face that they were merged into.
+    void group_merged_faces() {
+      const size_t face_count = faces_.size();
+      member_offsets_.assign(face_count + 1, 0);
+      for (size_t i = 0; i < face_count; ++i) {
+        ++member_offsets_[find_root(parent_, i) + 1];
+      }
+      std::partial_sum(member_offsets_.begin(), member_offsets_.end(),
+                       member_offsets_.begin());
+      next_.assign(member_offsets_.begin(), member_offsets_.end() - 1);
+      members_.resize(face_count);
+      for (size_t i = 0; i < face_count; ++i) {
+        members_[next_[find_root(parent_, i)]++] = i;
+      }
+    }
+
    public:
     void compute(Arrangement_2& arr, const RasterTools::Raster& heightfield,
                  const ElevationProvider& elevation_provider,
@@ -170,56 +372,48 @@ namespace roofer::reconstruction {
         arr_dissolve_seg_edges(arr);
       }
 
-      clip_roof_faces_to_terrain(arr, elevation_provider);
+      if (cfg.clip_to_terrain) {
+        clip_roof_faces_to_terrain(arr, elevation_provider);
+      }
 
       if (cfg.dissolve_all_interior) {
         arr_dissolve_fp(arr, true, false);
       }
 
+      // with the face label raster a merged face takes the cells of its
+      // parts, so nothing is rasterised after a merge
+      collect_face_heights(arr, heightfield, cfg.dissolve_step_edges,
+                           cfg.face_label_raster);
+      Face_union_observer union_obs(arr, parent_);
+
       if (cfg.dissolve_step_edges) {
         // compute elevations so we can do perform the generalisation lod2.2 ->
         // lod1.3
-        for (auto face : arr.face_handles()) {
-          if (face->data().in_footprint) {
+        for (auto face : faces_) {
+          const size_t i = face->data().v_index;
+          const size_t datasize = offsets_[i + 1] - offsets_[i];
+          if (datasize ==
+              0) {  // polygon was too small to yield any pixels/height_points
             LinearRing polygon;
             arrangementface_to_polygon(face, polygon);
-
-            auto height_points = heightfield.rasterise_polygon(polygon, true);
-            size_t datasize = height_points.size(), data_cnt = 0;
-            if (datasize ==
-                0) {  // polygon was too small to yield any pixels/height_points
-              auto& pz = polygon[0][2];
-              face->data().elevation_50p = pz;
-              face->data().elevation_70p = pz;
-              face->data().elevation_97p = pz;
-              face->data().elevation_min = pz;
-              face->data().elevation_max = pz;
-              face->data().data_coverage = 0;
-            } else {
-              auto& plane = face->data().plane;
-              // fall back to elevation based on the plane of this face. This is
-              // more reliable in case the data_coverage is limited
-              for (auto& p : height_points) {
-                if (p[2] != heightfield.noDataVal_)
-                  data_cnt++;
-                else
-                  p[2] = -plane.a() / plane.c() * p[0] -
-                         plane.b() / plane.c() * p[1] - plane.d() / plane.c();
-              }
-              std::sort(height_points.begin(), height_points.end(),
-                        [](auto& p1, auto& p2) { return p1[2] < p2[2]; });
-              int elevation_id = std::floor(0.5 * float(datasize - 1));
-              face->data().elevation_50p = height_points[elevation_id][2];
-              elevation_id = std::floor(0.7 * float(datasize - 1));
-              face->data().elevation_70p = height_points[elevation_id][2];
-              elevation_id = std::floor(0.97 * float(datasize - 1));
-              face->data().elevation_97p = height_points[elevation_id][2];
-              face->data().elevation_min = height_points[0][2];
-              face->data().elevation_max = height_points[datasize - 1][2];
-              face->data().data_coverage = float(data_cnt) / float(datasize);
-            }
-            face->data().pixel_count = datasize;
+            auto& pz = polygon[0][2];
+            face->data().elevation_50p = pz;
+            face->data().elevation_70p = pz;
+            face->data().elevation_97p = pz;
+            face->data().elevation_min = pz;
+            face->data().elevation_max = pz;
+            face->data().data_coverage = 0;
+          } else {
+            // cells without data fall back to the elevation of the plane of
+            // this face. This is more reliable in case the data_coverage is
+            // limited
+            face_heights_.assign(heights_.begin() + offsets_[i],
+                                 heights_.begin() + offsets_[i + 1]);
+            set_elevations(face->data(), face_heights_);
+            face->data().data_coverage =
+                float(data_counts_[i]) / float(datasize);
           }
+          face->data().pixel_count = datasize;
         }
 
         Face_merge_observer obs(arr);
@@ -259,53 +453,38 @@ namespace roofer::reconstruction {
       }
 
       // compute final data_area and elevation stats for each face
-      std::vector<float> all_elevations;
+      if (cfg.face_label_raster) group_merged_faces();
       for (auto face : arr.face_handles()) {
         if (face->data().in_footprint) {
-          LinearRing polygon;
-          arrangementface_to_polygon(face, polygon);
-
-          auto height_points = heightfield.rasterise_polygon(polygon, true);
-          size_t data_cnt = 0;
-          bool skip_face = height_points.size() == 0;
-          {
-            // auto& plane = face->data().plane;
-            // compute elevations based on the assigned plane on this face
-            std::vector<arr3f*> pts;
-            if (!skip_face) {
-              for (auto& p : height_points) {
-                if (p[2] != heightfield.noDataVal_) {
-                  data_cnt++;
-                  pts.push_back(&p);
-                  all_elevations.push_back(p[2]);
-                };
-              }
+          size_t cell_count = 0;
+          face_heights_.clear();
+          if (!cfg.face_label_raster) {
+            cell_count =
+                scan_face_cells(face, heightfield, face_heights_, nullptr);
+          } else {
+            const size_t root = find_root(parent_, face->data().v_index);
+            for (size_t m = member_offsets_[root];
+                 m < member_offsets_[root + 1]; ++m) {
+              const size_t i = members_[m];
+              auto begin = heights_.begin() + offsets_[i];
+              face_heights_.insert(face_heights_.end(), begin,
+                                   begin + data_counts_[i]);
+              cell_count += offsets_[i + 1] - offsets_[i];
             }
-            if (data_cnt == 0) {
-              auto& pz = polygon[0][2];
-              face->data().elevation_50p = heightfield.noDataVal_;
-              face->data().elevation_70p = heightfield.noDataVal_;
-              face->data().elevation_97p = heightfield.noDataVal_;
-              face->data().elevation_min = heightfield.noDataVal_;
-              face->data().elevation_max = heightfield.noDataVal_;
-              face->data().data_coverage = 0;
-            } else {
-              std::sort(pts.begin(), pts.end(),
-                        [](auto& p1, auto& p2) { return (*p1)[2] < (*p2)[2]; });
-              size_t datasize = pts.size();
-              int elevation_id = std::floor(0.5 * float(datasize - 1));
-              face->data().elevation_50p = (*(pts[elevation_id]))[2];
-              elevation_id = std::floor(0.7 * float(datasize - 1));
-              face->data().elevation_70p = (*(pts[elevation_id]))[2];
-              elevation_id = std::floor(0.97 * float(datasize - 1));
-              face->data().elevation_97p = (*(pts[elevation_id]))[2];
-              face->data().elevation_min = (*(pts[0]))[2];
-              face->data().elevation_max = (*(pts[datasize - 1]))[2];
-              face->data().data_coverage =
-                  float(data_cnt) / float(height_points.size());
-            }
-            face->data().pixel_count = data_cnt;
           }
+          const size_t data_cnt = face_heights_.size();
+          if (data_cnt == 0) {
+            face->data().elevation_50p = heightfield.noDataVal_;
+            face->data().elevation_70p = heightfield.noDataVal_;
+            face->data().elevation_97p = heightfield.noDataVal_;
+            face->data().elevation_min = heightfield.noDataVal_;
+            face->data().elevation_max = heightfield.noDataVal_;
+            face->data().data_coverage = 0;
+          } else {
+            set_elevations(face->data(), face_heights_);
+            face->data().data_coverage = float(data_cnt) / float(cell_count);
+          }
+          face->data().pixel_count = data_cnt;
         }
       }
 
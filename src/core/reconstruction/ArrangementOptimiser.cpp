@@ -26,8 +26,10 @@
 #include <CGAL/property_map.h>
 
 #include <algorithm>
+#include <roofer/reconstruction/AlphaExpansion.hpp>
 #include <roofer/reconstruction/ArrangementBase.hpp>
 #include <roofer/reconstruction/ArrangementOptimiser.hpp>
+#include <roofer/reconstruction/FaceLabelRaster.hpp>
 #include <vector>
 
 namespace roofer::reconstruction {
@@ -214,7 +216,95 @@ namespace roofer::reconstruction {
     }
   };
 
+  // Graph-cut implementation for a graph with node_count faces and
+  // edge_count edges. The in-tree solver has no setup cost and reuses its
+  // buffers, which matters most for the graphs of up to a few thousand faces
+  // of almost all buildings. The Boykov-Kolmogorov max-flow of the MaxFlow
+  // implementation reuses its search trees between augmenting paths, and
+  // scales better to the largest graphs. Only used when graph_cut_impl is
+  // -1; the size limit is a first guess that has not been tuned.
+  inline int select_graph_cut_impl(size_t node_count, size_t edge_count) {
+    constexpr size_t max_in_tree_graph_size = 20000;
+    return node_count + edge_count <= max_in_tree_graph_size ? 3 : 2;
+  }
+
+  // The in-tree solver and its input, kept per thread so that the buffers
+  // are reused for all buildings that a worker reconstructs.
+  struct InTreeGraphCut {
+    AlphaExpansion solver;
+    std::vector<double> costs;
+    std::vector<std::array<uint32_t, 2>> edges;
+    std::vector<double> weights;
+    std::vector<size_t> labels;
+
+    double solve(const std::vector<Face_handle>& faces,
+                 const std::vector<Halfedge_handle>& halfedges,
+                 size_t label_count) {
+      costs.clear();
+      labels.clear();
+      for (auto& face : faces) {
+        auto& label_cost = face->data().vertex_label_cost;
+        costs.insert(costs.end(), label_cost.begin(), label_cost.end());
+        labels.push_back(face->data().label);
+      }
+      edges.clear();
+      weights.clear();
+      for (auto& he : halfedges) {
+        edges.push_back({uint32_t(he->face()->data().v_index),
+                         uint32_t(he->twin()->face()->data().v_index)});
+        weights.push_back(he->data().edge_weight);
+      }
+      double result = solver.solve(faces.size(), label_count, costs, edges,
+                                   weights, labels);
+      for (auto& face : faces) {
+        face->data().label = labels[face->data().v_index];
+      }
+      return result;
+    }
+  };
+
   class ArrangementOptimiser : public ArrangementOptimiserInterface {
+    // scratch buffers of the data term
+    std::vector<vec2f> rings;
+    std::vector<std::array<double, 3>> planes;
+    std::vector<double> costs;
+    vec3f height_points;
+
+    // Computes the data term of all faces from one raster of face labels,
+    // with the faces labelled by their v_index. The cost of a face for a
+    // plane is the volume between the heightfield and the plane over the
+    // cells of the face, times weight. Returns the largest cost.
+    double face_label_raster_costs(
+        const std::vector<Face_handle>& faces,
+        const RasterTools::Raster& heightfield,
+        const std::vector<std::tuple<Plane, size_t>>& points_per_plane,
+        double weight) {
+      FaceLabelRaster face_raster(heightfield);
+      for (auto& face : faces) {
+        arrangementface_to_rings(face, rings);
+        face_raster.add_face(rings, int32_t(face->data().v_index));
+      }
+
+      planes.clear();
+      for (auto& [plane, plane_id] : points_per_plane) {
+        planes.push_back({-plane.a() / plane.c(), -plane.b() / plane.c(),
+                          -plane.d() / plane.c()});
+      }
+      face_plane_costs(heightfield, face_raster, faces.size(), planes, costs);
+
+      double max_cost = 0;
+      for (auto& face : faces) {
+        auto row = costs.begin() + face->data().v_index * planes.size();
+        auto& label_cost = face->data().vertex_label_cost;
+        label_cost.assign(row, row + planes.size());
+        for (auto& c : label_cost) {
+          c *= weight;
+          max_cost = std::max(max_cost, c);
+        }
+      }
+      return max_cost;
+    }
+
     void compute(Arrangement_2& arr, const RasterTools::Raster& heightfield,
                  const IndexedPlanesWithPoints& roof_planes,
                  const IndexedPlanesWithPoints& ground_planes,
@@ -241,18 +331,32 @@ namespace roofer::reconstruction {
       size_t face_i = 0;
       size_t label = 0;
       double cell_area = heightfield.cellSize_ * heightfield.cellSize_;
+      const float nodata = float(heightfield.noDataVal_);
       std::vector<Face_handle> faces;
       for (auto face : arr.face_handles()) {
         if (face->data().in_footprint) {
-          vec2f polygon;
-          arrangementface_to_polygon(face, polygon);
-          auto height_points = heightfield.rasterise_polygon(polygon, false);
-
-          for (auto& [plane, plane_id] : points_per_plane) {
-            double volume = cfg.data_weight() * cell_area *
-                            volume_to_plane(plane, height_points);
-            face->data().vertex_label_cost.push_back(volume);
-            max_cost = std::max(max_cost, volume);
+          if (!cfg.face_label_raster) {
+            vec2f polygon;
+            arrangementface_to_polygon(face, polygon);
+            // the cells of the former rasterise_polygon(), so that this path
+            // keeps the previous data term
+            height_points.clear();
+            heightfield.scan_ring_row_edges(
+                polygon, [&](size_t row, size_t col_begin, size_t col_end) {
+                  auto cells = heightfield.row(row);
+                  for (size_t col = col_begin; col < col_end; ++col) {
+                    if (cells[col] == nodata) continue;
+                    height_points.push_back(
+                        heightfield.getPointFromRasterCoords(col, row));
+                  }
+                });
+
+            for (auto& [plane, plane_id] : points_per_plane) {
+              double volume = cfg.data_weight() * cell_area *
+                              volume_to_plane(plane, height_points);
+              face->data().vertex_label_cost.push_back(volume);
+              max_cost = std::max(max_cost, volume);
+            }
           }
           face->data().v_index = face_i++;
           faces.push_back(face);
@@ -263,6 +367,10 @@ namespace roofer::reconstruction {
         }
         ++label;
       }
+      if (cfg.face_label_raster) {
+        max_cost = face_label_raster_costs(faces, heightfield, points_per_plane,
+                                           cfg.data_weight() * cell_area);
+      }
       // normalise
       if (cfg.normalise) {
         for (auto face : faces) {
@@ -306,6 +414,16 @@ namespace roofer::reconstruction {
         }
       }
 
+      // start from the plane with the lowest data cost of each face, so that
+      // the expansions only need to fix up the faces where smoothness wins
+      if (cfg.warm_start && !cfg.preset_labels) {
+        for (auto& face : faces) {
+          auto& cost = face->data().vertex_label_cost;
+          face->data().label =
+              std::min_element(cost.begin(), cost.end()) - cost.begin();
+        }
+      }
+
       FootprintGraph graph(faces, edges);
 
       // assign initial labels?
@@ -320,26 +438,33 @@ namespace roofer::reconstruction {
 
       double result;
 
-      if (cfg.graph_cut_impl == 0) {
+      int graph_cut_impl = cfg.graph_cut_impl;
+      if (graph_cut_impl < 0) {
+        graph_cut_impl = select_graph_cut_impl(faces.size(), edges.size());
+      }
+      if (graph_cut_impl == 0) {
         result = CGAL::alpha_expansion_graphcut(
             graph, Edge_weight_property_map(), Vertex_label_cost_property_map(),
             Vertex_label_property_map(),
             CGAL::parameters::vertex_index_map(Vertex_index_map())
                 .implementation_tag(
                     CGAL::Alpha_expansion_boost_adjacency_list_tag()));
-      } else if (cfg.graph_cut_impl == 1) {
+      } else if (graph_cut_impl == 1) {
         result = CGAL::alpha_expansion_graphcut(
             graph, Edge_weight_property_map(), Vertex_label_cost_property_map(),
             Vertex_label_property_map(),
             CGAL::parameters::vertex_index_map(Vertex_index_map())
                 .implementation_tag(
                     CGAL::Alpha_expansion_boost_compressed_sparse_row_tag()));
-      } else if (cfg.graph_cut_impl == 2) {
+      } else if (graph_cut_impl == 2) {
         result = CGAL::alpha_expansion_graphcut(
             graph, Edge_weight_property_map(), Vertex_label_cost_property_map(),
             Vertex_label_property_map(),
             CGAL::parameters::vertex_index_map(Vertex_index_map())
                 .implementation_tag(CGAL::Alpha_expansion_MaxFlow_tag()));
+      } else if (graph_cut_impl == 3) {
+        static thread_local InTreeGraphCut in_tree_graph_cut;
+        result = in_tree_graph_cut.solve(faces, edges, points_per_plane.size());
       }
 
       // store ground parts
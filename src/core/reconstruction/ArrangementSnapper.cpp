@@ -32,6 +32,7 @@
 
 #include <array>
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <functional>
 #include <limits>
@@ -53,7 +54,12 @@ namespace roofer::reconstruction {
     typedef CGAL::Triangulation_vertex_base_with_info_2<bool, K, VertexBase>
         VertexBaseWithInfo;
     struct TriFaceInfo {
+      static constexpr std::size_t no_region =
+          std::numeric_limits<std::size_t>::max();
+
       FaceInfo* label = nullptr;
+      // index of the constrained region, see constrained_regions()
+      std::size_t region = no_region;
     };
     typedef CGAL::Constrained_triangulation_face_base_2<K> FaceBase;
     typedef CGAL::Triangulation_face_base_with_info_2<TriFaceInfo, K, FaceBase>
@@ -66,12 +72,25 @@ namespace roofer::reconstruction {
         T;
     typedef T::Edge_circulator Edge_circulator;
     typedef T::Face_circulator Face_circulator;
+    typedef T::Vertex_circulator Vertex_circulator;
     typedef T::Finite_faces_iterator Finite_faces_iterator;
     typedef T::Finite_edges_iterator Finite_edges_iterator;
     typedef T::Vertex_handle Vertex_handle;
     typedef T::Face_handle Face_handle;
     typedef std::pair<Face_handle, int> Edge;
 
+    // indices of arrangement_snapper_phases
+    enum Phase {
+      TRIANGULATE,
+      LABEL,
+      COLLAPSE,
+      FLATTEN,
+      REMOVE_DANGLING,
+      REPAIR,
+      TRANSFER
+    };
+    static_assert(TRANSFER + 1 == arrangement_snapper_phases.size());
+
     struct ConstraintToRestore {
       Vertex_handle other;
       FaceInfo* left_label = nullptr;
@@ -143,29 +162,31 @@ namespace roofer::reconstruction {
       return nullptr;
     }
 
-    // region grows constrained regions of triangles
+    // region grows constrained regions of triangles, and stores the index of
+    // its region in each finite triangle
     std::vector<std::vector<Face_handle>> constrained_regions(T& tri) {
       std::vector<std::vector<Face_handle>> regions;
-      std::unordered_set<Face_handle> visited;
+      for (auto face : tri.all_face_handles()) {
+        face->info().region = TriFaceInfo::no_region;
+      }
 
       for (auto face : tri.finite_face_handles()) {
-        if (visited.contains(face)) continue;
+        if (face->info().region != TriFaceInfo::no_region) continue;
 
+        const std::size_t region_index = regions.size();
         std::vector<Face_handle> region;
-        std::queue<Face_handle> queue;
-        queue.push(face);
-        visited.insert(face);
-        while (!queue.empty()) {
-          auto current = queue.front();
-          queue.pop();
-          region.push_back(current);
-
+        face->info().region = region_index;
+        region.push_back(face);
+        // the region doubles as the queue of the breadth first search
+        for (std::size_t next = 0; next < region.size(); ++next) {
+          auto current = region[next];
           for (int i = 0; i < 3; ++i) {
-            Edge edge(current, i);
             auto neighbour = current->neighbor(i);
-            if (!tri.is_constrained(edge) && !tri.is_infinite(neighbour) &&
-                visited.insert(neighbour).second) {
-              queue.push(neighbour);
+            if (!tri.is_constrained({current, i}) &&
+                !tri.is_infinite(neighbour) &&
+                neighbour->info().region == TriFaceInfo::no_region) {
+              neighbour->info().region = region_index;
+              region.push_back(neighbour);
             }
           }
         }
@@ -184,10 +205,13 @@ namespace roofer::reconstruction {
     ForcedFaceLabels locate_forced_labels(
         T& tri, const std::vector<ForcedRegionLabel>& forced_labels) {
       ForcedFaceLabels forced_face_labels;
+      // start each walk from the previous face
+      Face_handle hint;
       for (const auto& forced : forced_labels) {
-        auto located = tri.locate(forced.seed);
+        auto located = tri.locate(forced.seed, hint);
         if (!tri.is_infinite(located)) {
           forced_face_labels.emplace_back(located, forced.face_info);
+          hint = located;
         }
       }
       return forced_face_labels;
@@ -230,12 +254,68 @@ namespace roofer::reconstruction {
       return select_label_by_weight(overlap_area, source_ids);
     }
 
+    // Labels the triangles with the faces of the source arrangement by one
+    // flood fill over the unconstrained edges. It is seeded from the
+    // triangles on both sides of the constraint of each arrangement edge,
+    // with the face on the left of its halfedge. Triangles that are not
+    // reached, eg. because their constraints were split at an intersection,
+    // are left unlabelled. Returns false if two faces reach the same region,
+    // which happens when vertices are merged by the rounding to double.
+    bool flood_fill_region_labels(
+        T& tri, Arrangement_2& source_arrangement,
+        const std::unordered_map<Arrangement_2::Vertex_handle, Vertex_handle>&
+            vertex_map) {
+      for (auto face : tri.all_face_handles()) face->info().label = nullptr;
+
+      bool consistent = true;
+      std::vector<Face_handle> stack;
+      auto reach = [&](Face_handle face, FaceInfo* label) {
+        if (tri.is_infinite(face)) return;
+        if (face->info().label == nullptr) {
+          face->info().label = label;
+          stack.push_back(face);
+        } else if (face->info().label != label) {
+          consistent = false;
+        }
+      };
+
+      for (auto halfedge : source_arrangement.edge_handles()) {
+        auto from = vertex_map.at(halfedge->source());
+        auto to = vertex_map.at(halfedge->target());
+        Face_handle face;
+        int index;
+        if (from == to || !tri.is_edge(from, to, face, index)) continue;
+
+        // a triangle is on the left of its edges in counterclockwise order
+        auto* left = &halfedge->face()->data();
+        auto* right = &halfedge->twin()->face()->data();
+        const bool face_is_left = face->vertex(tri.ccw(index)) == from;
+        reach(face, face_is_left ? left : right);
+        reach(face->neighbor(index), face_is_left ? right : left);
+      }
+
+      while (!stack.empty()) {
+        auto face = stack.back();
+        stack.pop_back();
+        for (int i = 0; i < 3; ++i) {
+          if (!tri.is_constrained({face, i})) {
+            reach(face->neighbor(i), face->info().label);
+          }
+        }
+      }
+      return consistent;
+    }
+
+    // Labels the regions of triangles that are not labelled yet with the
+    // source face that they overlap most.
     void seed_region_labels_from_source(
         T& tri,
         CGAL::Arr_walk_along_line_point_location<Arrangement_2>& walk_pl,
         Arrangement_2& source_arrangement, const SourceFaceIds& source_ids) {
       auto regions = constrained_regions(tri);
       for (const auto& region : regions) {
+        // regions are labelled as a whole by flood_fill_region_labels()
+        if (region.front()->info().label != nullptr) continue;
         auto* label = select_region_label_from_source(
             tri, region, walk_pl, source_arrangement, source_ids);
         if (label == nullptr) continue;
@@ -251,33 +331,6 @@ namespace roofer::reconstruction {
       }
     }
 
-    FaceInfo* forced_label_for_region(
-        const std::vector<Face_handle>& region,
-        const ForcedFaceLabels& forced_face_labels) {
-      for (const auto& [forced_face, forced_label] : forced_face_labels) {
-        if (std::find(region.begin(), region.end(), forced_face) !=
-            region.end()) {
-          return forced_label;
-        }
-      }
-      return nullptr;
-    }
-
-    FaceInfo* seeded_label_for_region(
-        const std::vector<Face_handle>& region,
-        const std::vector<FaceLabelSeed>& label_seeds,
-        const SourceFaceIds& source_ids) {
-      std::unordered_map<FaceInfo*, double> seed_votes;
-      for (const auto& seed : label_seeds) {
-        if (seed.label == nullptr) continue;
-        if (std::find(region.begin(), region.end(), seed.face) !=
-            region.end()) {
-          seed_votes[seed.label] += 1;
-        }
-      }
-      return select_label_by_weight(seed_votes, source_ids);
-    }
-
     FaceInfo* existing_label_for_region(T& tri,
                                         const std::vector<Face_handle>& region,
                                         const SourceFaceIds& source_ids) {
@@ -303,10 +356,28 @@ namespace roofer::reconstruction {
       // TODO: only do full relabelling if absolutely necessary (ie. no forced
       // labels)
       auto regions = constrained_regions(tri);
-      for (const auto& region : regions) {
-        auto* label = forced_label_for_region(region, forced_face_labels);
+
+      // the first forced label of a region wins, then the seed label with the
+      // most votes
+      std::vector<FaceInfo*> forced_region_labels(regions.size(), nullptr);
+      for (const auto& [forced_face, forced_label] : forced_face_labels) {
+        auto& label = forced_region_labels[forced_face->info().region];
+        if (label == nullptr) label = forced_label;
+      }
+      std::unordered_map<std::size_t, std::unordered_map<FaceInfo*, double>>
+          seed_votes;
+      for (const auto& seed : label_seeds) {
+        if (seed.label == nullptr) continue;
+        seed_votes[seed.face->info().region][seed.label] += 1;
+      }
+
+      for (std::size_t r = 0; r < regions.size(); ++r) {
+        const auto& region = regions[r];
+        auto* label = forced_region_labels[r];
         if (label == nullptr) {
-          label = seeded_label_for_region(region, label_seeds, source_ids);
+          if (auto votes = seed_votes.find(r); votes != seed_votes.end()) {
+            label = select_label_by_weight(votes->second, source_ids);
+          }
         }
         if (label == nullptr) {
           label = existing_label_for_region(tri, region, source_ids);
@@ -451,11 +522,13 @@ namespace roofer::reconstruction {
       return nullptr;
     }
 
+    // hint is a face near the point, eg. one of a former neighbour of the
+    // removed vertex
     void seed_removed_vertex_region(T& tri, const T::Point_2& point,
-                                    FaceInfo* label) {
+                                    FaceInfo* label, Face_handle hint) {
       if (label == nullptr) return;
 
-      auto face = tri.locate(point);
+      auto face = tri.locate(point, hint);
       if (!tri.is_infinite(face)) face->info().label = label;
     }
 
@@ -510,8 +583,20 @@ namespace roofer::reconstruction {
       for (auto vertex : vertices_to_remove) {
         auto* label = incident_region_label(tri, vertex);
         auto point = vertex->point();
+        // a finite neighbour survives the removal, and its faces are next to
+        // the hole that the vertex leaves
+        Vertex_handle hint_vertex;
+        Vertex_circulator neighbour = tri.incident_vertices(vertex),
+                          done(neighbour);
+        if (neighbour != nullptr) {
+          do {
+            if (!tri.is_infinite(neighbour)) hint_vertex = neighbour;
+          } while (hint_vertex == Vertex_handle() && ++neighbour != done);
+        }
         tri.remove(vertex);
-        seed_removed_vertex_region(tri, point, label);
+        Face_handle hint;
+        if (hint_vertex != Vertex_handle()) hint = hint_vertex->face();
+        seed_removed_vertex_region(tri, point, label, hint);
       }
     }
 
@@ -542,6 +627,8 @@ namespace roofer::reconstruction {
 
       const double sample_radius = clearance * 0.25;
       constexpr double two_pi = 2 * CGAL_PI;
+      // the samples are around the vertex, so walk from the previous one
+      Face_handle hint = vertex->face();
       for (std::size_t i = 0; i < sectors.size(); ++i) {
         double next_angle = sectors[(i + 1) % sectors.size()].angle;
         if (next_angle <= sectors[i].angle) next_angle += two_pi;
@@ -549,7 +636,8 @@ namespace roofer::reconstruction {
         T::Point_2 sample(
             vertex->point().x() + sample_radius * std::cos(sample_angle),
             vertex->point().y() + sample_radius * std::sin(sample_angle));
-        auto face = tri.locate(sample);
+        auto face = tri.locate(sample, hint);
+        hint = face;
         auto label = face_labels.find(face);
         if (label == face_labels.end() || label->second == nullptr) return {};
         auto* face_info = label->second;
@@ -1136,6 +1224,13 @@ namespace roofer::reconstruction {
           const ExteriorHeightProvider& exterior_height_provider) {
         typedef CGAL::Arr_walk_along_line_point_location<Arrangement_2> Walk_pl;
 
+        auto phase_start = std::chrono::high_resolution_clock::now();
+        auto end_phase = [&](Phase phase) {
+          const auto now = std::chrono::high_resolution_clock::now();
+          phase_timings[phase] = now - phase_start;
+          phase_start = now;
+        };
+
         T tri;
         float sq_dist_thres = cfg.distance_threshold * cfg.distance_threshold;
 
@@ -1177,10 +1272,18 @@ namespace roofer::reconstruction {
                                   vertex_map[arrEdge->target()]);
           }
         }
-        // TODOX: use more of a combinatorics approach rather than the area
-        // voting. Ie. take one edge per arr face (and store face), link to
-        // matching constraint in cdt, and kick off face labeling from there.
+        end_phase(TRIANGULATE);
+
+        // Label the triangles from the arrangement edges, and fall back to
+        // locating the triangles in the arrangement for the regions that the
+        // flood fill did not label unambiguously.
+        if (!flood_fill_region_labels(tri, arr, vertex_map)) {
+          for (auto face : tri.all_face_handles()) {
+            face->info().label = nullptr;
+          }
+        }
         seed_region_labels_from_source(tri, walk_pl, arr, source_face_ids);
+        end_phase(LABEL);
 
         // Detect triangles with 3 short edges => collapse triangle to point
         // (remove 2 vertices)
@@ -1313,6 +1416,7 @@ namespace roofer::reconstruction {
             }
           }
         } while (found_short_edge);
+        end_phase(COLLAPSE);
 
         // Detect triangles with 1 vertex close to opposing (longest) edge  =>
         // remove long edge as constraint and ensure both short ones are
@@ -1376,9 +1480,12 @@ namespace roofer::reconstruction {
           }
         }
 
+        end_phase(FLATTEN);
+
         // Remove dangling constraint trees and the unconstrained vertices left
         // behind by snapping.
         remove_dangling_constraints_and_vertices(tri);
+        end_phase(REMOVE_DANGLING);
 
         // Detect and repair non-manifold vertices (ie. leading to a
         // non-manifold edge during extrusion) and self-intersecting faces.
@@ -1400,6 +1507,7 @@ namespace roofer::reconstruction {
               tri, *candidate, source_face_ids, unbounded_label,
               cfg.manifold_repair_radius, cfg.manifold_height_tolerance));
         }
+        end_phase(REPAIR);
 
         // convert back from triangulation to arrangement
         // 1 recreate vertices and faces
@@ -1417,6 +1525,9 @@ namespace roofer::reconstruction {
           }
         }
 
+        // the halfedges of the constraints, with the triangle on their left
+        std::vector<std::pair<Face_handle, Arrangement_2::Halfedge_handle>>
+            constraint_sides;
         for (auto ce : tri.constrained_edges()) {
           auto v1 = ce.first->vertex(tri.cw(ce.second));
           auto v2 = ce.first->vertex(tri.ccw(ce.second));
@@ -1429,14 +1540,32 @@ namespace roofer::reconstruction {
           // std::cout << p1 << "  --  " << p2 << std::endl;
 
           // if (vertex2arr_map[v1] != vertex2arr_map[v2]) {
-          arr_snap.insert_at_vertices(Segment_2(p1, p2), vertex2arr_map[v1],
-                                      vertex2arr_map[v2]);
+          auto halfedge = arr_snap.insert_at_vertices(
+              Segment_2(p1, p2), vertex2arr_map[v1], vertex2arr_map[v2]);
           // } else {
           //   std::cout << "skipping edge between same vertex\n";
           // }
+          if (halfedge->source() != vertex2arr_map[v1]) {
+            halfedge = halfedge->twin();
+          }
+          // ce.first is on the left of v2 -> v1
+          constraint_sides.emplace_back(ce.first, halfedge->twin());
+          constraint_sides.emplace_back(ce.first->neighbor(ce.second),
+                                        halfedge);
+        }
+
+        // 2 transfer labels from triangulation to new arrangement. A region of
+        // triangles is one face of the new arrangement, which is found from
+        // the halfedge of any of its constraints. Only regions without a
+        // constraint are located in the new arrangement.
+        auto regions = constrained_regions(tri);
+        std::vector<std::optional<Arrangement_2::Face_handle>> region_faces(
+            regions.size());
+        for (const auto& [face, halfedge] : constraint_sides) {
+          if (tri.is_infinite(face)) continue;
+          region_faces[face->info().region] = halfedge->face();
         }
 
-        // 2 transfer labels from triangulation to new arrangement
         typedef CGAL::Arr_walk_along_line_point_location<Arrangement_2>
             Snap_walk_pl;
         Snap_walk_pl snap_walk_pl(arr_snap);
@@ -1451,14 +1580,18 @@ namespace roofer::reconstruction {
           const auto area = std::abs(triangle.area());
           if (!(area > 0)) continue;
 
-          const auto sample = CGAL::centroid(triangle);
-          auto object = snap_walk_pl.locate(
-              Arrangement_2::Point_2(sample.x(), sample.y()));
-          if (auto located_face = std::get_if<Face_const_handle>(&object)) {
-            auto output_face = arr_snap.non_const_handle(*located_face);
-            if (output_face->is_unbounded()) continue;
-            output_face_labels[output_face][label] += area;
+          auto& region_face = region_faces[face->info().region];
+          if (!region_face) {
+            const auto sample = CGAL::centroid(triangle);
+            auto object = snap_walk_pl.locate(
+                Arrangement_2::Point_2(sample.x(), sample.y()));
+            auto located_face = std::get_if<Face_const_handle>(&object);
+            if (!located_face) continue;
+            region_face = arr_snap.non_const_handle(*located_face);
           }
+          auto output_face = *region_face;
+          if (output_face->is_unbounded()) continue;
+          output_face_labels[output_face][label] += area;
         }
 
         arr_snap.unbounded_face()->data() = arr.unbounded_face()->data();
@@ -1549,6 +1682,7 @@ namespace roofer::reconstruction {
         // }
 
         arr = arr_snap;
+        end_phase(TRANSFER);
       }
 
       void compute(Arrangement_2& arr, ArrangementSnapperConfig cfg) override {
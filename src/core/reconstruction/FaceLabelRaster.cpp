@@ -0,0 +1,81 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+
+#include <algorithm>
+#include <cmath>
+#include <roofer/reconstruction/FaceLabelRaster.hpp>
+
+namespace roofer::reconstruction {
+
+  FaceLabelRaster::FaceLabelRaster(const RasterTools::Raster& grid)
+      : BasicRaster(grid.cellSize_, grid.minx_, grid.maxx_, grid.miny_,
+                    grid.maxy_) {
+    noDataVal_ = no_face;
+    std::fill(vals_.begin(), vals_.end(), no_face);
+  }
+
+  void FaceLabelRaster::add_face(const std::vector<vec2f>& rings,
+                                 int32_t label) {
+    scan_rings(rings, [&](size_t row, size_t col_begin, size_t col_end) {
+      auto cells = this->row(row);
+      std::fill(cells.begin() + col_begin, cells.begin() + col_end, label);
+    });
+  }
+
+  void face_plane_costs(const RasterTools::Raster& heightfield,
+                        const FaceLabelRaster& faces, size_t face_count,
+                        const std::vector<std::array<double, 3>>& planes,
+                        std::vector<double>& costs) {
+    const size_t plane_count = planes.size();
+    costs.assign(face_count * plane_count, 0);
+    if (plane_count == 0) return;
+
+    // the planes as separate coefficient arrays, so that the loop over the
+    // planes is vectorised. Each plane has its own sum, so this needs no
+    // reassociation of the floating point additions.
+    std::vector<double> a(plane_count), c(plane_count);
+    for (size_t p = 0; p < plane_count; ++p) a[p] = planes[p][0];
+
+    const float nodata = float(heightfield.noDataVal_);
+    for (size_t row = 0; row < faces.dimy_; ++row) {
+      const double y = faces.miny_ + (double(row) + 0.5) * faces.cellSize_;
+      for (size_t p = 0; p < plane_count; ++p) {
+        c[p] = planes[p][1] * y + planes[p][2];
+      }
+      const auto row_labels = faces.row(row);
+      const auto row_vals = heightfield.row(row);
+      for (size_t col = 0; col < faces.dimx_; ++col) {
+        const int32_t label = row_labels[col];
+        if (label == FaceLabelRaster::no_face || row_vals[col] == nodata) {
+          continue;
+        }
+        const double x = faces.minx_ + (double(col) + 0.5) * faces.cellSize_;
+        const double z = row_vals[col];
+        double* face_costs = costs.data() + size_t(label) * plane_count;
+        for (size_t p = 0; p < plane_count; ++p) {
+          face_costs[p] += std::abs(z - (a[p] * x + c[p]));
+        }
+      }
+    }
+  }
+
+}  // namespace roofer::reconstruction
@@ -0,0 +1,89 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+#include <CGAL/Orthogonal_k_neighbor_search.h>
+#include <CGAL/Search_traits_3.h>
+#include <CGAL/Search_traits_adapter.h>
+#include <CGAL/for_each.h>
+#include <CGAL/property_map.h>
+
+#include <algorithm>
+#include <boost/range/counting_range.hpp>
+#include <roofer/reconstruction/KnnGraph.hpp>
+#include <roofer/reconstruction/KnnIndex.hpp>
+#include <roofer/reconstruction/cgal_shared_definitions.hpp>
+#include <utility>
+
+namespace roofer::reconstruction {
+
+  namespace {
+#ifdef CGAL_LINKED_WITH_TBB
+    typedef CGAL::Parallel_tag Concurrency_tag;
+#else
+    typedef CGAL::Sequential_tag Concurrency_tag;
+#endif
+    typedef std::pair<Point, std::size_t> point_index;
+    typedef CGAL::Search_traits_3<EPICK> Traits_base;
+    typedef CGAL::Search_traits_adapter<
+        point_index, CGAL::First_of_pair_property_map<point_index>,
+        Traits_base>
+        TreeTraits;
+    typedef CGAL::Orthogonal_k_neighbor_search<TreeTraits> Neighbor_search;
+    typedef Neighbor_search::Tree Tree;
+  }  // namespace
+
+  KnnGraph compute_knn_graph(std::span<const arr3f> points, std::size_t k,
+                             KnnBackend backend) {
+    if (backend == KnnBackend::grid) return KnnIndex(points).all_knn(k);
+
+    const auto size = points.size();
+    const auto row_size = std::min(k, size);
+
+    KnnGraph graph;
+    graph.k = k;
+    graph.offsets.resize(size + 1);
+    for (std::size_t i = 0; i <= size; ++i) graph.offsets[i] = i * row_size;
+    graph.indices.resize(size * row_size);
+    if (row_size == 0) return graph;
+
+    std::vector<point_index> indexed_points;
+    indexed_points.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      const auto& p = points[i];
+      indexed_points.emplace_back(Point(p[0], p[1], p[2]), i);
+    }
+    Tree tree(indexed_points.begin(), indexed_points.end());
+    // the tree is built lazily on the first query, which is not thread-safe
+    tree.build<Concurrency_tag>();
+
+    CGAL::for_each<Concurrency_tag>(
+        boost::counting_range(std::size_t(0), size), [&](std::size_t i) {
+          Neighbor_search search(tree, indexed_points[i].first, row_size);
+          auto row = graph.indices.begin() + graph.offsets[i];
+          for (const auto& neighbour : search) {
+            *row++ = neighbour.first.second;
+          }
+          return true;
+        });
+    return graph;
+  }
+
+}  // namespace roofer::reconstruction
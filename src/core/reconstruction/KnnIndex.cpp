@@ -0,0 +1,236 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+#include <CGAL/for_each.h>
+
+#include <algorithm>
+#include <boost/range/counting_range.hpp>
+#include <cmath>
+#include <limits>
+#include <roofer/reconstruction/KnnIndex.hpp>
+#include <utility>
+
+namespace roofer::reconstruction {
+
+  namespace {
+#ifdef CGAL_LINKED_WITH_TBB
+    typedef CGAL::Parallel_tag Concurrency_tag;
+#else
+    typedef CGAL::Sequential_tag Concurrency_tag;
+#endif
+
+    // number of consecutive queries that one all_knn() task runs
+    constexpr std::size_t query_block_size = 256;
+
+    // spread the lower 32 bits of v over the even bits of the result
+    std::uint64_t spread_bits(std::uint64_t v) {
+      v &= 0xffffffff;
+      v = (v | (v << 16)) & 0x0000ffff0000ffff;
+      v = (v | (v << 8)) & 0x00ff00ff00ff00ff;
+      v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0f;
+      v = (v | (v << 2)) & 0x3333333333333333;
+      v = (v | (v << 1)) & 0x5555555555555555;
+      return v;
+    }
+
+    std::uint64_t morton_code(std::uint32_t cx, std::uint32_t cy) {
+      return spread_bits(cx) | (spread_bits(cy) << 1);
+    }
+  }  // namespace
+
+  template <typename T>
+  BasicKnnIndex<T>::BasicKnnIndex(std::span<const arr3f> points,
+                                  T points_per_cell) {
+    const auto n = points.size();
+    if (n == 0) {
+      cell_begin_.assign(1, 0);
+      cell_end_.assign(1, 0);
+      return;
+    }
+
+    T max_x = std::numeric_limits<T>::lowest();
+    T max_y = std::numeric_limits<T>::lowest();
+    min_x_ = min_y_ = std::numeric_limits<T>::max();
+    for (const auto& p : points) {
+      min_x_ = std::min(min_x_, T(p[0]));
+      min_y_ = std::min(min_y_, T(p[1]));
+      max_x = std::max(max_x, T(p[0]));
+      max_y = std::max(max_y, T(p[1]));
+    }
+    // choose the cell size for the average point density in xy, and fall
+    // back to the density along a line if the points are collinear in xy
+    const double w = double(max_x) - min_x_;
+    const double h = double(max_y) - min_y_;
+    const double per_cell = std::max(T(1), points_per_cell);
+    double cell_size = std::sqrt(w * h * per_cell / double(n));
+    if (!(cell_size > 0)) cell_size = std::max(w, h) * per_cell / double(n);
+    if (!(cell_size > 0)) cell_size = 1;
+    // at most about 4 cells per point
+    const double max_cells = 4.0 * double(n) + 1;
+    while ((std::floor(w / cell_size) + 1) * (std::floor(h / cell_size) + 1) >
+           max_cells) {
+      cell_size *= 2;
+    }
+    cell_size_ = T(cell_size);
+    inv_cell_size_ = T(1 / cell_size);
+    nx_ = int(w / cell_size) + 1;
+    ny_ = int(h / cell_size) + 1;
+
+    auto cell_of = [&](const arr3f& p) {
+      const int cx = std::clamp(int((p[0] - min_x_) * inv_cell_size_), 0,
+                                nx_ - 1);
+      const int cy = std::clamp(int((p[1] - min_y_) * inv_cell_size_), 0,
+                                ny_ - 1);
+      return std::make_pair(cx, cy);
+    };
+
+    // sort the points by the Morton code of their cell
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> order(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      auto [cx, cy] = cell_of(points[i]);
+      order[i] = {morton_code(cx, cy), std::uint32_t(i)};
+    }
+    std::sort(order.begin(), order.end());
+
+    x_.resize(n);
+    y_.resize(n);
+    z_.resize(n);
+    index_.resize(n);
+    const std::size_t n_cells = std::size_t(nx_) * std::size_t(ny_);
+    cell_begin_.assign(n_cells, 0);
+    cell_end_.assign(n_cells, 0);
+    for (std::size_t s = 0; s < n; ++s) {
+      const auto& p = points[order[s].second];
+      x_[s] = p[0];
+      y_[s] = p[1];
+      z_[s] = p[2];
+      index_[s] = order[s].second;
+      auto [cx, cy] = cell_of(p);
+      const auto cell = std::size_t(cy) * nx_ + cx;
+      if (cell_end_[cell] == 0) cell_begin_[cell] = std::uint32_t(s);
+      cell_end_[cell] = std::uint32_t(s + 1);
+    }
+  }
+
+  template <typename T>
+  void BasicKnnIndex<T>::search(T qx, T qy, T qz, std::size_t k,
+                                std::vector<Candidate>& best) const {
+    best.clear();
+    if (k == 0 || index_.empty()) return;
+    k = std::min(k, index_.size());
+
+    auto visit_cell = [&](int cx, int cy) {
+      const auto cell = std::size_t(cy) * nx_ + cx;
+      for (auto s = cell_begin_[cell]; s < cell_end_[cell]; ++s) {
+        const T dx = x_[s] - qx;
+        const T dy = y_[s] - qy;
+        const T dz = z_[s] - qz;
+        const Candidate c{dx * dx + dy * dy + dz * dz, index_[s]};
+        if (best.size() == k) {
+          if (!(c < best.back())) continue;
+          best.pop_back();
+        }
+        best.insert(std::upper_bound(best.begin(), best.end(), c), c);
+      }
+    };
+
+    const int cx =
+        std::clamp(int(std::floor((qx - min_x_) * inv_cell_size_)), 0, nx_ - 1);
+    const int cy =
+        std::clamp(int(std::floor((qy - min_y_) * inv_cell_size_)), 0, ny_ - 1);
+    // visit rings of cells around the cell of the query until no cell
+    // outside the visited block can hold a closer point
+    for (int r = 0;; ++r) {
+      const int x0 = cx - r, x1 = cx + r, y0 = cy - r, y1 = cy + r;
+      for (int y = std::max(y0, 0); y <= std::min(y1, ny_ - 1); ++y) {
+        if (y == y0 || y == y1) {
+          for (int x = std::max(x0, 0); x <= std::min(x1, nx_ - 1); ++x) {
+            visit_cell(x, y);
+          }
+        } else {
+          if (x0 >= 0) visit_cell(x0, y);
+          if (x1 < nx_) visit_cell(x1, y);
+        }
+      }
+
+      // xy distance from the query to the cells beyond the visited block
+      T bound = std::numeric_limits<T>::max();
+      if (x0 > 0) bound = std::min(bound, qx - (min_x_ + x0 * cell_size_));
+      if (x1 < nx_ - 1) {
+        bound = std::min(bound, min_x_ + (x1 + 1) * cell_size_ - qx);
+      }
+      if (y0 > 0) bound = std::min(bound, qy - (min_y_ + y0 * cell_size_));
+      if (y1 < ny_ - 1) {
+        bound = std::min(bound, min_y_ + (y1 + 1) * cell_size_ - qy);
+      }
+      if (bound == std::numeric_limits<T>::max()) break;
+      bound = std::max(bound, T(0));
+      if (best.size() == k && best.back().d2 <= bound * bound) break;
+    }
+  }
+
+  template <typename T>
+  void BasicKnnIndex<T>::query(const arr3f& query, std::size_t k,
+                               std::vector<std::size_t>& result) const {
+    std::vector<Candidate> best;
+    best.reserve(k + 1);
+    search(query[0], query[1], query[2], k, best);
+    result.clear();
+    for (const auto& c : best) result.push_back(c.index);
+  }
+
+  template <typename T>
+  KnnGraph BasicKnnIndex<T>::all_knn(std::size_t k, bool parallel) const {
+    const auto n = index_.size();
+    const auto row_size = std::min(k, n);
+
+    KnnGraph graph;
+    graph.k = k;
+    graph.offsets.resize(n + 1);
+    for (std::size_t i = 0; i <= n; ++i) graph.offsets[i] = i * row_size;
+    graph.indices.resize(n * row_size);
+    if (row_size == 0) return graph;
+
+    auto run_block = [&](std::size_t block) {
+      std::vector<Candidate> best;
+      best.reserve(row_size + 1);
+      const auto end = std::min(n, (block + 1) * query_block_size);
+      for (auto s = block * query_block_size; s < end; ++s) {
+        search(x_[s], y_[s], z_[s], row_size, best);
+        auto row = graph.indices.begin() + graph.offsets[index_[s]];
+        for (const auto& c : best) *row++ = c.index;
+      }
+      return true;
+    };
+    const auto blocks = boost::counting_range(
+        std::size_t(0), (n + query_block_size - 1) / query_block_size);
+    if (parallel) {
+      CGAL::for_each<Concurrency_tag>(blocks, run_block);
+    } else {
+      CGAL::for_each<CGAL::Sequential_tag>(blocks, run_block);
+    }
+    return graph;
+  }
+
+  template class BasicKnnIndex<float>;
+  template class BasicKnnIndex<double>;
+
+}  // namespace roofer::reconstruction
@@ -19,6 +19,7 @@
 // Author(s):
 // Ravi Peters
 
+#include <roofer/reconstruction/KnnGraph.hpp>
 #include <roofer/reconstruction/LineDetector.hpp>
 #include <roofer/reconstruction/LineDetectorBase.hpp>
 #include <roofer/reconstruction/LineRegulariserBase.hpp>
@@ -34,6 +35,22 @@ namespace roofer::reconstruction {
   };
   // typedef std::map<IDPair, size_t, Cmp> RingSegMap;
 
+  // Neighbourhoods of the points of a ring for linedect::LineDetector, the
+  // point itself included. The ring neighbours have always been searched with
+  // the default LineDetector::N of 5, because detect_lines_ring() only sets N
+  // from the configuration after the search. This is kept so that the
+  // detected lines do not change.
+  linedect::NeighbourVec ring_neighbours(const vec3f& ring) {
+    constexpr size_t ring_neighbour_count = 5;
+    auto graph = compute_knn_graph(ring, ring_neighbour_count);
+    linedect::NeighbourVec neighbours(graph.size());
+    for (size_t i = 0; i < graph.size(); ++i) {
+      auto row = graph.neighbours(i);
+      neighbours[i].assign(row.begin(), row.end());
+    }
+    return neighbours;
+  }
+
   inline size_t detect_lines_ring(
       linedect::LineDetector& LD, const Plane& plane,
       SegmentCollection& segments_out,
@@ -42,10 +59,7 @@ namespace roofer::reconstruction {
     LD.N = cfg.neighbour_count;
     auto& c_upper = cfg.min_point_count_range.second;
     auto& c_lower = cfg.min_point_count_range.first;
-    for (size_t i = c_upper; i >= c_lower; --i) {
-      LD.min_segment_count = i;
-      LD.detect();
-    }
+    LD.detect(c_upper, c_lower);
     size_t ringsize = LD.point_segment_idx.size();
     // chain the detected lines, to ensure correct order
     if (LD.segment_shapes.size() > 1) {
@@ -202,7 +216,7 @@ namespace roofer::reconstruction {
           cgal_pts.push_back(linedect::Point(p[0], p[1], p[2]));
         }
 
-        linedect::LineDetector LD(cgal_pts);
+        linedect::LineDetector LD(cgal_pts, ring_neighbours(ring));
         // SegmentCollection ring_edges;
         auto n_detected = detect_lines_ring(
             LD, pts_per_roofplane.at(plane_id).first, edge_segments, cfg);
@@ -226,7 +240,7 @@ namespace roofer::reconstruction {
             cgal_pts.push_back(linedect::Point(p[0], p[1], p[2]));
           }
 
-          linedect::LineDetector LD(cgal_pts);
+          linedect::LineDetector LD(cgal_pts, ring_neighbours(hole));
           // SegmentCollection ring_edges;
           auto n_detected = detect_lines_ring(
               LD, pts_per_roofplane.at(plane_id).first, edge_segments, cfg);
@@ -19,7 +19,10 @@
 // Author(s):
 // Ravi Peters
 
+#include <algorithm>
+#include <memory_resource>
 #include <queue>
+#include <roofer/common/memory_resource.hpp>
 #include <roofer/reconstruction/LineDetectorBase.hpp>
 #include <stack>
 
@@ -152,7 +155,8 @@ namespace roofer::linedect {
     return ordered_segments.size();
   }
   inline Line LineDetector::fit_line(vector<size_t>& neighbour_idx) {
-    vector<Point> neighbor_points;
+    pmr::vector<Point> neighbor_points(scratch_resource());
+    neighbor_points.reserve(neighbour_idx.size());
     for (auto neighbor_id : neighbour_idx) {
       neighbor_points.push_back(indexed_points[neighbor_id].first);
     }
@@ -164,6 +168,55 @@ namespace roofer::linedect {
   }
 
   std::vector<size_t> LineDetector::detect() {
+    return detect(min_segment_count, min_segment_count);
+  }
+
+  std::vector<size_t> LineDetector::detect(size_t upper, size_t lower) {
+    std::vector<size_t> new_regions, region_sizes;
+    if (upper < lower) return new_regions;
+
+    if (seed_dist.empty()) {
+      seed_dist.resize(indexed_points.size());
+      for (auto pi : indexed_points) {
+        auto line = fit_line(neighbours[pi.second]);
+        seed_dist[pi.second] = CGAL::squared_distance(line, pi.first);
+      }
+    }
+
+    size_t count = upper, skip = 0;
+    while (true) {
+      min_segment_count = count;
+      region_sizes.resize(skip);
+      if (detect_pass(skip, region_sizes, new_regions)) {
+        if (count == lower) break;
+        --count;
+        skip = 0;
+        continue;
+      }
+      // Nothing was accepted, so the passes for the next counts start from
+      // the same segmentation and grow the same regions in the same order.
+      // They reject all of them until the count reaches the size of the
+      // largest region, which is the first one that is accepted.
+      auto largest = std::max_element(region_sizes.begin(), region_sizes.end());
+      if (largest == region_sizes.end() || *largest < lower) {
+        region_counter += (count - lower) * region_sizes.size();
+        break;
+      }
+      region_counter += (count - 1 - *largest) * region_sizes.size();
+      skip = largest - region_sizes.begin();
+      count = *largest;
+    }
+    min_segment_count = lower;
+    return new_regions;
+  }
+
+  // One region growing pass over the unsegmented points, from the seeds with
+  // the largest seed_dist first. The first `skip` regions are known to be
+  // rejected and are not grown. The sizes of the grown regions are appended
+  // to region_sizes until the first region is accepted. Returns true if a
+  // region was accepted.
+  bool LineDetector::detect_pass(size_t skip, vector<size_t>& region_sizes,
+                                 vector<size_t>& new_regions) {
     // seed generation
     typedef pair<size_t, double> index_dist_pair;
     auto cmp = [](index_dist_pair left, index_dist_pair right) {
@@ -172,43 +225,48 @@ namespace roofer::linedect {
     priority_queue<index_dist_pair, vector<index_dist_pair>, decltype(cmp)> pq(
         cmp);
 
-    // size_t i=0;
     for (auto pi : indexed_points) {
       if (point_segment_idx[pi.second] == 0) {
-        auto p = pi.first;
-        auto line = fit_line(neighbours[pi.second]);
-        auto line_dist = CGAL::squared_distance(line, p);
-        pq.push(index_dist_pair(pi.second, line_dist));
+        pq.push(index_dist_pair(pi.second, seed_dist[pi.second]));
       }
     }
 
-    std::vector<size_t> new_regions;
-
     // region growing from seed points
+    bool accepted = false;
+    size_t grown = 0;
     while (pq.size() > 0) {
       auto idx = pq.top().first;
       pq.pop();
       // if (point_seed_flags[idx]){
       if (point_segment_idx[idx] == 0) {
-        if (grow_region(idx)) new_regions.push_back(region_counter);
+        if (grown++ >= skip) {
+          auto size = grow_region(idx);
+          if (size >= min_segment_count) {
+            new_regions.push_back(region_counter);
+            accepted = true;
+          } else if (!accepted) {
+            region_sizes.push_back(size);
+          }
+        }
         region_counter++;
       }
     }
-    return new_regions;
+    return accepted;
   }
 
   inline bool LineDetector::valid_candidate(Line& line, Point& p) {
     return CGAL::squared_distance(line, p) < dist_thres;
   }
 
-  bool LineDetector::grow_region(size_t seed_idx) {
+  size_t LineDetector::grow_region(size_t seed_idx) {
     auto p = indexed_points[seed_idx];
     auto line = fit_line(neighbours[seed_idx]);
     segment_shapes[region_counter] = line;
 
-    vector<Point> points_in_region;
-    vector<size_t> idx_in_region;
-    stack<size_t> candidates;
+    pmr::vector<Point> points_in_region(scratch_resource());
+    pmr::vector<size_t> idx_in_region(scratch_resource());
+    stack<size_t, pmr::vector<size_t>> candidates(
+        pmr::vector<size_t>(scratch_resource()));
     candidates.push(seed_idx);
     point_segment_idx[seed_idx] = region_counter;
     points_in_region.push_back(p.first);
@@ -240,8 +298,7 @@ namespace roofer::linedect {
     if (points_in_region.size() < min_segment_count) {
       segment_shapes.erase(region_counter);
       for (auto idx : idx_in_region) point_segment_idx[idx] = 0;
-      return false;
     }
-    return true;
+    return points_in_region.size();
   }
 }  // namespace roofer::linedect
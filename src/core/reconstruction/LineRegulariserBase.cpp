@@ -19,6 +19,8 @@
 // Author(s):
 // Ravi Peters
 
+#include <algorithm>
+#include <cmath>
 #include <iterator>
 #include <roofer/reconstruction/LineRegulariserBase.hpp>
 
@@ -99,6 +101,10 @@ namespace roofer::linereg {
     return std::fabs(value - other_cluster->value);
   }
   void AngleCluster::calc_mean_value() { value = calc_mean_angle(lines); }
+  std::array<double, 2> AngleCluster::key_range() const {
+    return {value, value};
+  }
+  double AngleCluster::bounds_radius(double threshold) { return threshold; }
 
   double DistCluster::distance(Cluster<Segment_2>* other_cluster) {
     return CGAL::to_double(CGAL::squared_distance(value, other_cluster->value));
@@ -110,30 +116,216 @@ namespace roofer::linereg {
     Point_2 centroid = calc_centroid(lines);
     value = calc_segment(centroid, mean_angle, lines);
   }
+  std::array<double, 2> DistCluster::key_range() const {
+    // the projection of a segment on an axis is the interval between the
+    // projections of its end points, and the projections of two points are
+    // no further apart than the points
+    auto key = [this](const Point_2& p) {
+      return key_axis[0] * CGAL::to_double(p.x()) +
+             key_axis[1] * CGAL::to_double(p.y());
+    };
+    const double a = key(value.source()), b = key(value.target());
+    return {std::min(a, b), std::max(a, b)};
+  }
+  double DistCluster::bounds_radius(double threshold) {
+    // the distance is squared
+    return std::sqrt(threshold);
+  }
+
+  template <typename ClusterH>
+  DistanceTable<ClusterH>::DistanceTable(std::set<ClusterH>& clusters,
+                                         double threshold)
+      : clusters(clusters), threshold(threshold) {
+    for (auto& cluster : clusters) {
+      index[cluster] = uint32_t(handles.size());
+      handles.push_back(cluster);
+    }
+    const size_t n = handles.size();
+    alive.assign(n, true);
+    nearest.assign(n, npos);
+    nearest_dist.assign(n, 0);
+    nearest_of.resize(n);
+    heap_pos.assign(n, npos);
+    stamp.assign(n, 0);
+    // no pair can be closer than a threshold of 0
+    if (n < 2 || !(threshold > 0)) return;
+
+    // buckets that are at least as large as the bounds radius, and no more
+    // buckets than clusters. Keys outside the initial extent are clamped to
+    // the first and last bucket, since the merged clusters can grow beyond it.
+    radius = ClusterH::element_type::bounds_radius(threshold);
+    std::array<double, 2> extent = handles.front()->key_range();
+    for (auto& cluster : handles) {
+      auto key = cluster->key_range();
+      extent = {std::min(extent[0], key[0]), std::max(extent[1], key[1])};
+    }
+    key0 = extent[0];
+    bucket_size = std::max(radius, (extent[1] - extent[0]) / double(n));
+    if (!(bucket_size > 0)) bucket_size = 1;
+    buckets.resize(size_t((extent[1] - extent[0]) / bucket_size) + 1);
+    bucket_range.assign(n, {1, 0});
+
+    for (uint32_t c = 0; c < n; ++c) add_to_buckets(c);
+    for (uint32_t c = 0; c < n; ++c) find_nearest(c, false);
+  }
+
+  template <typename ClusterH>
+  std::array<size_t, 2> DistanceTable<ClusterH>::buckets_of(
+      const std::array<double, 2>& key, double margin) const {
+    auto bucket = [this](double v) {
+      const double b = std::floor((v - key0) / bucket_size);
+      if (!(b > 0)) return size_t(0);
+      return std::min(size_t(b), buckets.size() - 1);
+    };
+    return {bucket(key[0] - margin), bucket(key[1] + margin)};
+  }
+
+  template <typename ClusterH>
+  void DistanceTable<ClusterH>::add_to_buckets(uint32_t cluster) {
+    // only the buckets that the cluster was not added to yet. If the new
+    // range does not touch the old one, the cluster stays in the buckets of
+    // the old range. That only costs a few extra distance measurements.
+    const auto [first, last] = buckets_of(handles[cluster]->key_range(), 0);
+    auto& [added_first, added_last] = bucket_range[cluster];
+    const bool touches = added_first <= added_last &&
+                         first <= added_last + 1 && added_first <= last + 1;
+    for (size_t b = first; b <= last; ++b) {
+      if (!touches || b < added_first || b > added_last)
+        buckets[b].push_back(cluster);
+    }
+    if (touches) {
+      added_first = std::min(added_first, first);
+      added_last = std::max(added_last, last);
+    } else {
+      added_first = first;
+      added_last = last;
+    }
+  }
+
+  template <typename ClusterH>
+  bool DistanceTable<ClusterH>::closer(uint32_t cluster, double dist,
+                                       uint32_t other) const {
+    // ties are broken on the cluster indices of the pair, so that the merge
+    // order does not depend on the order of the updates
+    if (nearest[cluster] == npos) return true;
+    if (dist != nearest_dist[cluster]) return dist < nearest_dist[cluster];
+    return std::minmax(cluster, other) <
+           std::minmax(cluster, nearest[cluster]);
+  }
 
   template <typename ClusterH>
-  DistanceTable<ClusterH>::DistanceTable(std::set<ClusterH>& clusters)
-      : clusters(clusters) {
-    // compute only half of the distance table, since the other half will be
-    // exactly the same
-    for (auto cit_a = clusters.begin(); cit_a != clusters.end(); ++cit_a) {
-      for (auto cit_b = std::next(cit_a); cit_b != clusters.end(); ++cit_b) {
-        auto cluster_a = *cit_a;
-        auto cluster_b = *cit_b;
-        // do not create entries for cluster pairs that both have an
-        // intersection line, these are not to be merged if
-        // (cluster_a->has_intersection_line &&
-        // cluster_b->has_intersection_line) continue; push distance to heap
-        auto hhandle = distances.push(
-            ClusterPairDist(std::make_pair(cluster_a, cluster_b),
-                            cluster_a->distance(cluster_b.get())));
-        // store handle for both clusters
-        auto hh = std::make_shared<heap_handle>(hhandle);
-        cluster_to_dist_pairs[cluster_a].push_back(hh);
-        cluster_to_dist_pairs[cluster_b].push_back(hh);
+  void DistanceTable<ClusterH>::set_nearest(uint32_t cluster, uint32_t other,
+                                            double dist) {
+    nearest[cluster] = other;
+    nearest_dist[cluster] = dist;
+    if (other == npos) {
+      heap_erase(cluster);
+    } else {
+      nearest_of[other].push_back(cluster);
+      heap_update(cluster);
+    }
+  }
+
+  template <typename ClusterH>
+  void DistanceTable<ClusterH>::find_nearest(uint32_t cluster,
+                                             bool update_others) {
+    // clusters that are closer than the threshold have bounds that are closer
+    // than the bounds radius
+    ++query_cnt;
+    stamp[cluster] = query_cnt;
+    auto& lhs = handles[cluster];
+    uint32_t best = npos;
+    double best_dist = 0;
+    const auto [first, last] = buckets_of(lhs->key_range(), radius);
+    for (size_t b = first; b <= last; ++b) {
+      auto& bucket = buckets[b];
+      // drop the clusters that were merged into another one
+      std::erase_if(bucket, [this](uint32_t c) { return !alive[c]; });
+      for (auto other : bucket) {
+        if (stamp[other] == query_cnt) continue;
+        stamp[other] = query_cnt;
+        const double dist = lhs->distance(handles[other].get());
+        if (!(dist < threshold)) continue;
+        if (best == npos || dist < best_dist ||
+            (dist == best_dist &&
+             std::minmax(cluster, other) < std::minmax(cluster, best))) {
+          best = other;
+          best_dist = dist;
+        }
+        if (update_others && closer(other, dist, cluster)) {
+          set_nearest(other, cluster, dist);
+        }
       }
     }
+    set_nearest(cluster, best, best_dist);
   }
+
+  template <typename ClusterH>
+  bool DistanceTable<ClusterH>::heap_less(uint32_t lhs, uint32_t rhs) const {
+    if (nearest_dist[lhs] != nearest_dist[rhs])
+      return nearest_dist[lhs] < nearest_dist[rhs];
+    return std::minmax(lhs, nearest[lhs]) < std::minmax(rhs, nearest[rhs]);
+  }
+
+  template <typename ClusterH>
+  void DistanceTable<ClusterH>::heap_sift_up(size_t pos) {
+    const auto cluster = heap[pos];
+    while (pos > 0) {
+      const size_t parent = (pos - 1) / 2;
+      if (!heap_less(cluster, heap[parent])) break;
+      heap[pos] = heap[parent];
+      heap_pos[heap[pos]] = uint32_t(pos);
+      pos = parent;
+    }
+    heap[pos] = cluster;
+    heap_pos[cluster] = uint32_t(pos);
+  }
+
+  template <typename ClusterH>
+  void DistanceTable<ClusterH>::heap_sift_down(size_t pos) {
+    const auto cluster = heap[pos];
+    const size_t size = heap.size();
+    while (true) {
+      size_t child = 2 * pos + 1;
+      if (child >= size) break;
+      if (child + 1 < size && heap_less(heap[child + 1], heap[child])) ++child;
+      if (!heap_less(heap[child], cluster)) break;
+      heap[pos] = heap[child];
+      heap_pos[heap[pos]] = uint32_t(pos);
+      pos = child;
+    }
+    heap[pos] = cluster;
+    heap_pos[cluster] = uint32_t(pos);
+  }
+
+  template <typename ClusterH>
+  void DistanceTable<ClusterH>::heap_update(uint32_t cluster) {
+    if (heap_pos[cluster] == npos) {
+      heap.push_back(cluster);
+      heap_sift_up(heap.size() - 1);
+      return;
+    }
+    const size_t pos = heap_pos[cluster];
+    if (pos > 0 && heap_less(cluster, heap[(pos - 1) / 2])) {
+      heap_sift_up(pos);
+    } else {
+      heap_sift_down(pos);
+    }
+  }
+
+  template <typename ClusterH>
+  void DistanceTable<ClusterH>::heap_erase(uint32_t cluster) {
+    const size_t pos = heap_pos[cluster];
+    if (pos == npos) return;
+    heap_pos[cluster] = npos;
+    const auto last = heap.back();
+    heap.pop_back();
+    if (pos == heap.size()) return;
+    heap[pos] = last;
+    heap_pos[last] = uint32_t(pos);
+    heap_update(last);
+  }
+
   template <typename ClusterH>
   void DistanceTable<ClusterH>::merge(ClusterH lhs, ClusterH rhs) {
     // merges two clusters, then removes one from the distances map and update
@@ -143,47 +335,46 @@ namespace roofer::linereg {
     // rhs->has_intersection_line;
     lhs->calc_mean_value();
 
-    // iterate distancetable
-    // if rhs in pair: remove pair
-    // if lhs has intersection line and lhs in a pair: remove pair if the other
-    // cluster also has an intersection line. Since clusters that both have
-    // intersection line are not te be merged.
-    auto& rhs_hhandles = cluster_to_dist_pairs[rhs];
-    for (auto& hhandle : cluster_to_dist_pairs[rhs]) {
-      if (hhandle.use_count() == 2) {
-        distances.erase(*hhandle);
+    const auto l = index.at(lhs), r = index.at(rhs);
+    alive[r] = false;
+    heap_erase(r);
+    clusters.erase(rhs);
+    index.erase(rhs);
+    handles[r].reset();
+
+    // the clusters that had lhs or rhs as their nearest need a new search,
+    // since lhs has moved and rhs is gone
+    std::vector<uint32_t> affected;
+    for (auto c : {l, r}) {
+      for (auto other : nearest_of[c]) {
+        if (other != l && alive[other] && nearest[other] == c)
+          affected.push_back(other);
       }
+      nearest_of[c].clear();
     }
-    clusters.erase(rhs);
-    cluster_to_dist_pairs.erase(rhs);
-
-    auto& lhs_hhandles = cluster_to_dist_pairs[lhs];
-    auto i = lhs_hhandles.begin();
-    while (i != lhs_hhandles.end()) {
-      // we check the use count of the shared ptr to our heap handle. There
-      // should be exactly 2 for the case where both clusters still exist,
-      // otherwise one has been merged before and the heap handle was also
-      // erased before
-      if (i->use_count() != 2) {
-        lhs_hhandles.erase(i++);
-      } else {
-        // dereference 3 times! iterator->shared_ptr->heap_handle->heap_value
-        // Notice -> is not implemented on the heap_handle, so we must use * for
-        // the last dereference here
-        (***i).dist =
-            (***i).clusters.first->distance((***i).clusters.second.get());
-        distances.update(*(*i));
-        ++i;
+    nearest_of[r].shrink_to_fit();
+
+    // the value of lhs has changed, measure its distances again
+    add_to_buckets(l);
+    find_nearest(l, true);
+    for (auto other : affected) {
+      if (nearest[other] == l || nearest[other] == r) {
+        find_nearest(other, false);
       }
     }
   }
+
   template <typename ClusterH>
   typename DistanceTable<ClusterH>::ClusterPairDist
-  DistanceTable<ClusterH>::get_closest_pair() {
-    ClusterPairDist min_pair =
-        distances.top();  // distances.pop(); <- do not pop here; the node will
-                          // be removed later in the merge function!
-    return min_pair;
+  DistanceTable<ClusterH>::get_closest_pair() const {
+    const auto cluster = heap.front();
+    const auto [a, b] = std::minmax(cluster, nearest[cluster]);
+    return {{handles[a], handles[b]}, nearest_dist[cluster]};
+  }
+
+  template <typename ClusterH>
+  bool DistanceTable<ClusterH>::empty() const {
+    return heap.empty();
   }
 
   template class DistanceTable<AngleClusterH>;
@@ -202,13 +393,11 @@ namespace roofer::linereg {
 
     if (angle_clusters.size() > 1) {
       // make distance table
-      DistanceTable adt(angle_clusters);
+      DistanceTable adt(angle_clusters, angle_threshold);
 
-      auto apair = adt.get_closest_pair();
-      while (apair.dist < angle_threshold) {
+      while (!adt.empty()) {
+        auto apair = adt.get_closest_pair();
         adt.merge(apair.clusters.first, apair.clusters.second);
-        if (adt.distances.size() == 0) break;
-        apair = adt.get_closest_pair();
       }
     }
 
@@ -227,9 +416,14 @@ namespace roofer::linereg {
     // perform distance clustering for each angle cluster
     for (auto& aclusterh : angle_clusters) {
       std::set<DistClusterH> dclusters;
+      // the lines of the angle cluster have the direction
+      // (sin(angle), cos(angle)), see add_segments()
+      const std::array<double, 2> normal = {std::cos(aclusterh->value),
+                                            -std::sin(aclusterh->value)};
       for (auto& line : aclusterh->lines) {
         auto dclusterh = std::make_shared<DistCluster>();
         dclusterh->value = line->segment;
+        dclusterh->key_axis = normal;
         // dclusterh->has_intersection_line = line->priority==2;
         dclusterh->lines.push_back(line);
         dclusters.insert(dclusterh);
@@ -237,14 +431,12 @@ namespace roofer::linereg {
 
       if (dclusters.size() > 1) {
         // make distance table
-        DistanceTable ddt(dclusters);
+        DistanceTable ddt(dclusters, dist_threshold);
 
         // do clustering
-        auto dpair = ddt.get_closest_pair();
-        while (dpair.dist < dist_threshold) {
+        while (!ddt.empty()) {
+          auto dpair = ddt.get_closest_pair();
           ddt.merge(dpair.clusters.first, dpair.clusters.second);
-          if (ddt.distances.size() == 0) break;
-          dpair = ddt.get_closest_pair();
         }
       }
       dist_clusters.insert(dclusters.begin(), dclusters.end());
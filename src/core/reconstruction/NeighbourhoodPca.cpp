@@ -0,0 +1,167 @@
+// Copyright (c) 2018-2026 TU Delft 3D geoinformation group, Ravi Peters (3DGI),
+// and Balazs Dukai (3DGI)
+
+// This file is part of roofer (https://github.com/3DBAG/roofer)
+
+// geoflow-roofer was created as part of the 3DBAG project by the TU Delft 3D
+// geoinformation group (3d.bk.tudelf.nl) and 3DGI (3dgi.nl)
+
+// geoflow-roofer is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the Free
+// Software Foundation, either version 3 of the License, or (at your option) any
+// later version. geoflow-roofer is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+// Public License for more details. You should have received a copy of the GNU
+// General Public License along with geoflow-roofer. If not, see
+// <https://www.gnu.org/licenses/>.
+
+// Author(s):
+// Ravi Peters
+
+#include <CGAL/for_each.h>
+#include <CGAL/linear_least_squares_fitting_3.h>
+
+#include <algorithm>
+#include <array>
+#include <boost/range/counting_range.hpp>
+#include <roofer/reconstruction/NeighbourhoodPca.hpp>
+#include <roofer/reconstruction/cgal_shared_definitions.hpp>
+#include <vector>
+
+namespace roofer::reconstruction {
+
+  namespace {
+#ifdef CGAL_LINKED_WITH_TBB
+    typedef CGAL::Parallel_tag Concurrency_tag;
+#else
+    typedef CGAL::Sequential_tag Concurrency_tag;
+#endif
+
+    // number of points whose covariances are solved together
+    constexpr std::size_t block_size = 64;
+    // minimum l1 / l2 of a plane seed, well above the precision of the
+    // single precision eigenvalues
+    constexpr double collinear_tolerance = 1e-3;
+
+    // first and second order moments of a neighbourhood, relative to the
+    // query point
+    template <typename T>
+    struct Moments {
+      std::size_t count = 0;
+      std::array<T, 3> sum{};
+      std::array<T, 6> outer{};
+
+      void add(T dx, T dy, T dz) {
+        ++count;
+        sum[0] += dx;
+        sum[1] += dy;
+        sum[2] += dz;
+        outer[0] += dx * dx;
+        outer[1] += dx * dy;
+        outer[2] += dx * dz;
+        outer[3] += dy * dy;
+        outer[4] += dy * dz;
+        outer[5] += dz * dz;
+      }
+
+      std::array<T, 6> covariance(std::size_t n) const {
+        const T inv = n ? T(1) / T(n) : T(0);
+        return {outer[0] - sum[0] * sum[0] * inv,
+                outer[1] - sum[0] * sum[1] * inv,
+                outer[2] - sum[0] * sum[2] * inv,
+                outer[3] - sum[1] * sum[1] * inv,
+                outer[4] - sum[1] * sum[2] * inv,
+                outer[5] - sum[2] * sum[2] * inv};
+      }
+    };
+  }  // namespace
+
+  template <typename T>
+  void fit_neighbourhood_planes(std::span<const arr3f> points,
+                                const KnnGraph& graph, std::size_t normal_k,
+                                std::size_t seed_k, vec3f& normals,
+                                vec1f& seed_scores) {
+    const auto n = points.size();
+    normals.resize(n);
+    seed_scores.resize(n);
+    // the seed neighbourhood skips the point itself, which is the first
+    // entry of each row
+    const auto row_k = std::max(normal_k, seed_k + 1);
+
+    CGAL::for_each<Concurrency_tag>(
+        boost::counting_range(std::size_t(0),
+                              (n + block_size - 1) / block_size),
+        [&](std::size_t block) {
+          const auto first = block * block_size;
+          const auto count = std::min(block_size, n - first);
+          std::array<std::array<T, 6>, block_size> normal_cov, seed_cov;
+
+          // accumulate both neighbourhoods in one pass over each row
+          for (std::size_t b = 0; b < count; ++b) {
+            const auto& q = points[first + b];
+            const auto row = graph.neighbours(first + b, row_k);
+            Moments<T> moments, normal_moments, seed_moments;
+            for (std::size_t j = 0; j < row.size(); ++j) {
+              const auto& p = points[row[j]];
+              moments.add(T(p[0]) - q[0], T(p[1]) - q[1], T(p[2]) - q[2]);
+              if (j + 1 == normal_k) normal_moments = moments;
+              if (j == seed_k) seed_moments = moments;
+            }
+            if (row.size() < normal_k) normal_moments = moments;
+            if (row.size() <= seed_k) seed_moments = moments;
+            normal_cov[b] = normal_moments.covariance(normal_moments.count);
+            // the point itself is at the origin, so it only adds to the count
+            seed_cov[b] = seed_moments.covariance(
+                seed_moments.count ? seed_moments.count - 1 : 0);
+          }
+
+          std::array<T, 3> values, vector;
+          for (std::size_t b = 0; b < count; ++b) {
+            smallest_eigenvector(normal_cov[b], values, vector);
+            normals[first + b] = {float(vector[0]), float(vector[1]),
+                                  float(vector[2])};
+          }
+          for (std::size_t b = 0; b < count; ++b) {
+            // neighbourhoods that are collinear up to the precision of the
+            // eigenvalues are no plane seeds
+            T score = 0;
+            if (smallest_eigenvector(seed_cov[b], values, vector) &&
+                values[1] > T(collinear_tolerance) * values[2]) {
+              score = std::clamp(1 - values[0] / values[1], T(0), T(1));
+            }
+            seed_scores[first + b] = float(score);
+          }
+          return true;
+        });
+  }
+
+  void estimate_normals(std::span<const arr3f> points, const KnnGraph& graph,
+                        std::size_t k, vec3f& normals) {
+    normals.resize(points.size());
+    CGAL::for_each<Concurrency_tag>(
+        boost::counting_range(std::size_t(0), points.size()),
+        [&](std::size_t i) {
+          std::vector<Point> neighbour_points;
+          for (auto j : graph.neighbours(i, k)) {
+            const auto& p = points[j];
+            neighbour_points.emplace_back(p[0], p[1], p[2]);
+          }
+          Plane plane;
+          CGAL::linear_least_squares_fitting_3(
+              neighbour_points.begin(), neighbour_points.end(), plane,
+              CGAL::Dimension_tag<0>());
+          const auto n = plane.orthogonal_vector();
+          normals[i] = {float(n.x()), float(n.y()), float(n.z())};
+          return true;
+        });
+  }
+
+  template void fit_neighbourhood_planes<float>(std::span<const arr3f>,
+                                                const KnnGraph&, std::size_t,
+                                                std::size_t, vec3f&, vec1f&);
+  template void fit_neighbourhood_planes<double>(std::span<const arr3f>,
+                                                 const KnnGraph&, std::size_t,
+                                                 std::size_t, vec3f&, vec1f&);
+
+}  // namespace roofer::reconstruction
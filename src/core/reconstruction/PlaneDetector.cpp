@@ -30,8 +30,14 @@
 #include <algorithm>
 #include <cstddef>
 #include <functional>
+#include <memory_resource>
+#include <numeric>
+#include <roofer/common/memory_resource.hpp>
+#include <roofer/reconstruction/KnnGraph.hpp>
+#include <roofer/reconstruction/NeighbourhoodPca.hpp>
 #include <roofer/reconstruction/PlaneDetector.hpp>
 #include <roofer/reconstruction/PlaneDetectorBase.hpp>
+#include <span>
 #include <utility>
 
 // #include <CGAL/number_utils.h>
@@ -40,7 +46,6 @@
 // #include <CGAL/Exact_rational.h>
 
 #include <CGAL/mst_orient_normals.h>
-#include <CGAL/pca_estimate_normals.h>
 // #include <CGAL/point_generators_3.h>
 #include <CGAL/Orthogonal_k_neighbor_search.h>
 #include <CGAL/Search_traits_3.h>
@@ -48,48 +53,48 @@
 
 namespace roofer {
 
-  // Point with normal vector stored in a std::pair.
-  typedef boost::tuple<Point, Vector, int, bool, double, int, bool, double, int,
-                       bool>
-      PNL;
-  typedef CGAL::Nth_of_tuple_property_map<0, PNL> Point_map;
-  typedef CGAL::Nth_of_tuple_property_map<1, PNL> Normal_map;
-  typedef CGAL::Nth_of_tuple_property_map<2, PNL> Label_map;
-  typedef CGAL::Nth_of_tuple_property_map<3, PNL> IsWall_map;
-  typedef CGAL::Nth_of_tuple_property_map<4, PNL> LineFit_map;
-  typedef CGAL::Nth_of_tuple_property_map<5, PNL> JumpCount_map;
-  typedef CGAL::Nth_of_tuple_property_map<6, PNL> IsStep_map;
-  typedef CGAL::Nth_of_tuple_property_map<7, PNL> JumpEle_map;
-  typedef CGAL::Nth_of_tuple_property_map<8, PNL> Id_map;
-  typedef CGAL::Nth_of_tuple_property_map<9, PNL> IsHorizontal_map;
-  typedef std::vector<PNL> PNL_vector;
+  // The points of PlaneDetector::detect() are kept as a structure of arrays:
+  // the input coordinates, the normals and the plane ids. The CGAL algorithms
+  // that need a point range get the range of point indices, and the property
+  // maps below as views on the arrays.
+  struct Point_map {
+    using key_type = std::size_t;
+    using value_type = Point;
+    using reference = Point;
+    using category = boost::readable_property_map_tag;
+    const PointCollection* points = nullptr;
+    friend Point get(const Point_map& map, std::size_t i) {
+      const auto& p = (*map.points)[i];
+      return Point(p[0], p[1], p[2]);
+    }
+  };
+  struct Normal_map {
+    using key_type = std::size_t;
+    using value_type = Vector;
+    using reference = Vector;
+    using category = boost::readable_property_map_tag;
+    const vec3f* normals = nullptr;
+    friend Vector get(const Normal_map& map, std::size_t i) {
+      const auto& n = (*map.normals)[i];
+      return Vector(n[0], n[1], n[2]);
+    }
+  };
+  typedef std::vector<std::size_t> Index_range;
 
   struct AdjacencyFinder {
-    typedef CGAL::Search_traits_3<EPICK> Traits_base;
-    typedef CGAL::Search_traits_adapter<PNL, Point_map, Traits_base> TreeTraits;
-    typedef CGAL::Orthogonal_k_neighbor_search<TreeTraits> Neighbor_search;
-    typedef Neighbor_search::Tree Tree;
-
-    std::map<size_t, std::map<size_t, size_t>> adjacencies;
-
-    AdjacencyFinder(PNL_vector& points, size_t N = 15) {
-      Tree tree;
-      tree.insert(points.begin(), points.end());
+    std::pmr::map<size_t, std::pmr::map<size_t, size_t>> adjacencies{
+        scratch_resource()};
 
-      for (auto& pi : points) {
-        auto& p = boost::get<0>(pi);
-        auto& l = boost::get<2>(pi);
+    AdjacencyFinder(std::span<const int> plane_ids,
+                    const reconstruction::KnnGraph& graph, size_t N = 15) {
+      for (size_t i = 0; i < plane_ids.size(); ++i) {
+        auto l = plane_ids[i];
         if (l == 0) continue;  // skip unsegmented points
-        // std::cout << "pid:" << l << std::endl;
-        Neighbor_search search(tree, p, N + 1);
+        auto neighbours = graph.neighbours(i, N + 1);
         // skip the first point since it is identical to the query point
-        for (auto nb = search.begin() + 1; nb < search.end(); ++nb) {
-          // auto& p = boost::get<0>(pi);
-          auto l_nb = boost::get<2>(nb->first);
+        for (size_t j = 1; j < neighbours.size(); ++j) {
+          auto l_nb = plane_ids[neighbours[j]];
           if (l_nb == 0 || l_nb == l) continue;  // skip unsegmented neighbours
-          // std::cout << "dist:" << nb->second << std::endl;
-          // std::cout << "p_x:" << boost::get<2>(nb->first) << std::endl;
-          // std::cout << "pid_:" << l_nb << std::endl;
           if (l > l_nb) {
             adjacencies[l][l_nb]++;
           } else {
@@ -97,12 +102,6 @@ namespace roofer {
           }
         }
       }
-
-      // for(auto& [idl, value] : adjacencies) {
-      //   for(auto& [idh, cnt] : value) {
-      //     std::cout<< idl << ":" << idh << "-" << cnt << std::endl;
-      //   }
-      // }
     };
   };
 
@@ -123,25 +122,8 @@ namespace roofer {
       }
     }  // namespace
 
-// Concurrency
-#ifdef CGAL_LINKED_WITH_TBB
-    typedef CGAL::Parallel_tag Concurrency_tag;
-#else
-    typedef CGAL::Sequential_tag Concurrency_tag;
-#endif
-    // search tree
-    // typedef boost::tuple<Point_3,int> Point_and_int; typedef
-    // CGAL::Random_points_in_cube_3<Point_3> Random_points_iterator;
-    typedef CGAL::Search_traits_3<EPICK> Traits_base;
-    typedef CGAL::Search_traits_adapter<
-        PNL, CGAL::Nth_of_tuple_property_map<0, PNL>, Traits_base>
-        TreeTraits;
-    // typedef CGAL::Search_traits_3<SCK> TreeTraits;
-    typedef CGAL::Orthogonal_k_neighbor_search<TreeTraits> Neighbor_search;
-    typedef Neighbor_search::Tree Tree;
-
     typedef CGAL::Shape_detection::Efficient_RANSAC_traits<
-        EPICK, PNL_vector, Point_map, Normal_map>
+        EPICK, Index_range, Point_map, Normal_map>
         Traits;
     typedef CGAL::Shape_detection::Efficient_RANSAC<Traits> Efficient_ransac;
     typedef CGAL::Shape_detection::Plane<Traits> RansacPlane;
@@ -179,14 +161,14 @@ namespace roofer {
       using category =
           boost::readable_property_map_tag;  // The property map is used both
                                              // for reading and writing data
-      PNL_vector* plane_id;
-      Custom_plane_index_map(PNL_vector* plane_id = nullptr)
-          : plane_id(plane_id) {}
+      const std::pmr::vector<int>* plane_ids;
+      Custom_plane_index_map(const std::pmr::vector<int>* plane_ids = nullptr)
+          : plane_ids(plane_ids) {}
       // The get() function returns the object expected by the algorithm (here,
       // Plane) return plane based on point idx
       friend int get(const Custom_plane_index_map& map,
                      const std::size_t& idx) {
-        auto pid = boost::get<2>((*map.plane_id)[idx]);
+        auto pid = (*map.plane_ids)[idx];
         if (pid == 0)
           return -1;
         else
@@ -219,34 +201,31 @@ namespace roofer {
                   const PlaneDetectorConfig cfg) override {
         const auto normal_dot_product_threshold =
             normal_dot_product_from_angle_degrees(cfg.normal_angle_threshold);
-        // convert to cgal points with attributes
-        PNL_vector pnl_points;
-        for (auto& p : points) {
-          PNL pv;
-          boost::get<0>(pv) = Point(p[0], p[1], p[2]);
-          boost::get<2>(pv) = 0;
-          boost::get<3>(pv) = 0;
-          boost::get<9>(pv) = 0;
-          pnl_points.push_back(pv);
-        }
-        // estimate normals
-        if (points.size()) {
-          CGAL::pca_estimate_normals<Concurrency_tag>(
-              pnl_points, cfg.normal_neighbour_count,
-              CGAL::parameters::point_map(Point_map())
-                  .normal_map(Normal_map()));
+        // plane id of each point, 0 means unsegmented
+        std::pmr::vector<int> plane_ids(points.size(), 0, scratch_resource());
+        // one k-NN graph for the normal estimation, the region growing and
+        // the plane adjacencies
+        const auto knn_graph = compute_knn_graph(
+            points, std::max<size_t>(cfg.normal_neighbour_count,
+                                     cfg.plane_neighbour_count + 1));
+        vec3f normals;
+        vec1f seed_scores;
+        if (cfg.single_pass_pca) {
+          // estimate normals and rank the region growing seeds in one pass
+          fit_neighbourhood_planes(points, knn_graph,
+                                   cfg.normal_neighbour_count,
+                                   cfg.plane_neighbour_count, normals,
+                                   seed_scores);
+        } else {
+          // the seeds are ranked by PlaneDS::fit_plane()
+          estimate_normals(points, knn_graph, cfg.normal_neighbour_count,
+                           normals);
         }
         // orient normals upwards
-        auto up = Vector(0, 0, 1);
-        for (auto& pv : pnl_points) {
-          auto& n = boost::get<1>(pv);
-          if (n * up < 0) boost::get<1>(pv) = -n;
+        for (auto& n : normals) {
+          if (n[2] < 0) n = {-n[0], -n[1], -n[2]};
         }
 
-        PointCollection points_vec;
-        vec3f normals_vec;
-        points_vec.reserve(points.size());
-
         // IndexedPlanesWithPoints pts_per_roofplane;
         // size_t horiz_roofplane_cnt=0;
         // size_t slant_roofplane_cnt=0;
@@ -257,23 +236,11 @@ namespace roofer {
         std::vector<Plane> planes;
 
         if (!cfg.use_ransac) {
-          // convert to lists required by the planedetector class
-          // size_t i=0;
-
-          for (auto& pt : pnl_points) {
-            auto& p = boost::get<0>(pt);
-            auto& n = boost::get<1>(pt);
-            points_vec.push_back({float(CGAL::to_double(p.x())),
-                                  float(CGAL::to_double(p.y())),
-                                  float(CGAL::to_double(p.z()))});
-            normals_vec.push_back({float(CGAL::to_double(n.x())),
-                                   float(CGAL::to_double(n.y())),
-                                   float(CGAL::to_double(n.z()))});
-          }
           // perform plane detection
-          planedect::PlaneDS PDS(points_vec, normals_vec,
+          planedect::PlaneDS PDS(points, normals, knn_graph,
                                  cfg.plane_neighbour_count);
-          planedect::DistAndNormalTester DNTester(
+          PDS.seed_scores = std::move(seed_scores);
+          planedect::DistAndNormalTester<float> DNTester(
               cfg.plane_epsilon * cfg.plane_epsilon,
               normal_dot_product_threshold, cfg.refit_interval);
           regiongrower::RegionGrower<planedect::PlaneDS, planedect::PlaneRegion>
@@ -284,13 +251,13 @@ namespace roofer {
           }
           total_plane_cnt = R.regions.size();
 
-          for (auto region : R.regions) {
+          for (const auto& region : R.regions) {
             total_pt_cnt += region.inliers.size();
           }
 
           // classify horizontal/vertical planes using plane normals
           unsigned shape_id = 0;
-          for (auto region : R.regions) {
+          for (auto& region : R.regions) {
             if (region.get_region_id() == 0) continue;
 
             auto& plane = region.plane;
@@ -307,15 +274,13 @@ namespace roofer {
               planes.push_back(plane);
               std::vector<Point> segpts;
               for (auto& i : region.inliers) {
-                segpts.push_back(boost::get<0>(pnl_points[i]));
+                const auto& p = points[i];
+                segpts.push_back(Point(p[0], p[1], p[2]));
                 if (region.inliers.size() > cfg.min_plane_points * 4 ||
                     total_pt_cnt <= cfg.min_plane_points * 4) {
-                  roof_elevations.push_back(
-                      float(boost::get<0>(pnl_points[i]).z()));
+                  roof_elevations.push_back(p[2]);
                 }
-                boost::get<2>(pnl_points[i]) = shape_id;
-                boost::get<3>(pnl_points[i]) = is_wall;
-                boost::get<9>(pnl_points[i]) = is_horizontal;
+                plane_ids[i] = shape_id;
               }
               pts_per_roofplane[shape_id].second = segpts;
               pts_per_roofplane[shape_id].first = plane;
@@ -337,7 +302,10 @@ namespace roofer {
           // Instantiate shape detection engine.
           Efficient_ransac ransac;
           // Provide input data.
-          ransac.set_input(pnl_points);
+          Index_range point_indices(points.size());
+          std::iota(point_indices.begin(), point_indices.end(), 0);
+          ransac.set_input(point_indices, Point_map{&points},
+                           Normal_map{&normals});
           // Register planar shapes via template method.
           ransac.add_shape_factory<RansacPlane>();
 
@@ -374,12 +342,10 @@ namespace roofer {
               planes.push_back(plane);
               std::vector<Point> segpts;
               for (auto& i : shape->indices_of_assigned_points()) {
-                segpts.push_back(boost::get<0>(pnl_points[i]));
-                roof_elevations.push_back(
-                    float(boost::get<0>(pnl_points[i]).z()));
-                boost::get<2>(pnl_points[i]) = shape_id;
-                boost::get<3>(pnl_points[i]) = is_wall;
-                boost::get<9>(pnl_points[i]) = is_horizontal;
+                const auto& p = points[i];
+                segpts.push_back(Point(p[0], p[1], p[2]));
+                roof_elevations.push_back(p[2]);
+                plane_ids[i] = shape_id;
               }
               total_pt_cnt += segpts.size();
               pts_per_roofplane[shape_id].second = segpts;
@@ -398,13 +364,9 @@ namespace roofer {
           }
         }
 
-        // vec1i plane_id, is_wall, is_horizontal;
-        for (auto& p : pnl_points) {
-          auto pid = boost::get<2>(p);
+        for (auto pid : plane_ids) {
           if (pid == 0) ++unsegmented_pt_cnt;
           plane_id.push_back(pid);
-          // is_wall.push_back(boost::get<3>(p));
-          // is_horizontal.push_back(boost::get<9>(p));
         }
 
         // Plane regularisation
@@ -414,11 +376,13 @@ namespace roofer {
             cfg.regularise_coplanarity || cfg.regularise_axis_symmetry) {
           std::cout << "\nN planes before: " << pts_per_roofplane.size()
                     << std::endl;
+          Index_range point_indices(points.size());
+          std::iota(point_indices.begin(), point_indices.end(), 0);
           CGAL::Shape_regularization::Planes::regularize_planes(
-              planes, pnl_points,
+              planes, point_indices,
               CGAL::parameters::plane_map(Custom_plane_map())
-                  .point_map(Point_map())
-                  .plane_index_map(Custom_plane_index_map(&pnl_points))
+                  .point_map(Point_map{&points})
+                  .plane_index_map(Custom_plane_index_map(&plane_ids))
                   .maximum_angle(cfg.maximum_angle)
                   .maximum_offset(cfg.maximum_offset)
                   .regularize_parallelism(cfg.regularise_parallelism)
@@ -430,17 +394,12 @@ namespace roofer {
 
           std::unordered_map<Plane, std::vector<size_t>, PlaneHash>
               plane_merge_map;
-          size_t pt_i = 0;
-          for (auto& p : pnl_points) {
-            // std::cout << "pt_i=" << pt_i << std::endl;
-            auto pid = boost::get<2>(p);
-            // boost::get<2>(p) = 0;
-            // std::cout << "pid=" << pid << std::endl;
+          for (size_t pt_i = 0; pt_i < plane_ids.size(); ++pt_i) {
+            auto pid = plane_ids[pt_i];
             if (pid > 0) {
               const auto& pl = planes[pid - 1];
               plane_merge_map[pl].push_back(pt_i);
             }
-            ++pt_i;
           }
           std::cout << "plane_merge_map.size=" << plane_merge_map.size()
                     << std::endl;
@@ -456,9 +415,10 @@ namespace roofer {
               std::vector<Point> ptvec;
               ptvec.reserve(pt_i_vec.size());
               for (auto& pt_i : pt_i_vec) {
-                boost::get<2>(pnl_points[pt_i]) = plane_cnt;
+                const auto& p = points[pt_i];
+                plane_ids[pt_i] = plane_cnt;
                 plane_id[pt_i] = plane_cnt;
-                ptvec.push_back(boost::get<0>(pnl_points[pt_i]));
+                ptvec.push_back(Point(p[0], p[1], p[2]));
               }
               pts_per_roofplane[plane_cnt] = std::make_pair(plane, ptvec);
               ++plane_cnt;
@@ -469,8 +429,12 @@ namespace roofer {
 
         // END Regularize detected planes.
 
-        AdjacencyFinder adj_finder(pnl_points, cfg.plane_neighbour_count);
-        plane_adjacencies = adj_finder.adjacencies;
+        AdjacencyFinder adj_finder(plane_ids, knn_graph,
+                                   cfg.plane_neighbour_count);
+        plane_adjacencies.clear();
+        for (const auto& [l, adjacent] : adj_finder.adjacencies) {
+          plane_adjacencies[l].insert(adjacent.begin(), adjacent.end());
+        }
 
         // int roof_type=-2; // as built: -2=undefined; -1=no pts; 0=LOD1,
         // 1=LOD1.3, 2=LOD2
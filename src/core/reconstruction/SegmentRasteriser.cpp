@@ -19,53 +19,105 @@
 // Author(s):
 // Ravi Peters
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <roofer/reconstruction/SegmentRasteriser.hpp>
 // #include "spdlog/spdlog.h"
 
 namespace roofer::reconstruction {
 
   class SegmentRasteriser : public SegmentRasteriserInterface {
+    // Writes the maximum of each cell whose centre is in the triangle and
+    // the plane of the triangle at the centre. data_pixel_cnt counts the
+    // cells that had no data before. The cells of a row are found from the
+    // edge functions of the triangle, and the plane is evaluated
+    // incrementally along the row. These are not the cells of the former
+    // rasterise_polygon() scan lines, which also skipped triangles within
+    // one column.
+    void rasterise_triangle(const Triangle& triangle, RasterTools::Raster& r,
+                            size_t& data_pixel_cnt) {
+      // the vertices in cell units, counter-clockwise
+      std::array<double, 3> x, y, z;
+      for (size_t i = 0; i < 3; ++i) {
+        x[i] = (triangle[i][0] - r.minx_) / r.cellSize_;
+        y[i] = (triangle[i][1] - r.miny_) / r.cellSize_;
+        z[i] = triangle[i][2];
+      }
+      double area =
+          (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+      if (area < 0) {
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(z[1], z[2]);
+        area = -area;
+      }
+      // also skips vertical triangles, which have no plane z(x, y)
+      if (!(area > 0)) return;
+
+      // z = z[0] + dz_dx (x - x[0]) + dz_dy (y - y[0])
+      const double dz_dx =
+          ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) /
+          area;
+      const double dz_dy =
+          ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) /
+          area;
+
+      // rows whose centre row + 0.5 is in [min y, max y]
+      const auto [y_min, y_max] = std::minmax({y[0], y[1], y[2]});
+      const double row_first = std::max(0.0, std::ceil(y_min - 0.5));
+      const double row_last =
+          std::min(double(r.dimy_), std::floor(y_max - 0.5) + 1);
+
+      const float nodata = float(r.noDataVal_);
+      for (double row = row_first; row < row_last; ++row) {
+        const double cy = row + 0.5;
+        // the centre (col + 0.5, cy) is inside if the edge function of every
+        // edge i -> j, e(col) = e_0 + e_dx col, is not negative
+        double col_first = 0, col_last = double(r.dimx_);
+        for (size_t i = 0; i < 3; ++i) {
+          const size_t j = (i + 1) % 3;
+          const double e_dx = -(y[j] - y[i]);
+          const double e_0 = (x[j] - x[i]) * (cy - y[i]) + e_dx * (0.5 - x[i]);
+          if (e_dx > 0) {
+            col_first = std::max(col_first, std::ceil(-e_0 / e_dx));
+          } else if (e_dx < 0) {
+            col_last = std::min(col_last, std::floor(e_0 / -e_dx) + 1);
+          } else if (e_0 < 0) {
+            col_last = col_first;
+          }
+        }
+        if (!(col_first < col_last)) continue;
+
+        auto cell = r.row(size_t(row));
+        double z_col = z[0] + dz_dx * (col_first + 0.5 - x[0]) +
+                       dz_dy * (cy - y[0]);
+        for (size_t col = size_t(col_first); col < size_t(col_last); ++col) {
+          if (cell[col] == nodata) ++data_pixel_cnt;
+          if (cell[col] < z_col) cell[col] = float(z_col);
+          z_col += dz_dx;
+        }
+      }
+    }
     void rasterise_input(const TriangleCollection& triangle_collection,
                          RasterTools::Raster& r, size_t& data_pixel_cnt) {
-      typedef CGAL::Exact_predicates_inexact_constructions_kernel K;
       for (const auto& triangle : triangle_collection) {
-        CGAL::Plane_3<K> plane(
-            K::Point_3(triangle[0][0], triangle[0][1], triangle[0][2]),
-            K::Point_3(triangle[1][0], triangle[1][1], triangle[1][2]),
-            K::Point_3(triangle[2][0], triangle[2][1], triangle[2][2]));
-        roofer::Box box;
-        for (auto& p : triangle) {
-          box.add(p);
-        }
-        auto bb_min = box.min();
-        auto bb_max = box.max();
-        auto cr_min = r.getColRowCoord(bb_min[0], bb_min[1]);
-        auto cr_max = r.getColRowCoord(bb_max[0], bb_max[1]);
-
-        auto points_inside = r.rasterise_polygon(triangle, cr_min, cr_max);
-        for (auto& p : points_inside) {
-          double z_interpolate = -plane.a() / plane.c() * p[0] -
-                                 plane.b() / plane.c() * p[1] -
-                                 plane.d() / plane.c();
-          if (r.add_point(p[0], p[1], z_interpolate, RasterTools::MAX)) {
-            ++data_pixel_cnt;  // only count new cells (that were not written to
-                               // before)
-          }
-        }
-        // do plane projection
-        // auto& plane = pts_per_roofplane[roofplane_ids[i]].first;
-        // double z_interpolate = -plane.a()/plane.c() * p[0] -
-        // plane.b()/plane.c()*p[1] - plane.d()/plane.c(); r.add_point(p[0],
-        // p[1], z_interpolate, RasterTools::MAX);
+        rasterise_triangle(triangle, r, data_pixel_cnt);
+      }
+    }
+    void rasterise_input(const IndexedTriangleCollection& triangle_collection,
+                         RasterTools::Raster& r, size_t& data_pixel_cnt) {
+      const auto& vertices = triangle_collection.vertices;
+      for (const auto& t : triangle_collection.triangles) {
+        rasterise_triangle({vertices[t[0]], vertices[t[1]], vertices[t[2]]},
+                           r, data_pixel_cnt);
       }
     }
-    void compute(TriangleCollection& roof_triangles,
-                 TriangleCollection& ground_triangles,
-                 SegmentRasteriserConfig cfg) override {
-      // spdlog::debug("roof_triangles has {} triangles",
-      // roof_triangles.size()); spdlog::debug("ground_triangles has {}
-      // triangles", ground_triangles.size());
 
+    template <typename Triangles>
+    void compute_heightfield(Triangles& roof_triangles,
+                             Triangles& ground_triangles,
+                             const SegmentRasteriserConfig& cfg) {
       Box box;
       box.add(roof_triangles.box());
       if (cfg.use_ground && ground_triangles.size() > 0) {
@@ -95,23 +147,22 @@ namespace roofer::reconstruction {
 
       if (cfg.fill_nodata) heightfield.fill_nn(cfg.fill_nodata_window_size);
 
-      PointCollection grid_points;
-      vec1f values;
-      double nodata = heightfield.getNoDataVal();
-      for (size_t i = 0; i < heightfield.dimx_; ++i) {
-        for (size_t j = 0; j < heightfield.dimy_; ++j) {
-          auto p = heightfield.getPointFromRasterCoords(i, j);
-          if (p[2] != nodata) {
-            grid_points.push_back(p);
-            values.push_back(p[2]);
-          }
-        }
-      }
-      // spdlog::debug("heightfield has {} values", values.size());
       // output("data_area").set(float(roofdata_area_cnt)*cellsize_*cellsize_);
       // output("heightfield").set(r);
-      // output("values").set(values);
-      // output("grid_points").set(grid_points);
+    }
+
+    void compute(TriangleCollection& roof_triangles,
+                 TriangleCollection& ground_triangles,
+                 SegmentRasteriserConfig cfg) override {
+      // spdlog::debug("roof_triangles has {} triangles",
+      // roof_triangles.size()); spdlog::debug("ground_triangles has {}
+      // triangles", ground_triangles.size());
+      compute_heightfield(roof_triangles, ground_triangles, cfg);
+    }
+    void compute(IndexedTriangleCollection& roof_triangles,
+                 IndexedTriangleCollection& ground_triangles,
+                 SegmentRasteriserConfig cfg) override {
+      compute_heightfield(roof_triangles, ground_triangles, cfg);
     }
   };
 
@@ -49,19 +49,16 @@ namespace roofer::misc {
       linear_least_squares_fitting_3(pts.begin(), pts.end(), plane,
                                      CGAL::Dimension_tag<0>());
 
-      auto box = polygon.box();
-      auto bb_min = box.min();
-      auto bb_max = box.max();
-      auto cr_min = r.getColRowCoord(bb_min[0], bb_min[1]);
-      auto cr_max = r.getColRowCoord(bb_max[0], bb_max[1]);
-
-      auto points_inside = r.rasterise_polygon(polygon, cr_min, cr_max);
-      for (auto& p : points_inside) {
-        float z_interpolate = -plane.a() / plane.c() * p[0] -
-                              plane.b() / plane.c() * p[1] -
-                              plane.d() / plane.c();
-        r.add_point(p[0], p[1], z_interpolate, RasterTools::MAX);
-      }
+      const double a = -plane.a() / plane.c(), b = -plane.b() / plane.c(),
+                   d = -plane.d() / plane.c();
+      r.scan_ring(polygon, [&](size_t row, size_t col_begin, size_t col_end) {
+        auto cells = r.row(row);
+        const float y = r.miny_ + row * r.cellSize_ + r.cellSize_ / 2;
+        for (size_t col = col_begin; col < col_end; ++col) {
+          const float x = r.minx_ + col * r.cellSize_ + r.cellSize_ / 2;
+          cells[col] = std::max(cells[col], float(a * x + b * y + d));
+        }
+      });
     };
 
     void calculate_h_attr(Mesh& mesh, RasterTools::Raster& r_lod22,
@@ -69,35 +66,36 @@ namespace roofer::misc {
       auto& faces = mesh.get_polygons();
       auto& labels = mesh.get_labels();
       auto& attributes = mesh.get_attributes();
+      const float nodata = float(r_lod22.noDataVal_);
+      std::vector<float> heights;
       for (size_t i = 0; i < faces.size(); ++i) {
         if (labels[i] == 1) {
           auto& polygon = faces.at(i);
-          auto box = polygon.box();
-          auto bb_min = box.min();
-          auto bb_max = box.max();
-          auto cr_min = r_lod22.getColRowCoord(bb_min[0], bb_min[1]);
-          auto cr_max = r_lod22.getColRowCoord(bb_max[0], bb_max[1]);
-          auto part_points =
-              r_lod22.rasterise_polygon(polygon, cr_min, cr_max, false);
-
-          if (part_points.size() == 0) {
-            part_points.insert(part_points.begin(), polygon.begin(),
-                               polygon.end());
+          heights.clear();
+          r_lod22.scan_ring(
+              polygon, [&](size_t row, size_t col_begin, size_t col_end) {
+                auto cells = r_lod22.row(row);
+                for (size_t col = col_begin; col < col_end; ++col) {
+                  if (cells[col] != nodata) heights.push_back(cells[col]);
+                }
+              });
+
+          if (heights.size() == 0) {
+            for (auto& p : polygon) heights.push_back(p[2]);
           }
-          std::sort(part_points.begin(), part_points.end(),
-                    [](auto& p1, auto& p2) { return p1[2] < p2[2]; });
+          std::sort(heights.begin(), heights.end());
 
-          size_t N = part_points.size();
+          size_t N = heights.size();
           int elevation_id = std::floor(0.5 * float(N - 1));
           if (!cfg.h_50p.empty())
-            attributes[i].insert(
-                cfg.h_50p, float(part_points[elevation_id][2] + cfg.z_offset));
+            attributes[i].insert(cfg.h_50p,
+                                 float(heights[elevation_id] + cfg.z_offset));
           elevation_id = std::floor(0.7 * float(N - 1));
           if (!cfg.h_70p.empty())
-            attributes[i].insert(
-                cfg.h_70p, float(part_points[elevation_id][2] + cfg.z_offset));
-          auto h_min = float(part_points[0][2] + cfg.z_offset);
-          auto h_max = float(part_points[N - 1][2] + cfg.z_offset);
+            attributes[i].insert(cfg.h_70p,
+                                 float(heights[elevation_id] + cfg.z_offset));
+          auto h_min = float(heights[0] + cfg.z_offset);
+          auto h_max = float(heights[N - 1] + cfg.z_offset);
           if (!cfg.h_min.empty()) attributes[i].insert(cfg.h_min, h_min);
           if (!cfg.h_max.empty()) attributes[i].insert(cfg.h_max, h_max);
         }
@@ -26,7 +26,6 @@
 #include <random>
 #include <roofer/common/Raster.hpp>
 #include <roofer/common/datastructures.hpp>
-#include <roofer/common/GridPIPTester.hpp>
 #include <roofer/misc/PointcloudRasteriser.hpp>
 // #include <roofer/logger/logger.h>
 
@@ -63,18 +62,17 @@ namespace roofer::misc {
     std::vector<std::vector<float>> buckets(r_max.dimx_ * r_max.dimy_);
 
     if (use_footprint) {
-      auto fp_grid = GridPIPTester(footprint);
-
-      for (size_t col = 0; col < r_fp.dimx_; ++col) {
-        for (size_t row = 0; row < r_fp.dimy_; ++row) {
-          auto p = r_fp.getPointFromRasterCoords(col, row);
-          if (fp_grid.test(p)) {
-            r_fp.add_point(p[0], p[1], 1, RasterTools::MAX);
-          } else {
-            r_fp.add_point(p[0], p[1], 0, RasterTools::MAX);
-          }
-        }
-      }
+      // 1 for the cells whose centre is inside the footprint, 0 elsewhere
+      std::fill(r_fp.vals_.begin(), r_fp.vals_.end(), 0);
+      std::vector<vec3f> rings = {footprint};
+      rings.insert(rings.end(), footprint.interior_rings().begin(),
+                   footprint.interior_rings().end());
+      r_fp.scan_rings(rings,
+                      [&](size_t row, size_t col_begin, size_t col_end) {
+                        auto cells = r_fp.row(row);
+                        std::fill(cells.begin() + col_begin,
+                                  cells.begin() + col_end, 1);
+                      });
     }
 
     auto classification = pointcloud.attributes.get_if<int>("classification");
@@ -104,13 +102,13 @@ namespace roofer::misc {
     image_bundle["max"].min_y = r_max.miny_;
     image_bundle["max"].cellsize = r_max.cellSize_;
     image_bundle["max"].nodataval = r_max.noDataVal_;
-    image_bundle["max"].array = *r_max.vals_;
+    image_bundle["max"].array = r_max.vals_;
 
     image_bundle["min"] = image_bundle["max"];
     image_bundle["min"].nodataval = r_min.noDataVal_;
-    image_bundle["min"].array = *r_min.vals_;
+    image_bundle["min"].array = r_min.vals_;
     image_bundle["fp"] = image_bundle["max"];
-    image_bundle["fp"].array = *r_fp.vals_;
+    image_bundle["fp"].array = r_fp.vals_;
     image_bundle["cnt"] = image_bundle["max"],
     image_bundle["med"] = image_bundle["max"],
     image_bundle["avg"] = image_bundle["max"],
@@ -118,10 +116,10 @@ namespace roofer::misc {
     image_bundle["grp"] = image_bundle["max"];
     image_bundle["gp"] = image_bundle["max"];
     image_bundle["gp"].nodataval = r_ground_points.noDataVal_;
-    image_bundle["gp"].array = *r_ground_points.vals_;
+    image_bundle["gp"].array = r_ground_points.vals_;
     image_bundle["ngp"] = image_bundle["max"];
     image_bundle["ngp"].nodataval = r_non_ground_points.noDataVal_;
-    image_bundle["ngp"].array = *r_non_ground_points.vals_;
+    image_bundle["ngp"].array = r_non_ground_points.vals_;
 
     for (size_t row = 0; row < r_max.dimy_; ++row) {
       for (size_t col = 0; col < r_max.dimx_; ++col) {
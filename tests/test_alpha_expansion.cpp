@@ -0,0 +1,105 @@
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/reconstruction/AlphaExpansion.hpp>
+
+using roofer::reconstruction::AlphaExpansion;
+
+namespace {
+  struct Problem {
+    size_t node_count, label_count;
+    std::vector<double> costs;
+    std::vector<std::array<uint32_t, 2>> edges;
+    std::vector<double> weights;
+  };
+
+  Problem random_problem(std::mt19937& gen) {
+    Problem problem;
+    problem.node_count = 1 + gen() % 8;
+    problem.label_count = 1 + gen() % 4;
+    std::uniform_real_distribution<double> cost(0, 3), weight(0, 2);
+    problem.costs.resize(problem.node_count * problem.label_count);
+    for (auto& c : problem.costs) c = cost(gen);
+    const size_t edge_count = gen() % (2 * problem.node_count + 1);
+    for (size_t e = 0; e < edge_count; ++e) {
+      problem.edges.push_back({uint32_t(gen() % problem.node_count),
+                               uint32_t(gen() % problem.node_count)});
+      problem.weights.push_back(weight(gen));
+    }
+    return problem;
+  }
+
+  double energy(const Problem& problem, const std::vector<size_t>& labels) {
+    return AlphaExpansion::energy(problem.label_count, problem.costs,
+                                  problem.edges, problem.weights, labels);
+  }
+}  // namespace
+
+TEST_CASE("alpha-expansion ends in a minimum of all expansion moves") {
+  std::mt19937 gen(11);
+  // one solver for all problems, to cover the reuse of its buffers
+  AlphaExpansion solver;
+  for (int i = 0; i < 500; ++i) {
+    auto problem = random_problem(gen);
+    std::vector<size_t> labels(problem.node_count);
+    for (auto& l : labels) l = gen() % problem.label_count;
+    const double initial = energy(problem, labels);
+
+    const double result =
+        solver.solve(problem.node_count, problem.label_count, problem.costs,
+                     problem.edges, problem.weights, labels);
+    REQUIRE(result == Catch::Approx(energy(problem, labels)));
+    REQUIRE(result <= initial + 1e-12);
+
+    // no expansion of any label to any subset of the nodes is better
+    for (size_t alpha = 0; alpha < problem.label_count; ++alpha) {
+      for (size_t mask = 0; mask < (size_t(1) << problem.node_count); ++mask) {
+        auto moved = labels;
+        for (size_t p = 0; p < problem.node_count; ++p) {
+          if (mask >> p & 1) moved[p] = alpha;
+        }
+        REQUIRE(energy(problem, moved) >= result - 1e-9);
+      }
+    }
+  }
+}
+
+TEST_CASE("alpha-expansion smooths a noisy two label grid") {
+  // the left half of the grid prefers label 0 and the right half label 1,
+  // with the preference of one cell flipped
+  const size_t k = 8;
+  Problem problem{k * k, 2, {}, {}, {}};
+  for (size_t i = 0; i < k; ++i) {
+    for (size_t j = 0; j < k; ++j) {
+      const bool left = j < k / 2;
+      const bool flipped = i == 3 && j == 1;
+      problem.costs.push_back(left != flipped ? 0 : 1);
+      problem.costs.push_back(left != flipped ? 1 : 0);
+      if (j + 1 < k) {
+        problem.edges.push_back({uint32_t(i * k + j), uint32_t(i * k + j + 1)});
+        problem.weights.push_back(0.4);
+      }
+      if (i + 1 < k) {
+        problem.edges.push_back({uint32_t(i * k + j), uint32_t(i * k + j + k)});
+        problem.weights.push_back(0.4);
+      }
+    }
+  }
+  std::vector<size_t> labels(k * k, 1);
+  AlphaExpansion solver;
+  const double result =
+      solver.solve(problem.node_count, problem.label_count, problem.costs,
+                   problem.edges, problem.weights, labels);
+  for (size_t i = 0; i < k; ++i) {
+    for (size_t j = 0; j < k; ++j) {
+      CHECK(labels[i * k + j] == (j < k / 2 ? 0 : 1));
+    }
+  }
+  // the flipped cell and the cut between the halves
+  CHECK(result == Catch::Approx(1 + 0.4 * k));
+}
@@ -0,0 +1,196 @@
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/reconstruction/AlphaShaper.hpp>
+
+namespace {
+  using namespace roofer;
+  using namespace roofer::reconstruction;
+
+  // jittered grid points on the horizontal plane z, in [x0,x1] x [y0,y1],
+  // leaving out the points inside the hole box if it is given
+  std::vector<Point> grid(double x0, double x1, double y0, double y1, double z,
+                          unsigned seed,
+                          std::array<double, 4> hole = {0, 0, 0, 0}) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> jitter(-0.05, 0.05);
+    std::vector<Point> points;
+    for (double x = x0; x <= x1; x += 0.3) {
+      for (double y = y0; y <= y1; y += 0.3) {
+        const double px = x + jitter(gen), py = y + jitter(gen);
+        if (px > hole[0] && px < hole[1] && py > hole[2] && py < hole[3])
+          continue;
+        points.emplace_back(px, py, z);
+      }
+    }
+    return points;
+  }
+
+  void add_plane(IndexedPlanesWithPoints& planes, int id,
+                 std::vector<Point> points) {
+    const double z = points.front().z();
+    planes[id] = {Plane(0, 0, 1, -z), std::move(points)};
+  }
+
+  double ring_area(const LinearRing& ring) {
+    double area = ring.signed_area();
+    for (const auto& hole : ring.interior_rings()) {
+      LinearRing h;
+      h.insert(h.end(), hole.begin(), hole.end());
+      area += h.signed_area();
+    }
+    return area;
+  }
+
+  double mesh_area(const IndexedTriangleCollection& mesh) {
+    double area = 0;
+    for (const auto& t : mesh.triangles) {
+      const auto &a = mesh.vertices[t[0]], &b = mesh.vertices[t[1]],
+                 &c = mesh.vertices[t[2]];
+      area += ((b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1])) /
+              2;
+    }
+    return area;
+  }
+
+  double triangles_area(const TriangleCollection& triangles) {
+    double area = 0;
+    for (const auto& t : triangles) {
+      area += std::abs((t[1][0] - t[0][0]) * (t[2][1] - t[0][1]) -
+                       (t[2][0] - t[0][0]) * (t[1][1] - t[0][1])) /
+              2;
+    }
+    return area;
+  }
+
+  std::unique_ptr<AlphaShaperInterface> shapes_of(
+      const IndexedPlanesWithPoints& planes, bool shared,
+      AlphaShaperConfig cfg = AlphaShaperConfig()) {
+    cfg.shared_triangulation = shared;
+    auto shaper = createAlphaShaper();
+    shaper->compute(planes, cfg);
+    return shaper;
+  }
+}  // namespace
+
+TEST_CASE("shared triangulation alpha shapes of separate planes",
+          "[alpha_shaper]") {
+  IndexedPlanesWithPoints planes;
+  add_plane(planes, 0, grid(0, 10, 0, 8, 5, 1));
+  add_plane(planes, 1, grid(11, 20, 0, 8, 3, 2));
+
+  auto per_plane = shapes_of(planes, false);
+  auto shared = shapes_of(planes, true);
+
+  REQUIRE(shared->alpha_rings.size() == 2);
+  REQUIRE(per_plane->alpha_rings.size() == 2);
+  CHECK(shared->alpha_triangles.empty());
+  for (size_t i = 0; i < shared->alpha_rings.size(); ++i) {
+    const auto& ring = shared->alpha_rings[i];
+    CHECK(ring.signed_area() > 0);
+    CHECK(ring.interior_rings().empty());
+    for (const auto& p : ring) {
+      CHECK(p[2] == (shared->roofplane_ids[i] == 0 ? 5.F : 3.F));
+    }
+  }
+
+  // the planes are far enough apart for both modes to find the same shapes
+  double per_plane_area = 0, shared_area = 0;
+  for (const auto& ring : per_plane->alpha_rings) {
+    per_plane_area += ring_area(ring);
+  }
+  for (const auto& ring : shared->alpha_rings) {
+    shared_area += ring_area(ring);
+  }
+  CHECK(std::abs(shared_area - per_plane_area) < 1e-3 * per_plane_area);
+  CHECK(std::abs(mesh_area(shared->alpha_triangle_mesh) -
+                 triangles_area(per_plane->alpha_triangles)) <
+        1e-3 * per_plane_area);
+  CHECK(std::abs(mesh_area(shared->alpha_triangle_mesh) - shared_area) <
+        1e-3 * shared_area);
+}
+
+TEST_CASE("shared triangulation alpha shape with a hole", "[alpha_shaper]") {
+  IndexedPlanesWithPoints planes;
+  add_plane(planes, 7, grid(0, 10, 0, 10, 4, 3, {4, 6, 4, 6}));
+
+  auto shared = shapes_of(planes, true);
+  REQUIRE(shared->alpha_rings.size() == 1);
+  CHECK(shared->roofplane_ids[0] == 7);
+  const auto& ring = shared->alpha_rings[0];
+  CHECK(ring.signed_area() > 0);
+  REQUIRE(ring.interior_rings().size() == 1);
+  LinearRing hole;
+  hole.insert(hole.end(), ring.interior_rings()[0].begin(),
+              ring.interior_rings()[0].end());
+  CHECK(hole.signed_area() < 0);
+}
+
+TEST_CASE("shared triangulation alpha shapes of adjacent planes",
+          "[alpha_shaper]") {
+  // the second plane fills a notch in the first one, 0.2m apart
+  IndexedPlanesWithPoints planes;
+  add_plane(planes, 0, grid(0, 10, 0, 10, 6, 4, {3, 7, 5, 11}));
+  add_plane(planes, 1, grid(3.2, 6.8, 5.2, 10, 8, 5));
+
+  auto shared = shapes_of(planes, true);
+  REQUIRE(shared->alpha_rings.size() == 2);
+  double ring_areas = 0;
+  for (const auto& ring : shared->alpha_rings) {
+    CHECK(ring.interior_rings().empty());
+    ring_areas += ring_area(ring);
+  }
+  // the faces between the two planes are in neither alpha shape, so the
+  // triangles cover the union of the planes at most once
+  const double area = mesh_area(shared->alpha_triangle_mesh);
+  CHECK(std::abs(area - ring_areas) < 1e-3 * area);
+  CHECK(area < 10.2 * 10.2 - 0.2 * 4.8);
+}
+
+TEST_CASE("shared triangulation results do not depend on the parallel "
+          "threshold",
+          "[alpha_shaper]") {
+  IndexedPlanesWithPoints planes;
+  add_plane(planes, 0, grid(0, 10, 0, 8, 5, 6));
+  add_plane(planes, 1, grid(11, 20, 0, 8, 3, 7, {14, 16, 3, 5}));
+  add_plane(planes, 2, grid(0, 20, 9, 12, 4, 8));
+
+  AlphaShaperConfig sequential, parallel;
+  sequential.parallel_plane_points = 1 << 30;
+  parallel.parallel_plane_points = 1;
+  auto a = shapes_of(planes, true, sequential);
+  auto b = shapes_of(planes, true, parallel);
+
+  CHECK(a->roofplane_ids == b->roofplane_ids);
+  REQUIRE(a->alpha_rings.size() == b->alpha_rings.size());
+  for (size_t i = 0; i < a->alpha_rings.size(); ++i) {
+    CHECK(static_cast<const vec3f&>(a->alpha_rings[i]) ==
+          static_cast<const vec3f&>(b->alpha_rings[i]));
+    CHECK(a->alpha_rings[i].interior_rings() ==
+          b->alpha_rings[i].interior_rings());
+  }
+  CHECK(a->alpha_triangle_mesh.vertices == b->alpha_triangle_mesh.vertices);
+  CHECK(a->alpha_triangle_mesh.triangles == b->alpha_triangle_mesh.triangles);
+}
+
+TEST_CASE("shared triangulation optimal alpha joins the parts of a plane",
+          "[alpha_shaper]") {
+  // two patches of one plane with a 1.5m gap, that is too wide for the
+  // default alpha
+  std::vector<Point> points = grid(0, 5, 0, 5, 2, 9);
+  for (const auto& p : grid(6.5, 10, 0, 5, 2, 10)) points.push_back(p);
+  IndexedPlanesWithPoints planes;
+  add_plane(planes, 0, points);
+
+  AlphaShaperConfig cfg;
+  CHECK(shapes_of(planes, true, cfg)->alpha_rings.size() == 2);
+  cfg.optimal_alpha = true;
+  CHECK(shapes_of(planes, true, cfg)->alpha_rings.size() == 1);
+  CHECK(shapes_of(planes, false, cfg)->alpha_rings.size() == 1);
+}
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/reconstruction/ArrangementBase.hpp>
+#include <roofer/reconstruction/ArrangementBuilder.hpp>
+
+namespace {
+  using roofer::Arrangement_2;
+  using roofer::EPECK;
+
+  roofer::LinearRing footprint_with_hole() {
+    roofer::LinearRing footprint;
+    footprint.push_back({0, 0, 0});
+    footprint.push_back({10, 0, 0});
+    footprint.push_back({10, 10, 0});
+    footprint.push_back({0, 10, 0});
+    roofer::vec3f hole;
+    hole.push_back({6, 1, 0});
+    hole.push_back({6, 3, 0});
+    hole.push_back({9, 3, 0});
+    hole.push_back({9, 1, 0});
+    footprint.interior_rings().push_back(hole);
+    return footprint;
+  }
+
+  std::vector<EPECK::Segment_2> roof_lines() {
+    using P = EPECK::Point_2;
+    return {EPECK::Segment_2(P(-1, 5.3), P(11, 5.3)),
+            EPECK::Segment_2(P(4.4, -1), P(4.4, 11)),
+            EPECK::Segment_2(P(0.2, 0.6), P(9.7, 9.9))};
+  }
+
+  std::vector<EPECK::Segment_2> random_roof_lines(size_t n) {
+    using P = EPECK::Point_2;
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<double> pos(-1, 11), len(1, 6);
+    std::uniform_int_distribution<int> direction(0, 7);
+    std::vector<EPECK::Segment_2> lines;
+    for (size_t i = 0; i < n; ++i) {
+      const double angle = direction(gen) * std::numbers::pi / 8;
+      const double x = pos(gen), y = pos(gen), l = len(gen);
+      lines.emplace_back(
+          P(x, y), P(x + l * std::cos(angle), y + l * std::sin(angle)));
+    }
+    return lines;
+  }
+
+  Arrangement_2 build(bool snap_rounding, bool incremental_insert = true,
+                      std::vector<EPECK::Segment_2> lines = roof_lines()) {
+    auto footprint = footprint_with_hole();
+    roofer::reconstruction::ArrangementBuilderConfig cfg;
+    cfg.snap_rounding = snap_rounding;
+    cfg.incremental_insert = incremental_insert;
+    Arrangement_2 arrangement;
+    roofer::reconstruction::createArrangementBuilder()->compute(
+        arrangement, footprint, lines, cfg);
+    return arrangement;
+  }
+
+  struct FaceCounts {
+    size_t in_footprint = 0;
+    size_t footprint_hole = 0;
+  };
+
+  FaceCounts count_faces(const Arrangement_2& arrangement) {
+    FaceCounts counts;
+    for (auto& face : arrangement.face_handles()) {
+      if (face->data().in_footprint) ++counts.in_footprint;
+      if (face->data().is_footprint_hole) ++counts.footprint_hole;
+    }
+    return counts;
+  }
+}  // namespace
+
+TEST_CASE("snap rounded arrangement has the topology of the exact one") {
+  auto exact = build(false);
+  auto rounded = build(true);
+
+  REQUIRE(exact.is_valid());
+  REQUIRE(rounded.is_valid());
+  CHECK(rounded.number_of_vertices() == exact.number_of_vertices());
+  CHECK(rounded.number_of_edges() == exact.number_of_edges());
+  CHECK(rounded.number_of_faces() == exact.number_of_faces());
+
+  auto exact_counts = count_faces(exact);
+  auto rounded_counts = count_faces(rounded);
+  CHECK(rounded_counts.in_footprint == exact_counts.in_footprint);
+  CHECK(rounded_counts.footprint_hole == exact_counts.footprint_hole);
+  CHECK(rounded_counts.footprint_hole == 1);
+}
+
+TEST_CASE("batch insertion labels the faces like incremental insertion") {
+  auto lines = random_roof_lines(250);
+  auto batch = build(false, false, lines);
+  auto incremental = build(false, true, lines);
+
+  REQUIRE(batch.is_valid());
+  auto batch_counts = count_faces(batch);
+  auto incremental_counts = count_faces(incremental);
+  CHECK(batch_counts.in_footprint == incremental_counts.in_footprint);
+  CHECK(batch_counts.footprint_hole == incremental_counts.footprint_hole);
+
+  // the faces outside the footprint differ, because the lines are clipped to
+  // the footprint bounds before the sweep
+  auto footprint_faces = [](Arrangement_2& arrangement) {
+    std::vector<std::pair<double, bool>> faces;
+    for (auto face : arrangement.face_handles()) {
+      if (!face->data().in_footprint && !face->data().is_footprint_hole)
+        continue;
+      const double area = CGAL::to_double(
+          roofer::reconstruction::arr_cell2polygon(face).area());
+      faces.emplace_back(std::round(area * 1e6) / 1e6,
+                         face->data().is_footprint_hole);
+    }
+    std::sort(faces.begin(), faces.end());
+    return faces;
+  };
+  CHECK(footprint_faces(batch) == footprint_faces(incremental));
+}
+
+TEST_CASE("snap rounded arrangement has its vertices on pixel centres") {
+  auto rounded = build(true);
+  const double pixel_size = 0.001;
+  for (auto& v : rounded.vertex_handles()) {
+    for (double c : {CGAL::to_double(v->point().x()),
+                     CGAL::to_double(v->point().y())}) {
+      const double centre = (std::floor(c / pixel_size) + 0.5) * pixel_size;
+      CHECK(std::abs(c - centre) < 1e-9);
+    }
+  }
+}
@@ -1,7 +1,12 @@
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <tuple>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <roofer/reconstruction/ArrangementBase.hpp>
 #include <roofer/reconstruction/ArrangementDissolver.hpp>
 #include <roofer/reconstruction/ElevationProvider.hpp>
 
@@ -31,6 +36,69 @@ namespace {
     raster.prefill_arrays(roofer::RasterTools::MIN);
     return raster;
   }
+
+  // Four strips of a 10 by 10 square, split at x = 3, 5 and 7. The strips
+  // left of x = 5 belong to the same segment, so that the segment edges are
+  // dissolved for LoD 2.2. The step at x = 5 is below and the one at x = 7
+  // above the LoD 1.3 step height.
+  constexpr std::array<double, 4> strip_ends = {3, 5, 7, 10};
+  constexpr std::array<int, 4> strip_segids = {1, 1, 2, 3};
+  constexpr std::array<float, 4> strip_heights = {5, 5, 6, 12};
+
+  size_t strip_at(double x) {
+    size_t i = 0;
+    while (i + 1 < strip_ends.size() && x > strip_ends[i]) ++i;
+    return i;
+  }
+
+  roofer::Arrangement_2 stepped_arrangement() {
+    using roofer::Point_2;
+    using roofer::Segment_2;
+
+    auto arrangement = square_arrangement();
+    for (size_t i = 0; i + 1 < strip_ends.size(); ++i) {
+      CGAL::insert(arrangement, Segment_2(Point_2(strip_ends[i], 0),
+                                          Point_2(strip_ends[i], 10)));
+    }
+    for (auto face : arrangement.face_handles()) {
+      if (face->is_unbounded()) continue;
+      const auto bbox = roofer::reconstruction::arr_cell2polygon(face).bbox();
+      const size_t i = strip_at((bbox.xmin() + bbox.xmax()) / 2);
+      face->data().in_footprint = true;
+      face->data().segid = strip_segids[i];
+      face->data().plane = roofer::Plane(0, 0, 1, -strip_heights[i]);
+    }
+    return arrangement;
+  }
+
+  roofer::RasterTools::Raster stepped_heightfield() {
+    roofer::RasterTools::Raster raster(0.5, 0, 10, 0, 10);
+    raster.prefill_arrays(roofer::RasterTools::MIN);
+    for (size_t row = 0; row < raster.dimy_; ++row) {
+      for (size_t col = 0; col < raster.dimx_; ++col) {
+        const auto p = raster.getPointFromRasterCoords(col, row);
+        raster.set_val(col, row, strip_heights[strip_at(p[0])]);
+      }
+    }
+    return raster;
+  }
+
+  // area and elevations of the roof faces, in a stable order
+  std::vector<std::array<double, 6>> roof_faces(
+      const roofer::Arrangement_2& arrangement) {
+    std::vector<std::array<double, 6>> faces;
+    for (auto face : arrangement.face_handles()) {
+      if (!face->data().in_footprint) continue;
+      const double area = CGAL::to_double(
+          roofer::reconstruction::arr_cell2polygon(face).area());
+      const auto& data = face->data();
+      faces.push_back({std::round(area * 1e6) / 1e6, data.elevation_50p,
+                       data.elevation_70p, data.elevation_97p,
+                       data.elevation_min, data.elevation_max});
+    }
+    std::sort(faces.begin(), faces.end());
+    return faces;
+  }
 }  // namespace
 
 TEST_CASE("terrain clipping marks a boundary subface as ground") {
@@ -90,3 +158,142 @@ TEST_CASE("terrain clipping marks an enclosed subface as a footprint hole") {
   }
   CHECK(enclosed_ground_faces == 1);
 }
+
+TEST_CASE("terrain clipping can be skipped for a derived LoD") {
+  auto arrangement = square_arrangement();
+  for (auto face : arrangement.face_handles()) {
+    if (!face->is_unbounded()) face->data().plane = roofer::Plane(1, 0, -1, 0);
+  }
+
+  auto elevation_provider =
+      roofer::reconstruction::createElevationProvider(5.0F);
+  auto dissolver = roofer::reconstruction::createArrangementDissolver();
+  auto heightfield = empty_heightfield();
+  dissolver->compute(arrangement, heightfield, *elevation_provider,
+                     {.dissolve_segment_edges = false,
+                      .dissolve_outside_footprint = false,
+                      .clip_to_terrain = false});
+
+  size_t roof_faces = 0;
+  for (auto face : arrangement.face_handles()) {
+    if (face->is_unbounded()) continue;
+    CHECK_FALSE(face->data().is_ground);
+    if (face->data().in_footprint) ++roof_faces;
+  }
+  CHECK(roof_faces == 1);
+}
+
+TEST_CASE("dissolving step edges merges the elevations of the faces") {
+  using roofer::Point_2;
+  using roofer::Segment_2;
+
+  // two halves of a square, at 10 and 11 m, below the step height threshold
+  auto arrangement = square_arrangement();
+  CGAL::insert(arrangement, Segment_2(Point_2(5, 0), Point_2(5, 10)));
+  for (auto face : arrangement.face_handles()) {
+    if (face->is_unbounded()) continue;
+    double x_sum = 0;
+    size_t n = 0;
+    auto edge = face->outer_ccb();
+    do {
+      x_sum += CGAL::to_double(edge->source()->point().x());
+      ++n;
+    } while (++edge != face->outer_ccb());
+    const bool left = x_sum / double(n) < 5;
+    face->data().in_footprint = true;
+    face->data().segid = left ? 1 : 2;
+    face->data().plane = roofer::Plane(0, 0, 1, left ? -10 : -11);
+  }
+
+  auto heightfield = empty_heightfield();
+  for (size_t row = 0; row < heightfield.dimy_; ++row) {
+    for (size_t col = 0; col < heightfield.dimx_; ++col) {
+      heightfield.set_val(col, row, col < 6 ? 10 : 11);
+    }
+  }
+  auto elevation_provider =
+      roofer::reconstruction::createElevationProvider(0.0F);
+  auto dissolver = roofer::reconstruction::createArrangementDissolver();
+  roofer::reconstruction::ArrangementDissolverConfig config{
+      .dissolve_segment_edges = false,
+      .dissolve_outside_footprint = false,
+      .dissolve_step_edges = true};
+
+  SECTION("rasterising each face") {
+    dissolver->compute(arrangement, heightfield, *elevation_provider, config);
+
+    size_t roof_faces = 0;
+    for (auto face : arrangement.face_handles()) {
+      if (!face->data().in_footprint) continue;
+      ++roof_faces;
+      // 10 rows of 11 cells, both edge columns included, 50 of them at 10 m
+      CHECK(face->data().pixel_count == 110);
+      CHECK(face->data().data_coverage == 1);
+      CHECK(face->data().elevation_min == 10);
+      CHECK(face->data().elevation_50p == 11);
+      CHECK(face->data().elevation_70p == 11);
+      CHECK(face->data().elevation_max == 11);
+    }
+    CHECK(roof_faces == 1);
+  }
+
+  SECTION("with a face label raster") {
+    config.face_label_raster = true;
+    dissolver->compute(arrangement, heightfield, *elevation_provider, config);
+
+    size_t roof_faces = 0;
+    for (auto face : arrangement.face_handles()) {
+      if (!face->data().in_footprint) continue;
+      ++roof_faces;
+      // the cell centres in the square, half of them on each side
+      CHECK(face->data().pixel_count == 100);
+      CHECK(face->data().data_coverage == 1);
+      CHECK(face->data().elevation_min == 10);
+      CHECK(face->data().elevation_50p == 10);
+      CHECK(face->data().elevation_70p == 11);
+      CHECK(face->data().elevation_max == 11);
+    }
+    CHECK(roof_faces == 1);
+  }
+}
+
+TEST_CASE("LoDs derived from the LoD 2.2 dissolve match independent ones") {
+  using roofer::reconstruction::ArrangementDissolverConfig;
+  auto elevation_provider =
+      roofer::reconstruction::createElevationProvider(0.0F);
+  auto dissolver = roofer::reconstruction::createArrangementDissolver();
+  const auto heightfield = stepped_heightfield();
+
+  ArrangementDissolverConfig lod13_config;
+  lod13_config.dissolve_step_edges = true;
+  ArrangementDissolverConfig lod12_config;
+  lod12_config.dissolve_all_interior = true;
+
+  // each LoD dissolved from the optimised arrangement
+  auto independent_lod13 = stepped_arrangement();
+  dissolver->compute(independent_lod13, heightfield, *elevation_provider,
+                     lod13_config);
+  auto independent_lod12 = stepped_arrangement();
+  dissolver->compute(independent_lod12, heightfield, *elevation_provider,
+                     lod12_config);
+
+  // LoD 1.3 from the LoD 2.2 result, and LoD 1.2 from the LoD 1.3 result
+  auto lod22 = stepped_arrangement();
+  dissolver->compute(lod22, heightfield, *elevation_provider);
+  CHECK(roof_faces(lod22).size() == 3);
+  for (auto* config : {&lod13_config, &lod12_config}) {
+    config->dissolve_segment_edges = false;
+    config->clip_to_terrain = false;
+  }
+  auto derived_lod13 = lod22;
+  dissolver->compute(derived_lod13, heightfield, *elevation_provider,
+                     lod13_config);
+  auto derived_lod12 = derived_lod13;
+  dissolver->compute(derived_lod12, heightfield, *elevation_provider,
+                     lod12_config);
+
+  CHECK(roof_faces(independent_lod13).size() == 2);
+  CHECK(roof_faces(derived_lod13) == roof_faces(independent_lod13));
+  CHECK(roof_faces(independent_lod12).size() == 1);
+  CHECK(roof_faces(derived_lod12) == roof_faces(independent_lod12));
+}
@@ -192,6 +192,43 @@ namespace {
     return arrangement;
   }
 
+  // Two roof faces with a sliver between them, of which the sides are at
+  // x = 10 / 3 and at the double closest to it. Both sides round to the same
+  // constraint of the triangulation, so the flood fill reaches the triangles
+  // on either side of it from two faces.
+  Arrangement_2 rounded_sliver_arrangement() {
+    Arrangement_2 arrangement;
+    const std::array<Point_2, 4> corners = {Point_2(0, 0), Point_2(10, 0),
+                                            Point_2(10, 10), Point_2(0, 10)};
+    for (std::size_t i = 0; i < corners.size(); ++i) {
+      CGAL::insert(arrangement,
+                   Segment_2(corners[i], corners[(i + 1) % corners.size()]));
+    }
+    const roofer::EPECK::FT exact_x = roofer::EPECK::FT(10) / 3;
+    const roofer::EPECK::FT rounded_x = CGAL::to_double(exact_x);
+    REQUIRE(exact_x != rounded_x);
+    CGAL::insert(arrangement,
+                 Segment_2(Point_2(exact_x, 0), Point_2(exact_x, 10)));
+    CGAL::insert(arrangement,
+                 Segment_2(Point_2(rounded_x, 0), Point_2(rounded_x, 10)));
+
+    auto set_roof = [&](const Point_2& sample, int segid, double height) {
+      auto face = face_at(arrangement, sample);
+      face->data().in_footprint = true;
+      face->data().segid = segid;
+      face->data().plane = roofer::Plane(0, 0, 1, -height);
+    };
+    set_roof(Point_2(1, 5), 1, 10);
+    set_roof(Point_2(9, 5), 2, 12);
+    set_roof(Point_2((exact_x + rounded_x) / 2, 5), 3, 5);
+
+    arrangement.unbounded_face()->data().in_footprint = false;
+    arrangement.unbounded_face()->data().segid = 0;
+    arrangement.unbounded_face()->data().plane = roofer::Plane(0, 0, 1, 0);
+
+    return arrangement;
+  }
+
   Arrangement_2::Vertex_handle vertex_at(Arrangement_2& arrangement,
                                          const Point_2& point) {
     for (auto vertex : arrangement.vertex_handles()) {
@@ -389,6 +426,41 @@ TEST_CASE("snapper preserves a manifold four-way roof junction") {
   CHECK(center->degree() == 4);
 }
 
+TEST_CASE("snapper labels the faces by flood fill and times its phases") {
+  auto arrangement = cross_arrangement({0, 1, 2, 3});
+  auto snapper = roofer::reconstruction::createArrangementSnapper();
+  snapper->compute(arrangement, {.distance_threshold = 0.001F,
+                                 .repair_non_manifold_vertices = false});
+
+  CHECK(face_at(arrangement, Point_2(7.5, 7.5))->data().segid == 1);
+  CHECK(face_at(arrangement, Point_2(2.5, 7.5))->data().segid == 2);
+  CHECK(face_at(arrangement, Point_2(2.5, 2.5))->data().segid == 3);
+  CHECK(face_at(arrangement, Point_2(7.5, 2.5))->data().segid == 4);
+  for (const auto& elapsed : snapper->phase_timings) {
+    CHECK(elapsed.count() >= 0.0);
+  }
+}
+
+TEST_CASE("snapper labels by the overlap when the flood fill is ambiguous") {
+  // the sliver has no triangles, and the flood fill reaches the triangles
+  // next to it from the sliver as well, so the labels of the flood fill are
+  // dropped and each region takes the face that it overlaps most
+  auto arrangement = rounded_sliver_arrangement();
+  auto snapper = roofer::reconstruction::createArrangementSnapper();
+  snapper->compute(arrangement, {.distance_threshold = 0.001F,
+                                 .repair_non_manifold_vertices = false});
+
+  CHECK(face_at(arrangement, Point_2(1, 5))->data().segid == 1);
+  CHECK(face_at(arrangement, Point_2(9, 5))->data().segid == 2);
+  std::size_t roof_faces = 0;
+  for (auto face : arrangement.face_handles()) {
+    if (!face->data().in_footprint) continue;
+    ++roof_faces;
+    CHECK(face->data().segid != 3);
+  }
+  CHECK(roof_faces == 2);
+}
+
 TEST_CASE("snapper repairs a repeated-face junction") {
   auto arrangement = repeated_face_arrangement();
   auto repeated_segid = face_at(arrangement, Point_2(7.5, 7.5))->data().segid;
@@ -0,0 +1,87 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/reconstruction/FaceLabelRaster.hpp>
+
+using roofer::vec2f;
+using roofer::RasterTools::Raster;
+using roofer::reconstruction::face_plane_costs;
+using roofer::reconstruction::FaceLabelRaster;
+
+TEST_CASE("face labels partition the cells of faces with shared edges") {
+  // the shared edges pass through cell centres
+  Raster grid(1, 0, 9, 0, 9);
+  const std::vector<std::vector<vec2f>> faces = {
+      {{{0, 0}, {5.5, 0}, {5.5, 10}, {0, 10}}},
+      {{{5.5, 0}, {10, 0}, {10, 4.5}, {5.5, 10}}},
+      {{{10, 4.5}, {10, 10}, {5.5, 10}}}};
+
+  std::vector<int> hits(grid.dimx_ * grid.dimy_, 0);
+  for (size_t i = 0; i < faces.size(); ++i) {
+    FaceLabelRaster face_raster(grid);
+    face_raster.add_face(faces[i], int32_t(i));
+    for (size_t c = 0; c < hits.size(); ++c) {
+      if (face_raster.vals_[c] == int32_t(i)) ++hits[c];
+    }
+  }
+  for (auto count : hits) CHECK(count == 1);
+}
+
+TEST_CASE("face labels leave the cells of a hole to the face inside it") {
+  Raster grid(1, 0, 9, 0, 9);
+  const vec2f hole = {{2, 2}, {2, 6}, {6, 6}, {6, 2}};
+  FaceLabelRaster face_raster(grid);
+  face_raster.add_face({{{1, 1}, {9, 1}, {9, 9}, {1, 9}}, hole}, 0);
+  for (size_t row = 2; row < 6; ++row) {
+    for (size_t col = 2; col < 6; ++col) {
+      CHECK(face_raster.row(row)[col] == FaceLabelRaster::no_face);
+    }
+  }
+  CHECK(face_raster.row(1)[1] == 0);
+  CHECK(face_raster.row(8)[8] == 0);
+  CHECK(face_raster.row(0)[0] == FaceLabelRaster::no_face);
+
+  face_raster.add_face({hole}, 1);
+  CHECK(face_raster.row(3)[3] == 1);
+}
+
+TEST_CASE("face plane costs sum the distances to each plane") {
+  Raster heightfield(1, 0, 9, 0, 9);
+  heightfield.prefill_arrays(roofer::RasterTools::MIN);
+  for (size_t row = 0; row < heightfield.dimy_; ++row) {
+    for (size_t col = 0; col < heightfield.dimx_; ++col) {
+      // leave some cells without data
+      if ((row + col) % 7 == 0) continue;
+      heightfield.set_val(col, row, 0.3 * col + 0.1 * row + 1);
+    }
+  }
+  FaceLabelRaster face_raster(heightfield);
+  face_raster.add_face({{{0, 0}, {10, 0}, {10, 5}, {0, 5}}}, 0);
+  face_raster.add_face({{{0, 5}, {10, 5}, {10, 10}, {0, 10}}}, 1);
+
+  const std::vector<std::array<double, 3>> planes = {{0.3, 0.1, 1},
+                                                     {0, 0, 2}};
+  std::vector<double> costs;
+  face_plane_costs(heightfield, face_raster, 2, planes, costs);
+  REQUIRE(costs.size() == 4);
+
+  std::vector<double> expected(4, 0);
+  for (size_t row = 0; row < heightfield.dimy_; ++row) {
+    for (size_t col = 0; col < heightfield.dimx_; ++col) {
+      if ((row + col) % 7 == 0) continue;
+      const size_t face = row < 5 ? 0 : 1;
+      const double x = col + 0.5, y = row + 0.5;
+      const double z = heightfield.get_val(col, row);
+      for (size_t p = 0; p < planes.size(); ++p) {
+        expected[face * 2 + p] += std::abs(
+            z - (planes[p][0] * x + planes[p][1] * y + planes[p][2]));
+      }
+    }
+  }
+  for (size_t i = 0; i < costs.size(); ++i) {
+    CHECK(costs[i] == Catch::Approx(expected[i]));
+  }
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/reconstruction/KnnGraph.hpp>
+#include <roofer/reconstruction/KnnIndex.hpp>
+
+namespace {
+  roofer::PointCollection random_points(std::size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> u(0.F, 10.F);
+    roofer::PointCollection points;
+    for (std::size_t i = 0; i < n; ++i) {
+      points.push_back({u(gen), u(gen), u(gen)});
+    }
+    return points;
+  }
+
+  // a noisy gable roof with a flat extension, like a building point cloud
+  roofer::PointCollection roof_points(std::size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> u(0.F, 1.F);
+    std::normal_distribution<float> noise(0.F, 0.02F);
+    roofer::PointCollection points;
+    for (std::size_t i = 0; i < n; ++i) {
+      const float x = 20.F * u(gen), y = 12.F * u(gen);
+      const float z = x < 15.F ? 10.F - 0.5F * std::abs(y - 6.F) : 4.F;
+      points.push_back({x, y, z + noise(gen)});
+    }
+    return points;
+  }
+
+  double squared_distance(const roofer::arr3f& a, const roofer::arr3f& b) {
+    double d = 0;
+    for (int i = 0; i < 3; ++i) d += double(a[i] - b[i]) * double(a[i] - b[i]);
+    return d;
+  }
+}  // namespace
+
+TEST_CASE("k-NN graph matches a brute force search") {
+  const auto points = random_points(500, 1);
+  const std::size_t k = 16;
+  const auto graph = roofer::reconstruction::compute_knn_graph(
+      points, k, roofer::reconstruction::KnnBackend::cgal_kd_tree);
+  REQUIRE(graph.size() == points.size());
+
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    std::vector<double> distances;
+    for (const auto& p : points) {
+      distances.push_back(squared_distance(points[i], p));
+    }
+    std::sort(distances.begin(), distances.end());
+
+    const auto row = graph.neighbours(i);
+    REQUIRE(row.size() == k);
+    CHECK(row[0] == i);
+    for (std::size_t j = 0; j < k; ++j) {
+      CHECK(squared_distance(points[i], points[row[j]]) == distances[j]);
+    }
+  }
+}
+
+TEST_CASE("k-NN graph rows can be used as a prefix") {
+  const auto points = random_points(100, 2);
+  const auto graph = roofer::reconstruction::compute_knn_graph(points, 10);
+  const auto row = graph.neighbours(7);
+  const auto prefix = graph.neighbours(7, 4);
+  REQUIRE(prefix.size() == 4);
+  CHECK(std::equal(prefix.begin(), prefix.end(), row.begin()));
+}
+
+TEST_CASE("k-NN graph of fewer than k points") {
+  const auto points = random_points(3, 3);
+  const auto graph = roofer::reconstruction::compute_knn_graph(points, 10);
+  REQUIRE(graph.size() == 3);
+  for (std::size_t i = 0; i < 3; ++i) CHECK(graph.neighbours(i).size() == 3);
+
+  const auto empty =
+      roofer::reconstruction::compute_knn_graph(roofer::PointCollection{}, 5);
+  CHECK(empty.size() == 0);
+}
+
+TEST_CASE("grid k-NN index matches a brute force search") {
+  for (const auto& points : {random_points(500, 4), roof_points(2000, 5)}) {
+    const std::size_t k = 16;
+    const roofer::reconstruction::KnnIndex index(points);
+    const auto graph = index.all_knn(k);
+    REQUIRE(graph.size() == points.size());
+
+    std::vector<std::size_t> result;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+      std::vector<double> distances;
+      for (const auto& p : points) {
+        distances.push_back(squared_distance(points[i], p));
+      }
+      std::sort(distances.begin(), distances.end());
+
+      // single precision distances, so only compare up to rounding
+      const auto row = graph.neighbours(i);
+      REQUIRE(row.size() == k);
+      CHECK(row[0] == i);
+      for (std::size_t j = 0; j < k; ++j) {
+        const auto d = squared_distance(points[i], points[row[j]]);
+        CHECK(std::abs(d - distances[j]) <= 1e-5 * (1 + distances[j]));
+      }
+
+      index.query(points[i], k, result);
+      CHECK(std::equal(result.begin(), result.end(), row.begin(), row.end()));
+    }
+  }
+}
+
+TEST_CASE("grid k-NN index agrees with the kd-tree") {
+  using roofer::reconstruction::KnnBackend;
+  const auto points = roof_points(5000, 6);
+  const auto grid =
+      roofer::reconstruction::compute_knn_graph(points, 10, KnnBackend::grid);
+  const auto tree = roofer::reconstruction::compute_knn_graph(
+      points, 10, KnnBackend::cgal_kd_tree);
+  REQUIRE(grid.offsets == tree.offsets);
+
+  // the neighbour sets may only differ in points at the same distance
+  std::size_t differing_rows = 0;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const auto a = grid.neighbours(i);
+    const auto b = tree.neighbours(i);
+    if (!std::equal(a.begin(), a.end(), b.begin())) ++differing_rows;
+    const auto last = squared_distance(points[i], points[b.back()]);
+    CHECK(std::abs(squared_distance(points[i], points[a.back()]) - last) <=
+          1e-5 * (1 + last));
+  }
+  CHECK(differing_rows < points.size() / 100);
+}
+
+TEST_CASE("grid k-NN index is independent of the execution order") {
+  const auto points = roof_points(3000, 7);
+  const roofer::reconstruction::KnnIndex index(points);
+  const auto parallel = index.all_knn(12, true);
+  const auto sequential = index.all_knn(12, false);
+  CHECK(parallel.indices == sequential.indices);
+}
+
+TEST_CASE("grid k-NN index handles degenerate point sets") {
+  // duplicates and points on a vertical line, which have no xy extent
+  roofer::PointCollection points;
+  for (int i = 0; i < 50; ++i) points.push_back({1.F, 2.F, float(i % 10)});
+  const roofer::reconstruction::KnnIndex index(points);
+  const auto graph = index.all_knn(8);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const auto row = graph.neighbours(i);
+    REQUIRE(row.size() == 8);
+    // 5 duplicates of each point, ties are broken by index
+    for (std::size_t j = 0; j < 5; ++j) {
+      CHECK(points[row[j]][2] == points[i][2]);
+    }
+    CHECK(std::is_sorted(row.begin(), row.begin() + 5));
+  }
+
+  // queries outside the extent of the points
+  std::vector<std::size_t> result;
+  index.query({100.F, -40.F, 3.F}, 3, result);
+  REQUIRE(result.size() == 3);
+  for (auto j : result) CHECK(points[j][2] == 3.F);
+}
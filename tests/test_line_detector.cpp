@@ -0,0 +1,76 @@
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/reconstruction/LineDetectorBase.hpp>
+
+namespace {
+  using roofer::linedect::LineDetector;
+  using roofer::linedect::Point;
+
+  // the boundary of a polygon with `sides` straight sides, or of a circle if
+  // sides is 0, with gaussian noise on the points
+  std::vector<Point> noisy_ring(std::size_t n, int sides, double noise,
+                                unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> d(0, noise);
+    std::vector<Point> points;
+    for (std::size_t i = 0; i < n; ++i) {
+      const double t = 2 * std::numbers::pi * double(i) / double(n);
+      double r = 10;
+      if (sides > 0) {
+        const double sector = 2 * std::numbers::pi / sides;
+        r = 10 * std::cos(sector / 2) /
+            std::cos(std::fmod(t, sector) - sector / 2);
+      }
+      points.emplace_back(r * std::cos(t) + d(gen), r * std::sin(t) + d(gen),
+                          5);
+    }
+    return points;
+  }
+
+  // the ring neighbourhoods of detect_lines_ring()
+  std::vector<std::vector<std::size_t>> ring_neighbours(std::size_t n) {
+    std::vector<std::vector<std::size_t>> neighbours(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t k = n - 2; k <= n + 2; ++k) {
+        neighbours[i].push_back((i + k) % n);
+      }
+    }
+    return neighbours;
+  }
+}  // namespace
+
+TEST_CASE("line detection over a count range equals one pass per count",
+          "[line_detector]") {
+  for (int sides : {0, 3, 4, 7, 12}) {
+    for (double noise : {0.0, 0.05, 0.2}) {
+      for (std::size_t n : {50, 200, 1000}) {
+        auto points = noisy_ring(n, sides, noise, unsigned(n) + sides);
+        LineDetector stepped(points, ring_neighbours(n));
+        LineDetector ranged(points, ring_neighbours(n));
+        stepped.dist_thres = ranged.dist_thres = 0.2 * 0.2;
+
+        std::vector<std::size_t> stepped_regions;
+        for (std::size_t count = 10; count >= 5; --count) {
+          stepped.min_segment_count = count;
+          for (auto id : stepped.detect()) stepped_regions.push_back(id);
+        }
+        auto ranged_regions = ranged.detect(10, 5);
+
+        CHECK(ranged_regions == stepped_regions);
+        CHECK(ranged.point_segment_idx == stepped.point_segment_idx);
+        CHECK(ranged.min_segment_count == stepped.min_segment_count);
+        REQUIRE(ranged.segment_shapes.size() == stepped.segment_shapes.size());
+        for (const auto& [id, line] : stepped.segment_shapes) {
+          REQUIRE(ranged.segment_shapes.count(id));
+          CHECK(ranged.segment_shapes.at(id) == line);
+        }
+      }
+    }
+  }
+}
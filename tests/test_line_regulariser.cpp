@@ -0,0 +1,215 @@
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/reconstruction/LineRegulariserBase.hpp>
+
+namespace {
+  using namespace roofer;
+
+  // random segments along a few dominant directions, as on a roof with
+  // some noise on the line angles
+  SegmentCollection random_segments(std::size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> pos(0.F, 50.F), len(1.F, 10.F);
+    std::normal_distribution<float> noise(0.F, 0.05F);
+    std::uniform_int_distribution<int> direction(0, 3);
+    SegmentCollection segments;
+    for (std::size_t i = 0; i < n; ++i) {
+      const float angle =
+          float(direction(gen)) * std::numbers::pi_v<float> / 4 + noise(gen);
+      const float x = pos(gen), y = pos(gen), l = len(gen);
+      segments.push_back({arr3f{x, y, 0},
+                          arr3f{x + l * std::cos(angle),
+                                y + l * std::sin(angle), 0}});
+    }
+    return segments;
+  }
+
+  // building-scale lines of 10 to 50m along the diagonals, in groups of
+  // three nearly collinear lines, as the edges of the roof planes of one
+  // building that line up. The lines are parallel, so that no two of them
+  // cross at a distance of 0 and the order of the merges is unique.
+  SegmentCollection diagonal_segments(std::size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> pos(0.F, 100.F), len(10.F, 50.F),
+        shift(-10.F, 10.F);
+    std::normal_distribution<float> offset(0.F, 0.5F);
+    std::uniform_int_distribution<int> direction(0, 1);
+    SegmentCollection segments;
+    float x = 0, y = 0, angle = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (i % 3 == 0) {
+        x = pos(gen);
+        y = pos(gen);
+        angle = float(2 * direction(gen) + 1) * std::numbers::pi_v<float> / 4;
+      }
+      const float l = len(gen), s = shift(gen), o = offset(gen);
+      const float x0 = x + s * std::cos(angle) - o * std::sin(angle);
+      const float y0 = y + s * std::sin(angle) + o * std::cos(angle);
+      segments.push_back({arr3f{x0, y0, 0},
+                          arr3f{x0 + l * std::cos(angle),
+                                y0 + l * std::sin(angle), 0}});
+    }
+    return segments;
+  }
+
+  using Partition = std::set<std::set<std::size_t>>;
+
+  template <typename ClusterSet>
+  Partition partition_of(const ClusterSet& clusters) {
+    Partition partition;
+    for (const auto& cluster : clusters) {
+      std::set<std::size_t> members;
+      for (auto line : cluster->lines) members.insert(line->segment_id);
+      partition.insert(members);
+    }
+    return partition;
+  }
+
+  // agglomerative clustering that measures all pairs after every merge
+  Partition brute_force_angle_clusters(std::vector<linereg::linetype>& lines,
+                                       double threshold) {
+    std::vector<std::vector<linereg::linetype*>> clusters;
+    std::vector<double> values;
+    for (auto& line : lines) {
+      clusters.push_back({&line});
+      values.push_back(line.angle);
+    }
+    while (true) {
+      double best = threshold;
+      std::size_t a = 0, b = 0;
+      for (std::size_t i = 0; i < clusters.size(); ++i) {
+        for (std::size_t j = i + 1; j < clusters.size(); ++j) {
+          const double d = std::fabs(values[i] - values[j]);
+          if (d < best) {
+            best = d;
+            a = i;
+            b = j;
+          }
+        }
+      }
+      if (a == b) break;
+      clusters[a].insert(clusters[a].end(), clusters[b].begin(),
+                         clusters[b].end());
+      values[a] = linereg::calc_mean_angle(clusters[a]);
+      clusters.erase(clusters.begin() + b);
+      values.erase(values.begin() + b);
+    }
+    Partition partition;
+    for (const auto& cluster : clusters) {
+      std::set<std::size_t> members;
+      for (auto line : cluster) members.insert(line->segment_id);
+      partition.insert(members);
+    }
+    return partition;
+  }
+
+  // agglomerative distance clustering of each angle cluster that measures
+  // all pairs after every merge
+  Partition brute_force_dist_clusters(
+      const std::set<linereg::AngleClusterH>& angle_clusters,
+      double threshold) {
+    Partition partition;
+    for (const auto& angle_cluster : angle_clusters) {
+      std::vector<linereg::DistClusterH> clusters;
+      for (auto line : angle_cluster->lines) {
+        clusters.push_back(std::make_shared<linereg::DistCluster>());
+        clusters.back()->value = line->segment;
+        clusters.back()->lines.push_back(line);
+      }
+      while (true) {
+        double best = threshold;
+        std::size_t a = 0, b = 0;
+        for (std::size_t i = 0; i < clusters.size(); ++i) {
+          for (std::size_t j = i + 1; j < clusters.size(); ++j) {
+            const double d = clusters[i]->distance(clusters[j].get());
+            if (d < best) {
+              best = d;
+              a = i;
+              b = j;
+            }
+          }
+        }
+        if (a == b) break;
+        auto& lines = clusters[a]->lines;
+        lines.insert(lines.end(), clusters[b]->lines.begin(),
+                     clusters[b]->lines.end());
+        clusters[a]->calc_mean_value();
+        clusters.erase(clusters.begin() + b);
+      }
+      partition.merge(partition_of(clusters));
+    }
+    return partition;
+  }
+}  // namespace
+
+TEST_CASE("angle clustering equals brute force agglomerative clustering",
+          "[line_regulariser]") {
+  for (unsigned seed : {1, 2, 3}) {
+    linereg::LineRegulariser LR;
+    LR.add_segments(0, random_segments(300, seed));
+    LR.angle_threshold = 0.15;
+    LR.dist_threshold = 0.8 * 0.8;
+    auto reference = brute_force_angle_clusters(LR.lines, LR.angle_threshold);
+
+    LR.perform_angle_clustering();
+    CHECK(partition_of(LR.angle_clusters) == reference);
+  }
+}
+
+TEST_CASE("distance clustering merges only close lines",
+          "[line_regulariser]") {
+  // three collinear pieces of one edge with 0.5m gaps, one parallel edge 5m
+  // away and a perpendicular edge
+  SegmentCollection segments;
+  segments.push_back({arr3f{0, 0, 0}, arr3f{4, 0.1F, 0}});
+  segments.push_back({arr3f{4.5F, 0.1F, 0}, arr3f{9, 0, 0}});
+  segments.push_back({arr3f{9.5F, 0, 0}, arr3f{14, 0.05F, 0}});
+  segments.push_back({arr3f{0, 5, 0}, arr3f{14, 5, 0}});
+  segments.push_back({arr3f{20, 0, 0}, arr3f{20, 10, 0}});
+
+  linereg::LineRegulariser LR;
+  LR.add_segments(0, segments);
+  LR.angle_threshold = 0.15;
+  LR.dist_threshold = 0.8 * 0.8;
+  LR.perform_angle_clustering();
+  LR.perform_distance_clustering();
+
+  CHECK(LR.angle_clusters.size() == 2);
+  CHECK(partition_of(LR.dist_clusters) == Partition{{0, 1, 2}, {3}, {4}});
+}
+
+TEST_CASE("a zero threshold does not merge anything", "[line_regulariser]") {
+  linereg::LineRegulariser LR;
+  LR.add_segments(0, random_segments(50, 4));
+  LR.angle_threshold = 0;
+  LR.dist_threshold = 0;
+  LR.perform_angle_clustering();
+  LR.perform_distance_clustering();
+  CHECK(LR.angle_clusters.size() == LR.lines.size());
+  CHECK(LR.dist_clusters.size() == LR.lines.size());
+}
+
+TEST_CASE("distance clustering equals brute force agglomerative clustering",
+          "[line_regulariser]") {
+  for (unsigned seed : {1, 2, 3}) {
+    linereg::LineRegulariser LR;
+    LR.add_segments(0, diagonal_segments(300, seed));
+    LR.angle_threshold = 0.15;
+    LR.dist_threshold = 0.8 * 0.8;
+    LR.perform_angle_clustering();
+    auto reference =
+        brute_force_dist_clusters(LR.angle_clusters, LR.dist_threshold);
+
+    LR.perform_distance_clustering();
+    CHECK(partition_of(LR.dist_clusters) == reference);
+    // the groups of nearly collinear lines are merged
+    CHECK(LR.dist_clusters.size() < LR.lines.size());
+  }
+}
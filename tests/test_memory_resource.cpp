@@ -0,0 +1,49 @@
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/common/memory_resource.hpp>
+
+TEST_CASE("scratch resource is the default resource outside of an arena") {
+  CHECK(roofer::scratch_resource() == std::pmr::get_default_resource());
+}
+
+TEST_CASE("scratch arenas nest and restore the previous resource") {
+  auto* outside = roofer::scratch_resource();
+  {
+    roofer::ScratchArena arena;
+    auto* outer = roofer::scratch_resource();
+    CHECK(outer != outside);
+    {
+      roofer::ScratchArena nested;
+      CHECK(roofer::scratch_resource() != outer);
+      std::pmr::vector<int> values(roofer::scratch_resource());
+      values.resize(1000, 7);
+      CHECK(values.back() == 7);
+    }
+    CHECK(roofer::scratch_resource() == outer);
+  }
+  CHECK(roofer::scratch_resource() == outside);
+}
+
+TEST_CASE("scratch arenas grow beyond their initial buffer") {
+  roofer::ScratchArena arena;
+  std::pmr::vector<std::pmr::vector<double>> rows(roofer::scratch_resource());
+  for (int i = 0; i < 64; ++i) {
+    rows.emplace_back(roofer::ScratchArena::initial_size / 64, double(i));
+  }
+  CHECK(rows.back().get_allocator().resource() == roofer::scratch_resource());
+  CHECK(rows[63][0] == 63.0);
+}
+
+TEST_CASE("scratch arenas are per thread") {
+  roofer::ScratchArena arena;
+  auto* main_resource = roofer::scratch_resource();
+  std::pmr::memory_resource* other_resource = nullptr;
+  std::thread other([&] { other_resource = roofer::scratch_resource(); });
+  other.join();
+  CHECK(other_resource == std::pmr::get_default_resource());
+  CHECK(other_resource != main_resource);
+}
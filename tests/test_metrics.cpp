@@ -0,0 +1,55 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "metrics.hpp"
+
+namespace {
+  std::vector<std::string> bucket_lines(const metrics::Histogram& histogram) {
+    std::string out;
+    histogram.write_samples(out, "roofer_duration_seconds", "stage=\"crop\"");
+    std::vector<std::string> lines;
+    size_t begin = 0;
+    for (size_t end = out.find('\n'); end != std::string::npos;
+         begin = end + 1, end = out.find('\n', begin)) {
+      auto line = out.substr(begin, end - begin);
+      if (line.find("_bucket{") != std::string::npos) lines.push_back(line);
+    }
+    return lines;
+  }
+
+  std::string le_label(const std::string& line) {
+    const auto begin = line.find("le=\"") + 4;
+    return line.substr(begin, line.find('"', begin) - begin);
+  }
+
+  uint64_t bucket_count(const std::string& line) {
+    return std::stoull(line.substr(line.rfind(' ') + 1));
+  }
+}  // namespace
+
+TEST_CASE("histogram exports the same buckets in every snapshot") {
+  metrics::Histogram histogram;
+  const auto empty = bucket_lines(histogram);
+  REQUIRE(empty.size() == metrics::Histogram::export_bucket_bits + 2);
+  CHECK(le_label(empty.back()) == "+Inf");
+
+  histogram.observe_us(3);
+  histogram.observe_us(1500);
+  histogram.observe_us(uint64_t{1} << 40);
+  const auto filled = bucket_lines(histogram);
+  REQUIRE(filled.size() == empty.size());
+  uint64_t previous = 0;
+  for (size_t i = 0; i < filled.size(); ++i) {
+    CHECK(le_label(filled[i]) == le_label(empty[i]));
+    CHECK(bucket_count(filled[i]) >= previous);
+    previous = bucket_count(filled[i]);
+  }
+  // 3 us is below le=4e-06, the slowest observation is only in +Inf
+  CHECK(bucket_count(filled[1]) == 0);
+  CHECK(bucket_count(filled[2]) == 1);
+  CHECK(bucket_count(filled[filled.size() - 2]) == 2);
+  CHECK(bucket_count(filled.back()) == 3);
+}
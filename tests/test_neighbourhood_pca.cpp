@@ -0,0 +1,155 @@
+#include <CGAL/linear_least_squares_fitting_3.h>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/reconstruction/KnnGraph.hpp>
+#include <roofer/reconstruction/NeighbourhoodPca.hpp>
+#include <roofer/reconstruction/PlaneDetectorBase.hpp>
+#include <roofer/reconstruction/cgal_shared_definitions.hpp>
+
+namespace {
+  // a noisy roof with two slopes, a flat part and a few loose points
+  roofer::PointCollection roof_points(std::size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> u(0.F, 1.F);
+    std::normal_distribution<float> noise(0.F, 0.03F);
+    roofer::PointCollection points;
+    for (std::size_t i = 0; i < n; ++i) {
+      const float x = 20.F * u(gen), y = 12.F * u(gen);
+      float z = x < 15.F ? 10.F - 0.5F * std::abs(y - 6.F) : 4.F;
+      if (i % 50 == 0) z += 3.F * u(gen);
+      points.push_back({x, y, z + noise(gen)});
+    }
+    return points;
+  }
+
+  double cgal_fit(const roofer::PointCollection& points,
+                  std::span<const std::size_t> neighbours, Vector& normal) {
+    std::vector<Point> neighbour_points;
+    for (auto j : neighbours) {
+      neighbour_points.emplace_back(points[j][0], points[j][1], points[j][2]);
+    }
+    Plane plane;
+    const double quality = CGAL::linear_least_squares_fitting_3(
+        neighbour_points.begin(), neighbour_points.end(), plane,
+        CGAL::Dimension_tag<0>());
+    normal = plane.orthogonal_vector();
+    return quality;
+  }
+}  // namespace
+
+TEST_CASE("closed-form eigen decomposition of symmetric 3x3 matrices") {
+  using roofer::reconstruction::smallest_eigenvector;
+  std::array<float, 3> values, vector;
+
+  REQUIRE(smallest_eigenvector<float>({3, 0, 0, 2, 0, 1}, values, vector));
+  CHECK(std::abs(values[0] - 1.F) < 1e-5F);
+  CHECK(std::abs(values[1] - 2.F) < 1e-5F);
+  CHECK(std::abs(values[2] - 3.F) < 1e-5F);
+  CHECK(std::abs(std::abs(vector[2]) - 1.F) < 1e-5F);
+
+  // eigenvalues 0, 1 and 3, with the null vector (1, 1, 1) / sqrt(3)
+  std::array<double, 3> values_d, vector_d;
+  REQUIRE(smallest_eigenvector<double>({1, 0, -1, 1, -1, 2}, values_d,
+                                       vector_d));
+  CHECK(std::abs(values_d[0]) < 1e-12);
+  CHECK(std::abs(values_d[1] - 1) < 1e-12);
+  CHECK(std::abs(values_d[2] - 3) < 1e-12);
+  for (auto x : vector_d) {
+    CHECK(std::abs(std::abs(x) - 1 / std::sqrt(3.)) < 1e-12);
+  }
+
+  // all eigenvalues equal
+  CHECK_FALSE(smallest_eigenvector<float>({2, 0, 0, 2, 0, 2}, values, vector));
+  CHECK((vector == std::array<float, 3>{0, 0, 1}));
+  CHECK_FALSE(smallest_eigenvector<float>({0, 0, 0, 0, 0, 0}, values, vector));
+}
+
+TEST_CASE("neighbourhood planes match CGAL least squares fitting") {
+  const auto points = roof_points(5000, 1);
+  const std::size_t normal_k = 5, seed_k = 15;
+  const auto graph =
+      roofer::reconstruction::compute_knn_graph(points, seed_k + 1);
+  roofer::vec3f normals;
+  roofer::vec1f seed_scores;
+  roofer::reconstruction::fit_neighbourhood_planes(points, graph, normal_k,
+                                                   seed_k, normals,
+                                                   seed_scores);
+  REQUIRE(normals.size() == points.size());
+  REQUIRE(seed_scores.size() == points.size());
+
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    Vector normal;
+    cgal_fit(points, graph.neighbours(i, normal_k), normal);
+    const auto& n = normals[i];
+    const double dot = std::abs(n[0] * normal.x() + n[1] * normal.y() +
+                                n[2] * normal.z()) /
+                       std::sqrt(normal.squared_length());
+    // within 0.01 rad
+    CHECK(dot > 0.99995);
+
+    const auto row = graph.neighbours(i, seed_k + 1);
+    const auto quality = cgal_fit(points, row.subspan(1), normal);
+    CHECK(std::abs(quality - seed_scores[i]) < 1e-3);
+  }
+}
+
+TEST_CASE("neighbourhood planes of degenerate neighbourhoods") {
+  // points on a line have no plane, and are no seeds
+  roofer::PointCollection points;
+  for (int i = 0; i < 40; ++i) points.push_back({0.1F * i, 0.2F * i, 5.F});
+  const auto graph = roofer::reconstruction::compute_knn_graph(points, 16);
+  roofer::vec3f normals;
+  roofer::vec1f seed_scores;
+  roofer::reconstruction::fit_neighbourhood_planes(points, graph, 5, 15,
+                                                   normals, seed_scores);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    CHECK(seed_scores[i] == 0.F);
+    const auto& n = normals[i];
+    CHECK(std::abs(n[0] * n[0] + n[1] * n[1] + n[2] * n[2] - 1.F) < 1e-5F);
+    CHECK(std::abs(n[0] * 0.1F + n[1] * 0.2F) < 1e-5F);
+  }
+}
+
+TEST_CASE("plane region refit from running moments") {
+  // a large, slightly tilted roof far from the origin
+  std::mt19937 gen(2);
+  std::uniform_real_distribution<float> u(0.F, 200.F);
+  std::normal_distribution<float> noise(0.F, 0.02F);
+  roofer::PointCollection points;
+  for (std::size_t i = 0; i < 100000; ++i) {
+    const float x = u(gen), y = u(gen);
+    const float z = 12.F + 0.01F * x + noise(gen);
+    points.push_back({85000.F + x, 445000.F + y, z});
+  }
+
+  roofer::planedect::PlaneRegion region(1);
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    region.add_inlier(i, points[i]);
+  }
+  region.refit_plane();
+
+  Plane plane;
+  std::vector<Point> inlier_points;
+  for (const auto& p : points) inlier_points.emplace_back(p[0], p[1], p[2]);
+  CGAL::linear_least_squares_fitting_3(inlier_points.begin(),
+                                       inlier_points.end(), plane,
+                                       CGAL::Dimension_tag<0>());
+  const auto a = region.plane.orthogonal_vector();
+  const auto b = plane.orthogonal_vector();
+  CHECK(std::abs(a * b) / std::sqrt(a.squared_length() * b.squared_length()) >
+        1 - 1e-9);
+  CHECK(std::abs(a.squared_length() - 1) < 1e-9);
+  for (auto i : {std::size_t(0), std::size_t(5000), std::size_t(99999)}) {
+    CHECK(std::abs(std::sqrt(CGAL::squared_distance(region.plane,
+                                                    inlier_points[i])) -
+                   std::sqrt(CGAL::squared_distance(plane, inlier_points[i]))) <
+          1e-4);
+  }
+}
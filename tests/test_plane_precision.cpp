@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/reconstruction/KnnIndex.hpp>
+#include <roofer/reconstruction/NeighbourhoodPca.hpp>
+#include <roofer/reconstruction/PlaneDetectorBase.hpp>
+#include <roofer/reconstruction/RegionGrower.hpp>
+
+namespace {
+  // a gable roof with a dormer and a flat annex, in local coordinates
+  // around `offset`
+  roofer::PointCollection roof_points(std::size_t n, unsigned seed,
+                                      float offset) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> u(0.F, 1.F);
+    std::normal_distribution<float> noise(0.F, 0.02F);
+    roofer::PointCollection points;
+    for (std::size_t i = 0; i < n; ++i) {
+      const float x = 30.F * u(gen), y = 12.F * u(gen);
+      float z = 4.F;
+      if (x < 20.F) {
+        z = 10.F - 0.6F * std::abs(y - 6.F);
+        // dormer on the south slope
+        if (x > 6.F && x < 10.F && y < 4.F) z = 8.F + 0.2F * y;
+      }
+      points.push_back({offset + x, offset + y, z + noise(gen)});
+    }
+    return points;
+  }
+
+  // The region test of plane detection before the planes were refitted from
+  // running moments: every refit is a least squares fit over all inliers,
+  // and the test is evaluated in double on the absolute coordinates.
+  struct LeastSquaresRefitTester {
+    double dist_thres;
+    double normal_thres;
+    std::size_t n_refit;
+
+    bool is_valid(roofer::planedect::PlaneDS& cds, std::size_t candidate,
+                  std::size_t neighbour,
+                  roofer::planedect::PlaneRegion& shape) {
+      using roofer::Point;
+      using roofer::Vector;
+      const auto& p_c = cds.points[candidate];
+      const auto& n_c = cds.normals[candidate];
+      const auto& p = cds.points[neighbour];
+      const auto& n = cds.normals[neighbour];
+      if (shape.inliers.empty()) {
+        shape.plane = roofer::Plane(Point(p_c[0], p_c[1], p_c[2]),
+                                    Vector(n_c[0], n_c[1], n_c[2]));
+        shape.inliers.push_back(candidate);
+      }
+      const bool valid =
+          CGAL::squared_distance(shape.plane, Point(p[0], p[1], p[2])) <
+              dist_thres &&
+          std::abs(shape.plane.orthogonal_vector() *
+                   Vector(n[0], n[1], n[2])) > normal_thres;
+      if (valid) {
+        shape.inliers.push_back(neighbour);
+        if (shape.inliers.size() % n_refit == 0) {
+          cds.fit_plane(shape.inliers, shape.plane);
+        }
+      }
+      return valid;
+    }
+  };
+
+  // plane detection with all numerical kernels in the scalar type T
+  template <typename T,
+            typename Tester = roofer::planedect::DistAndNormalTester<T>>
+  std::vector<std::size_t> detect_planes(
+      const roofer::PointCollection& pts,
+      Tester tester = Tester(T(0.3 * 0.3), T(0.9), 5)) {
+    using namespace roofer;
+    const auto graph = reconstruction::BasicKnnIndex<T>(pts).all_knn(16);
+    vec3f normals;
+    vec1f seed_scores;
+    reconstruction::fit_neighbourhood_planes<T>(pts, graph, 5, 15, normals,
+                                                seed_scores);
+    for (auto& n : normals) {
+      if (n[2] < 0) n = {-n[0], -n[1], -n[2]};
+    }
+    planedect::PlaneDS ds(pts, normals, graph, 15);
+    ds.seed_scores = std::move(seed_scores);
+    regiongrower::RegionGrower<planedect::PlaneDS, planedect::PlaneRegion>
+        grower;
+    grower.min_segment_count = 15;
+    grower.grow_regions(ds, tester);
+    return grower.region_ids;
+  }
+
+  // fraction of the points whose plane in `a` maps to their plane in `b`,
+  // when each plane of `a` is mapped to the plane of `b` it overlaps most
+  double agreement(const std::vector<std::size_t>& a,
+                   const std::vector<std::size_t>& b) {
+    std::map<std::size_t, std::map<std::size_t, std::size_t>> overlap;
+    for (std::size_t i = 0; i < a.size(); ++i) ++overlap[a[i]][b[i]];
+    std::size_t agreeing = 0;
+    for (const auto& [plane, counts] : overlap) {
+      std::size_t best = 0;
+      for (const auto& [other, count] : counts) best = std::max(best, count);
+      agreeing += best;
+    }
+    return double(agreeing) / double(a.size());
+  }
+
+  std::size_t plane_count(const std::vector<std::size_t>& ids) {
+    auto sorted = ids;
+    std::sort(sorted.begin(), sorted.end());
+    return std::unique(sorted.begin(), sorted.end()) - sorted.begin();
+  }
+}  // namespace
+
+TEST_CASE("float and double plane detection assign the same planes") {
+  for (float offset : {0.F, 1000.F}) {
+    for (unsigned seed : {1U, 2U, 3U}) {
+      const auto points = roof_points(20000, seed, offset);
+      const auto single = detect_planes<float>(points);
+      const auto reference = detect_planes<double>(points);
+      CHECK(plane_count(single) == plane_count(reference));
+      CHECK(agreement(single, reference) > 0.99);
+      CHECK(agreement(reference, single) > 0.99);
+    }
+  }
+}
+
+TEST_CASE("a refit from running moments assigns the same planes") {
+  for (float offset : {0.F, 1000.F}) {
+    for (unsigned seed : {1U, 2U, 3U}) {
+      const auto points = roof_points(20000, seed, offset);
+      const auto moments = detect_planes<float>(points);
+      const auto reference = detect_planes<double>(
+          points, LeastSquaresRefitTester{0.3 * 0.3, 0.9, 5});
+      CHECK(plane_count(moments) == plane_count(reference));
+      CHECK(agreement(moments, reference) > 0.99);
+      CHECK(agreement(reference, moments) > 0.99);
+    }
+  }
+}
@@ -0,0 +1,131 @@
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/common/Raster.hpp>
+#include <roofer/common/common.hpp>
+
+using roofer::vec2f;
+using roofer::RasterTools::BasicRaster;
+using roofer::RasterTools::Raster;
+
+namespace {
+  // even-odd test of a point against the rings, like the scan lines
+  bool inside(const std::vector<vec2f>& rings, double x, double y) {
+    bool in = false;
+    for (auto& ring : rings) {
+      for (size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        if ((ring[i][1] > y) != (ring[j][1] > y) &&
+            x < ring[j][0] + (y - ring[j][1]) / (ring[i][1] - ring[j][1]) *
+                                 (ring[i][0] - ring[j][0])) {
+          in = !in;
+        }
+      }
+    }
+    return in;
+  }
+
+  vec2f star(size_t n, double cx, double cy, double r0, double r1,
+             std::mt19937& gen) {
+    std::uniform_real_distribution<double> radius(r0, r1);
+    vec2f ring;
+    for (size_t i = 0; i < n; ++i) {
+      const double angle = 2 * std::numbers::pi * double(i) / double(n);
+      const double r = radius(gen);
+      ring.push_back(
+          {float(cx + r * std::cos(angle)), float(cy + r * std::sin(angle))});
+    }
+    return ring;
+  }
+}  // namespace
+
+TEST_CASE("scan lines visit the cells whose centre is in the polygon") {
+  std::mt19937 gen(3);
+  Raster grid(0.5, 0, 49.5, 0, 49.5);
+  const std::vector<vec2f> rings = {star(40, 24.7, 25.1, 12, 24, gen),
+                                    star(12, 24.2, 24.9, 3, 8, gen)};
+
+  std::vector<int> hits(grid.dimx_ * grid.dimy_, 0);
+  size_t last_row = 0;
+  grid.scan_rings(rings, [&](size_t row, size_t col_begin, size_t col_end) {
+    CHECK(row >= last_row);
+    CHECK(col_begin < col_end);
+    CHECK(col_end <= grid.dimx_);
+    last_row = row;
+    for (size_t col = col_begin; col < col_end; ++col) {
+      ++hits[grid.getLinearCoord(row, col)];
+    }
+  });
+
+  size_t inside_count = 0;
+  for (size_t row = 0; row < grid.dimy_; ++row) {
+    for (size_t col = 0; col < grid.dimx_; ++col) {
+      auto p = grid.getPointFromRasterCoords(col, row);
+      const int expected = inside(rings, p[0], p[1]) ? 1 : 0;
+      inside_count += expected;
+      CHECK(hits[grid.getLinearCoord(row, col)] == expected);
+    }
+  }
+  CHECK(inside_count > 0);
+}
+
+TEST_CASE("scan lines clip the polygon to the raster") {
+  Raster grid(1, 0, 9, 0, 9);
+  const vec2f ring = {{-5, -5}, {5.2, -5}, {5.2, 20}, {-5, 20}};
+  size_t cells = 0;
+  grid.scan_ring(ring, [&](size_t, size_t col_begin, size_t col_end) {
+    CHECK(col_begin == 0);
+    CHECK(col_end == 5);
+    cells += col_end - col_begin;
+  });
+  CHECK(cells == 5 * grid.dimy_);
+}
+
+TEST_CASE("the row edge rule keeps the cells of rasterise_polygon") {
+  // cell counts of the former rasterise_polygon() on the whole raster, and
+  // of the cell centre rule that replaced it for the height attributes
+  Raster grid(1, 0, 9, 0, 9);
+  auto count = [](size_t& cells) {
+    return [&cells](size_t, size_t col_begin, size_t col_end) {
+      cells += col_end - col_begin;
+    };
+  };
+
+  // the crossings of the bottom edges of rows 2 to 5, columns 1 to 5
+  // included, against the 4 by 4 cells whose centre is inside
+  const vec2f square = {{1, 1}, {5, 1}, {5, 5}, {1, 5}};
+  size_t row_edge_cells = 0, centre_cells = 0;
+  grid.scan_ring_row_edges(
+      square, [&](size_t row, size_t col_begin, size_t col_end) {
+        CHECK(row >= 2);
+        CHECK(row <= 5);
+        CHECK(col_begin == 1);
+        CHECK(col_end == 6);
+        row_edge_cells += col_end - col_begin;
+      });
+  grid.scan_ring(square, count(centre_cells));
+  CHECK(row_edge_cells == 20);
+  CHECK(centre_cells == 16);
+
+  const vec2f quad = {{1.2F, 1.7F}, {7.6F, 2.3F}, {8.4F, 8.1F}, {2.1F, 6.9F}};
+  row_edge_cells = 0;
+  centre_cells = 0;
+  grid.scan_ring_row_edges(quad, count(row_edge_cells));
+  grid.scan_ring(quad, count(centre_cells));
+  CHECK(row_edge_cells == 42);
+  CHECK(centre_cells == 34);
+}
+
+TEST_CASE("row spans address the cells of a typed raster") {
+  BasicRaster<int32_t> grid(1, 0, 4, 0, 2);
+  grid.prefill_arrays(roofer::RasterTools::MIN);
+  REQUIRE(grid.row(1).size() == grid.dimx_);
+  grid.row(1)[3] = 7;
+  CHECK(grid.get_val(3, 1) == 7);
+  CHECK(grid.isNoData(2, 1));
+  CHECK(grid.vals_[1 * grid.dimx_ + 3] == 7);
+}
@@ -0,0 +1,86 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "scheduler.hpp"
+
+TEST_CASE("parallel_invoke runs every callable") {
+  TaskScheduler scheduler(4, false);
+  std::atomic<int> sum = 0;
+  scheduler.parallel_invoke([&] { sum += 1; }, [&] { sum += 2; },
+                            [&] { sum += 4; });
+  CHECK(sum == 7);
+}
+
+TEST_CASE("nested parallel_invoke does not deadlock on busy workers") {
+  // a single worker runs the outer task, so all nested callables have to be
+  // run by the thread that waits for them
+  TaskScheduler scheduler(1, false);
+  std::atomic<int> sum = 0;
+  scheduler.detach_task([&] {
+    scheduler.parallel_invoke(
+        [&] {
+          scheduler.parallel_invoke([&] { sum += 1; }, [&] { sum += 2; });
+        },
+        [&] { sum += 4; });
+  });
+  scheduler.wait();
+  CHECK(sum == 7);
+
+  TaskScheduler pool(4, false);
+  std::atomic<int> count = 0;
+  for (int i = 0; i < 200; ++i) {
+    pool.detach_task([&] {
+      pool.parallel_invoke(
+          [&] { ++count; },
+          [&] { pool.parallel_invoke([&] { ++count; }, [&] { ++count; }); });
+    });
+  }
+  pool.wait();
+  CHECK(count == 600);
+}
+
+TEST_CASE("parallel_invoke rethrows after all callables finished") {
+  TaskScheduler scheduler(2, false);
+  std::atomic<bool> other_done = false;
+  CHECK_THROWS_AS(scheduler.parallel_invoke(
+                      [] { throw std::runtime_error("stage failed"); },
+                      [&] { other_done = true; }),
+                  std::runtime_error);
+  CHECK(other_done);
+}
+
+TEST_CASE("a throwing task releases the task counters") {
+  TaskScheduler scheduler(2, false);
+  scheduler.detach_task([] { throw std::runtime_error("building failed"); });
+  scheduler.detach_task([] {});
+  // TBB rethrows the exception of a detached task on wait, the thread pool
+  // drops it
+  try {
+    scheduler.wait();
+  } catch (const std::runtime_error&) {
+  }
+  CHECK(scheduler.tasks_running() == 0);
+  CHECK(scheduler.tasks_queued() == 0);
+}
+
+TEST_CASE("a waiting parallel_invoke does not run other tasks") {
+  TaskScheduler scheduler(4, false);
+  // the task that the thread is running, as seen from inside the task
+  thread_local int current_task = -1;
+  std::atomic<int> interleaved = 0;
+  for (int i = 0; i < 64; ++i) {
+    scheduler.detach_task([&, i] {
+      current_task = i;
+      scheduler.parallel_invoke(
+          [] { std::this_thread::sleep_for(std::chrono::milliseconds(1)); },
+          [] { std::this_thread::sleep_for(std::chrono::milliseconds(2)); });
+      if (current_task != i) ++interleaved;
+    });
+  }
+  scheduler.wait();
+  CHECK(interleaved == 0);
+}
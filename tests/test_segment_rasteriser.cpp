@@ -0,0 +1,57 @@
+#include <cmath>
+#include <limits>
+
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <roofer/common/Raster.hpp>
+#include <roofer/reconstruction/SegmentRasteriser.hpp>
+
+using roofer::RasterTools::Raster;
+
+TEST_CASE("segment rasteriser writes the plane at the cell centres") {
+  // a 10 x 10 m square on the plane z = 5 + 0.5 x, as two triangles
+  roofer::TriangleCollection roof;
+  roof.push_back({{{0, 0, 5}, {10, 0, 10}, {10, 10, 10}}});
+  roof.push_back({{{0, 0, 5}, {10, 10, 10}, {0, 10, 5}}});
+  roofer::TriangleCollection no_ground;
+
+  auto rasteriser = roofer::reconstruction::createSegmentRasteriser();
+  rasteriser->compute(roof, no_ground, {.cell_size = 0.5F});
+  auto& heightfield = rasteriser->heightfield;
+
+  size_t data_cells = 0;
+  for (size_t row = 0; row < heightfield.dimy_; ++row) {
+    for (size_t col = 0; col < heightfield.dimx_; ++col) {
+      auto p = heightfield.getPointFromRasterCoords(col, row);
+      const bool inside = p[0] > 0 && p[0] < 10 && p[1] > 0 && p[1] < 10;
+      if (!inside) {
+        CHECK(p[2] == heightfield.noDataVal_);
+        continue;
+      }
+      ++data_cells;
+      CHECK(p[2] == Catch::Approx(5 + 0.5 * p[0]));
+    }
+  }
+  CHECK(data_cells == 400);
+}
+
+TEST_CASE("fill_nn fills cells without data with the window minimum") {
+  Raster raster(1, 0, 9, 0, 9);
+  raster.prefill_arrays(roofer::RasterTools::MAX);
+  raster.set_val(2, 2, 4);
+  raster.set_val(3, 3, 3);
+  raster.set_val(8, 8, 7);
+  raster.fill_nn(2);
+
+  // the window of a cell spans [-2, 2) cells in both directions
+  CHECK(raster.noDataVal_ == std::numeric_limits<float>::max());
+  CHECK(raster.get_val(2, 2) == 4);
+  CHECK(raster.get_val(1, 1) == 4);
+  CHECK(raster.get_val(4, 4) == 3);
+  CHECK(raster.get_val(5, 5) == 3);
+  CHECK(raster.get_val(7, 7) == 7);
+  CHECK(raster.get_val(9, 9) == 7);
+  CHECK(raster.get_val(0, 0) == raster.noDataVal_);
+  CHECK(raster.get_val(6, 6) == raster.noDataVal_);
+}
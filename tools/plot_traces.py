@@ -36,10 +36,17 @@ if __name__ == "__main__":
     end_time = trace_df["time"].max()
     trace_df.loc[:, "duration"] = trace_df["time"].apply(lambda t: (t - start_time).total_seconds())
 
-    ax_counts = plt.subplot(211)
+    # Allocation scope traces are only present with RF_ENABLE_HEAP_TRACING
+    has_alloc = trace_df["name"].str.startswith("alloc_").any()
+    nrows = 3 if has_alloc else 2
+    ax_counts = plt.subplot(nrows, 1, 1)
     plt.tick_params("x", labelbottom=False)
     plt.grid(visible=True, which="major", axis="x")
-    ax_memory = plt.subplot(212, sharex=ax_counts)
+    ax_memory = plt.subplot(nrows, 1, 2, sharex=ax_counts)
+    if has_alloc:
+        plt.tick_params("x", labelbottom=False)
+        plt.grid(visible=True, which="major", axis="x")
+        ax_alloc = plt.subplot(nrows, 1, 3, sharex=ax_counts)
     linewidth = 2
     colormap = {
         "crop": "#2BC5F0",
@@ -50,19 +57,27 @@ if __name__ == "__main__":
         "rss": "#4F8A9B"
     }
     # The expected groups are "crop", "reconstruct", "serialize", "heap", "rss"
+    # and "alloc_<scope>"
     for name, group_df in trace_df.groupby("name"):
-        if name != "heap" and name != "rss":
-            ax_counts.plot(group_df["duration"], group_df["count"], label=name, color=colormap[name], linewidth=linewidth)
+        if name.startswith("alloc_"):
+            ax_alloc.plot(group_df["duration"], group_df["count"], label=name[len("alloc_"):], linewidth=linewidth)
+        elif name != "heap" and name != "rss":
+            ax_counts.plot(group_df["duration"], group_df["count"], label=name, color=colormap.get(name), linewidth=linewidth)
         else:
-            ax_memory.plot(group_df["duration"], group_df["count"], label=name, color=colormap[name], linewidth=linewidth)
+            ax_memory.plot(group_df["duration"], group_df["count"], label=name, color=colormap.get(name), linewidth=linewidth)
 
     ax_counts.set_ylabel("Nr. objects produced")
     ax_counts.legend()
     ax_counts.set_title(f"Total duration {(end_time - start_time).total_seconds():.2f}s")
 
-    ax_memory.set_xlabel(f"Duration of the complete program [s]")
     ax_memory.set_ylabel('Memory usage [b]')
     ax_memory.legend()
+    if has_alloc:
+        ax_alloc.set_ylabel('Allocated per scope [b]')
+        ax_alloc.legend(fontsize="small", ncol=2)
+        ax_alloc.set_xlabel(f"Duration of the complete program [s]")
+    else:
+        ax_memory.set_xlabel(f"Duration of the complete program [s]")
     plt.grid(visible=True, which="major", axis="x")
     plt.savefig(f"roofer_trace_plot.png")
     plt.close()